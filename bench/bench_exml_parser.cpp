@@ -0,0 +1,425 @@
+#include "exml_parser.h"
+#include "exml_mapped.h"
+#include "exml_cache.h"
+#include "exml_transaction.h"
+#include "exml_columnar.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+// 合成布局的规模参数
+struct GeneratorConfig {
+    int pages = 8;               // Home/HomeOnly页数
+    int itemsPerPage = 24;       // 每页项目数
+    double folderRatio = 0.15;   // 文件夹占比
+    int folderSize = 8;          // 每个文件夹内的应用数
+    double widgetRatio = 0.1;    // 小部件占比
+    int appOrderLength = 300;    // AppOrder项目数
+    bool cjkTitles = true;       // 文件夹标题使用中日韩字符
+    uint32_t seed = 42;          // 随机种子，相同参数生成相同内容
+    int iterations = 5;          // 每项测量的重复次数
+};
+
+// 固定算法的伪随机数，保证不同平台生成的布局一致
+class Lcg {
+public:
+    explicit Lcg(uint32_t seed) : state_(seed) {}
+
+    uint32_t next() {
+        state_ = state_ * 1664525u + 1013904223u;
+        return state_ >> 8;
+    }
+
+    int range(int limit) { return static_cast<int>(next() % static_cast<uint32_t>(limit)); }
+    bool chance(double ratio) { return (next() & 0xFFFF) < ratio * 0x10000; }
+
+private:
+    uint32_t state_;
+};
+
+std::string packageName(int index) {
+    return "com.bench.vendor" + std::to_string(index % 97) + ".app" + std::to_string(index);
+}
+
+std::string folderTitle(Lcg& random, bool cjk) {
+    static const char* const kCjk[] = {"工具", "游戏", "社交", "影音", "办公", "購物", "写真", "생활"};
+    static const char* const kLatin[] = {"Tools", "Games", "Social", "Media", "Office", "Shopping", "Photos", "Life"};
+    const int index = random.range(8);
+    return std::string(cjk ? kCjk[index] : kLatin[index]) + std::to_string(random.range(100));
+}
+
+exml::Item makeApp(int index, int screen) {
+    exml::Item item;
+    item.packageName = packageName(index);
+    item.className = item.packageName + ".MainActivity";
+    item.screen = screen;
+    return item;
+}
+
+exml::Item makeFolder(Lcg& random, const GeneratorConfig& config, int& nextApp, int screen) {
+    exml::Item folder;
+    folder.type = exml::ItemType::FOLDER;
+    folder.title = folderTitle(random, config.cjkTitles);
+    folder.screen = screen;
+    for (int i = 0; i < config.folderSize; ++i) {
+        folder.favorites.push_back(makeApp(nextApp++, i));
+    }
+    return folder;
+}
+
+// 生成一份确定性的EXML文档
+std::string generateLayout(const GeneratorConfig& config) {
+    Lcg random(config.seed);
+    exml::EXMLParser parser;
+    int nextApp = 0;
+    int nextWidget = 1;
+
+    exml::LayoutConfig layoutConfig;
+    layoutConfig.pageCount = config.pages;
+    layoutConfig.category = "home,hotseat,homeOnly,hotseat_homeOnly,zeroPage,appOrder";
+    layoutConfig.folderGrid = "3X4";
+    parser.setLayoutConfig(layoutConfig);
+
+    for (int page = 0; page < config.pages; ++page) {
+        for (int i = 0; i < config.itemsPerPage; ++i) {
+            exml::Item item;
+            if (random.chance(config.widgetRatio)) {
+                item = makeApp(nextApp++, page);
+                item.type = exml::ItemType::APPWIDGET;
+                item.spanX = 2;
+                item.spanY = 2;
+                item.appWidgetID = nextWidget++;
+            } else if (random.chance(config.folderRatio)) {
+                item = makeFolder(random, config, nextApp, page);
+            } else {
+                item = makeApp(nextApp++, page);
+            }
+            item.x = i % layoutConfig.columns;
+            item.y = (i / layoutConfig.columns) % layoutConfig.rows;
+            parser.addHomeItem(page, item);
+            parser.addHomeOnlyItem(page, item);
+        }
+    }
+    for (int i = 0; i < 5; ++i) {
+        exml::Item item = makeApp(nextApp++, i);
+        item.x = i;
+        parser.addHotseatItem(item);
+    }
+    for (int i = 0; i < config.appOrderLength; ++i) {
+        exml::Item item = random.chance(config.folderRatio) ? makeFolder(random, config, nextApp, i)
+                                                            : makeApp(random.range(nextApp + 1), i);
+        parser.addAppOrderItem(item);
+    }
+
+    std::string output;
+    parser.saveToString(output);
+    return output;
+}
+
+size_t countItems(const std::vector<exml::Item>& items) {
+    size_t count = items.size();
+    for (const auto& item : items) count += item.favorites.size();
+    return count;
+}
+
+size_t countItems(const exml::EXMLParser& parser) {
+    size_t count = countItems(parser.getHotseatItems()) + countItems(parser.getAppOrderItems());
+    for (size_t page = 0; page < parser.getHomePageCount(); ++page) {
+        count += countItems(parser.getHomeItems(static_cast<int>(page)));
+    }
+    for (size_t page = 0; page < parser.getHomeOnlyPageCount(); ++page) {
+        count += countItems(parser.getHomeOnlyItems(static_cast<int>(page)));
+    }
+    return count;
+}
+
+// 峰值常驻内存（字节）
+size_t peakMemory() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// 重复执行body，返回单次平均耗时（秒）
+double measure(int iterations, const std::function<void()>& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) body();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+void report(const std::string& name, double seconds, size_t bytes, size_t items) {
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << seconds * 1000.0 << " ms";
+    if (bytes) std::cout << std::setw(12) << std::setprecision(1) << bytes / seconds / (1024.0 * 1024.0) << " MB/s";
+    else std::cout << std::setw(17) << "";
+    std::cout << std::setw(14) << std::setprecision(0) << items / seconds << " items/s" << std::endl;
+}
+
+bool parseArguments(int argc, char** argv, GeneratorConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = std::strchr(arg, '=');
+        if (!value) {
+            std::cerr << "Invalid argument: " << arg << std::endl;
+            return false;
+        }
+        const std::string name(arg, value - arg);
+        ++value;
+        if (name == "--pages") config.pages = std::atoi(value);
+        else if (name == "--items-per-page") config.itemsPerPage = std::atoi(value);
+        else if (name == "--folder-ratio") config.folderRatio = std::atof(value);
+        else if (name == "--folder-size") config.folderSize = std::atoi(value);
+        else if (name == "--widget-ratio") config.widgetRatio = std::atof(value);
+        else if (name == "--app-order") config.appOrderLength = std::atoi(value);
+        else if (name == "--cjk") config.cjkTitles = std::atoi(value) != 0;
+        else if (name == "--seed") config.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (name == "--iterations") config.iterations = std::max(1, std::atoi(value));
+        else {
+            std::cerr << "Unknown option: " << name << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    GeneratorConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        std::cerr << "Usage: bench_exml_parser [--pages=N] [--items-per-page=N] [--folder-ratio=R] [--folder-size=N]"
+                  << " [--widget-ratio=R] [--app-order=N] [--cjk=0|1] [--seed=N] [--iterations=N]" << std::endl;
+        return 1;
+    }
+
+    const std::string document = generateLayout(config);
+    const std::string path = (std::filesystem::temp_directory_path() / "bench_exml_parser.exml").string();
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(document.data(), static_cast<std::streamsize>(document.size()));
+    }
+
+    exml::EXMLParser parser;
+    if (!parser.loadFromMemory(document.data(), document.size())) {
+        std::cerr << "Generated document failed to load" << std::endl;
+        return 1;
+    }
+    const size_t items = countItems(parser);
+    std::cout << "=== EXML Parser Benchmark ===" << std::endl;
+    std::cout << "Document: " << document.size() << " bytes, " << items << " items, "
+              << config.iterations << " iterations" << std::endl;
+    std::cout << std::endl;
+
+    // 加载
+    double seconds = measure(config.iterations, [&]() {
+        exml::EXMLParser loaded;
+        loaded.loadFromMemory(document.data(), document.size());
+    });
+    report("load", seconds, document.size(), items);
+
+    exml::LoadOptions domOptions;
+    domOptions.mode = exml::LoadMode::DOM;
+    seconds = measure(config.iterations, [&]() {
+        exml::EXMLParser loaded;
+        loaded.loadFromMemory(document.data(), document.size(), domOptions);
+    });
+    report("load (DOM)", seconds, document.size(), items);
+
+    exml::LoadOptions appOrderOptions;
+    appOrderOptions.sections = exml::SECTION_APP_ORDER;
+    seconds = measure(config.iterations, [&]() {
+        exml::EXMLParser loaded;
+        loaded.loadFromMemory(document.data(), document.size(), appOrderOptions);
+    });
+    report("load (appOrder)", seconds, document.size(), countItems(parser.getAppOrderItems()));
+
+    seconds = measure(config.iterations, [&]() {
+        exml::MappedLayout layout;
+        layout.open(path);
+    });
+    report("mapped open", seconds, document.size(), items);
+
+    seconds = measure(config.iterations, [&]() {
+        exml::ColumnarLayout layout;
+        layout.loadFromMemory(document.data(), document.size());
+    });
+    report("load (columnar)", seconds, document.size(), items);
+
+    std::string snapshot;
+    parser.saveSnapshotToString(snapshot);
+    seconds = measure(config.iterations, [&]() {
+        exml::EXMLParser loaded;
+        loaded.loadSnapshotFromMemory(snapshot.data(), snapshot.size());
+    });
+    report("load (snapshot)", seconds, snapshot.size(), items);
+
+    exml::LayoutCache cache;
+    cache.load(path);
+    seconds = measure(config.iterations, [&]() { cache.load(path); });
+    report("load (cache hit)", seconds, document.size(), items);
+
+    // 查询：每个应用包名在各区域查找一次
+    std::vector<std::string> packages;
+    for (const auto& item : parser.getAppOrderItems()) {
+        if (!item.packageName.empty()) packages.push_back(item.packageName);
+    }
+    size_t found = 0;
+    seconds = measure(config.iterations, [&]() {
+        for (const auto& package : packages) {
+            found += parser.findHomeItems(package).size() + parser.findHotseatItems(package).size() +
+                     parser.findHomeOnlyItems(package).size() + parser.findAppOrderItems(package).size();
+        }
+    });
+    report("query", seconds, 0, packages.size() * 4);
+
+    seconds = measure(config.iterations, [&]() {
+        for (const auto& package : packages) {
+            found += parser.locateHomeItems(package).size() + parser.locateHotseatItems(package).size() +
+                     parser.locateHomeOnlyItems(package).size() + parser.locateAppOrderItems(package).size();
+        }
+    });
+    report("query (locate)", seconds, 0, packages.size() * 4);
+
+    size_t iterated = 0;
+    seconds = measure(config.iterations, [&]() {
+        for (const exml::ItemRef item : parser.viewAppOrderItems()) iterated += item.childCount() + 1;
+        for (size_t page = 0; page < parser.getHomePageCount(); ++page) {
+            iterated += parser.viewHomeItems(static_cast<int>(page)).size();
+        }
+    });
+    report("iterate (view)", seconds, 0, iterated / config.iterations);
+
+    // 统计：按跨度统计小部件，逐项遍历与按列扫描
+    constexpr int kMaxSpan = 4;
+    std::vector<size_t> histogram(kMaxSpan * kMaxSpan, 0);
+    auto countSpans = [&](exml::ItemsView view) {
+        for (const exml::ItemRef item : view) {
+            if (item.type() != exml::ItemType::APPWIDGET) continue;
+            const int x = std::min(std::max(item.spanX(), 1), kMaxSpan) - 1;
+            const int y = std::min(std::max(item.spanY(), 1), kMaxSpan) - 1;
+            ++histogram[y * kMaxSpan + x];
+        }
+    };
+    seconds = measure(config.iterations, [&]() {
+        for (size_t page = 0; page < parser.getHomePageCount(); ++page) {
+            countSpans(parser.viewHomeItems(static_cast<int>(page)));
+        }
+        for (size_t page = 0; page < parser.getHomeOnlyPageCount(); ++page) {
+            countSpans(parser.viewHomeOnlyItems(static_cast<int>(page)));
+        }
+        countSpans(parser.viewHotseatItems());
+        countSpans(parser.viewHotseatHomeOnlyItems());
+        countSpans(parser.viewAppOrderItems());
+    });
+    report("span (items)", seconds, 0, items);
+
+    exml::ColumnarLayout columns;
+    columns.build(parser);
+    const exml::RowRange rows = columns.getItemRows();
+    seconds = measure(config.iterations, [&]() {
+        const std::vector<size_t> counts = columns.spanHistogram(rows, exml::ItemType::APPWIDGET, kMaxSpan);
+        for (size_t i = 0; i < counts.size(); ++i) histogram[i] += counts[i];
+    });
+    report("span (columnar)", seconds, 0, rows.size());
+    found += histogram[0];
+
+    // 修改：添加、移动、删除（只计修改耗时，不含每轮的重新加载）
+    const int mutations = std::max(1, config.itemsPerPage);
+    seconds = 0;
+    for (int iteration = 0; iteration < config.iterations; ++iteration) {
+        exml::EXMLParser mutated;
+        mutated.loadFromMemory(document.data(), document.size());
+        seconds += measure(1, [&]() {
+            for (int i = 0; i < mutations; ++i) {
+                mutated.addHomeItem(0, makeApp(1000000 + i, 0));
+                mutated.moveHomeItem(0, 0, config.pages > 1 ? 1 : 0, 0);
+                mutated.removeAppOrderItem(packageName(i), packageName(i) + ".MainActivity");
+            }
+        });
+    }
+    report("mutate", seconds / config.iterations, 0, static_cast<size_t>(mutations) * 3);
+
+    // 同样的修改作为一个事务提交
+    seconds = 0;
+    for (int iteration = 0; iteration < config.iterations; ++iteration) {
+        exml::EXMLParser mutated;
+        mutated.loadFromMemory(document.data(), document.size());
+        seconds += measure(1, [&]() {
+            exml::LayoutTransaction transaction(mutated);
+            for (int i = 0; i < mutations; ++i) {
+                transaction.addItem(exml::LayoutArea::HOME, 0, makeApp(1000000 + i, 0));
+                transaction.moveItem(exml::LayoutArea::HOME, 0, 0, config.pages > 1 ? 1 : 0, 0);
+                transaction.removeItem(exml::LayoutArea::APP_ORDER, 0, packageName(i), packageName(i) + ".MainActivity");
+            }
+            transaction.commit();
+        });
+    }
+    report("mutate (batch)", seconds / config.iterations, 0, static_cast<size_t>(mutations) * 3);
+
+    // 自动放置：应用与2×2小部件交替，放满后新建页面
+    seconds = 0;
+    for (int iteration = 0; iteration < config.iterations; ++iteration) {
+        exml::EXMLParser placed;
+        placed.loadFromMemory(document.data(), document.size());
+        seconds += measure(1, [&]() {
+            for (int i = 0; i < mutations; ++i) {
+                exml::Item item = makeApp(2000000 + i, 0);
+                if (i % 4 == 0) {
+                    item.type = exml::ItemType::APPWIDGET;
+                    item.spanX = 2;
+                    item.spanY = 2;
+                }
+                placed.placeItem(exml::LayoutArea::HOME, item);
+            }
+        });
+    }
+    report("place", seconds / config.iterations, 0, static_cast<size_t>(mutations));
+
+    // 保存
+    std::string output;
+    seconds = measure(config.iterations, [&]() { parser.saveToString(output); });
+    report("save", seconds, output.size(), items);
+
+    // 全部区域标记为已修改，保存时逐项重新序列化
+    exml::EXMLParser edited;
+    edited.loadFromMemory(document.data(), document.size());
+    edited.moveHomeItem(0, 0, 0, 0);
+    edited.moveHotseatItem(0, 0);
+    edited.moveAppOrderItem(0, 0);
+    seconds = measure(config.iterations, [&]() { edited.saveToString(output); });
+    report("save (dirty)", seconds, output.size(), items);
+
+    seconds = measure(config.iterations, [&]() { parser.saveSnapshotToString(snapshot); });
+    report("save (snapshot)", seconds, snapshot.size(), items);
+
+    std::filesystem::remove(path);
+    std::cout << std::endl;
+    std::cout << "Peak memory: " << peakMemory() / (1024.0 * 1024.0) << " MB" << std::endl;
+    std::cout << "Query hits: " << found << std::endl;
+    return 0;
+}
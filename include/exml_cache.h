@@ -0,0 +1,101 @@
+#ifndef EXML_CACHE_H
+#define EXML_CACHE_H
+
+#include "exml_parser.h"
+#include <memory>
+#include <string>
+
+namespace exml {
+
+// 前向声明
+class LayoutCacheImpl;
+
+/**
+ * @brief 判断缓存的布局是否仍与文件一致的方式
+ */
+enum class CacheValidation {
+    FILE_IDENTITY,  // 按路径缓存，比较文件大小、修改时间与inode，命中时只需一次stat
+    CONTENT_HASH    // 按内容缓存，每次读取文件并计算指纹；内容相同的不同路径共享同一结果
+};
+
+/**
+ * @brief 解析缓存选项
+ */
+struct EXML_PARSER_API CacheOptions {
+    size_t byteBudget;              // 缓存布局占用内存的上限（估算值），默认64MB
+    CacheValidation validation;     // 默认FILE_IDENTITY
+    LoadOptions load;               // 未命中时的加载选项
+
+    CacheOptions();
+};
+
+/**
+ * @brief 解析缓存的统计
+ */
+struct EXML_PARSER_API CacheStats {
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+
+    CacheStats();
+};
+
+/**
+ * @brief 以文件为键的解析缓存
+ *
+ * 命中时直接返回已解析的布局，不再读取和解析文件。超出内存上限时按最近最少使用淘汰；
+ * 单个超出上限的布局照常返回，但不缓存。
+ * 返回的布局为只读，其索引、占用表与指纹在放入缓存前已全部建立，可在多个线程中同时查询；
+ * 淘汰后仍被持有的布局在最后一个引用释放时销毁。
+ * 线程安全。同一文件同时未命中时可能各自解析一次，以后放入的结果为准。
+ */
+class EXML_PARSER_API LayoutCache {
+public:
+    explicit LayoutCache(const CacheOptions& options = CacheOptions());
+    ~LayoutCache();
+
+    // 禁用拷贝构造和赋值
+    LayoutCache(const LayoutCache&) = delete;
+    LayoutCache& operator=(const LayoutCache&) = delete;
+
+    /**
+     * @brief 获取文件的解析结果，文件未缓存或已改变时重新解析
+     * @param filePath EXML文件路径
+     * @param error 不为空时写入失败原因
+     * @return 解析结果；文件不存在或解析失败时为空
+     */
+    std::shared_ptr<const EXMLParser> load(const std::string& filePath, std::string* error = nullptr);
+
+    /**
+     * @brief 丢弃路径对应的缓存结果（CONTENT_HASH时为与文件当前内容相同的结果）
+     * @return 是否存在
+     */
+    bool invalidate(const std::string& filePath);
+
+    /**
+     * @brief 丢弃全部缓存结果
+     */
+    void clear();
+
+    /**
+     * @brief 修改内存上限，超出的部分立即淘汰
+     */
+    void setByteBudget(size_t bytes);
+    size_t getByteBudget() const;
+
+    /**
+     * @brief 缓存中布局占用的内存（估算值）
+     */
+    size_t getMemoryUsage() const;
+
+    size_t getEntryCount() const;
+
+    CacheStats getStats() const;
+
+private:
+    std::unique_ptr<LayoutCacheImpl> pImpl;
+};
+
+} // namespace exml
+
+#endif // EXML_CACHE_H
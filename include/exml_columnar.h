@@ -0,0 +1,143 @@
+#ifndef EXML_COLUMNAR_H
+#define EXML_COLUMNAR_H
+
+#include "exml_parser.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace exml {
+
+// 前向声明
+class ColumnarLayoutImpl;
+
+/**
+ * @brief 列存储中的连续行区间 [begin, end)
+ */
+struct EXML_PARSER_API RowRange {
+    uint32_t begin;
+    uint32_t end;
+
+    RowRange();
+    RowRange(uint32_t begin, uint32_t end);
+
+    size_t size() const { return end - begin; }
+};
+
+/**
+ * @brief 按列存储的只读布局，用于大批量项目的统计分析
+ *
+ * 每个字段一个连续数组，字符串字段为字符串池ID，扫描单个字段时只读取该字段的数据。
+ * 行按区域（LayoutArea的顺序）连续存放，Home、HomeOnly区域内按screen排序；
+ * 所有文件夹内的应用排在顶层项目之后，由文件夹行的firstChild、childCount引用，
+ * 其area、screen沿用所属文件夹。
+ * 从文件加载时边扫描边写入各列，不构建Item。需要修改布局时请使用EXMLParser。
+ */
+class EXML_PARSER_API ColumnarLayout {
+public:
+    /**
+     * @param pool 分配字符串ID的池；为空时使用自带的池。多个布局共享同一个池时ID可直接比较
+     */
+    explicit ColumnarLayout(std::shared_ptr<StringPool> pool = nullptr);
+    ~ColumnarLayout();
+
+    // 禁用拷贝构造和赋值
+    ColumnarLayout(const ColumnarLayout&) = delete;
+    ColumnarLayout& operator=(const ColumnarLayout&) = delete;
+
+    /**
+     * @brief 加载EXML文件，替换原有内容
+     * @param filePath EXML文件路径
+     * @return 是否加载成功
+     */
+    bool loadFromFile(const std::string& filePath);
+
+    /**
+     * @brief 从内存中的EXML文本加载，替换原有内容
+     */
+    bool loadFromMemory(const char* data, size_t size);
+
+    /**
+     * @brief 由解析器的模型生成列存储，替换原有内容
+     */
+    void build(const EXMLParser& parser);
+
+    /**
+     * @brief 清空所有行
+     */
+    void clear();
+
+    const LayoutConfig& getLayoutConfig() const;
+
+    std::shared_ptr<StringPool> getStringPool() const;
+
+    /**
+     * @brief 总行数（顶层项目与文件夹内的应用）
+     */
+    size_t getRowCount() const;
+
+    /**
+     * @brief 区域的顶层项目所在的行
+     */
+    RowRange getAreaRows(LayoutArea area) const;
+
+    /**
+     * @brief 全部顶层项目所在的行
+     */
+    RowRange getItemRows() const;
+
+    /**
+     * @brief 全部文件夹内应用所在的行
+     */
+    RowRange getFolderChildRows() const;
+
+    // 各列，下标为行号；在下一次加载或清空前有效
+    Span<uint8_t> areas() const;            // LayoutArea
+    Span<uint8_t> types() const;            // ItemType
+    Span<int> screens() const;
+    Span<int> xs() const;
+    Span<int> ys() const;
+    Span<int> spanXs() const;
+    Span<int> spanYs() const;
+    Span<int> appWidgetIDs() const;
+    Span<int> options() const;
+    Span<int> colors() const;
+    Span<uint8_t> hidden() const;           // 0或1
+    Span<uint32_t> packageIds() const;
+    Span<uint32_t> classIds() const;
+    Span<uint32_t> titleIds() const;
+    Span<uint32_t> firstChildren() const;   // 文件夹内第一个应用的行号，其他项目为0
+    Span<uint32_t> childCounts() const;     // 文件夹内的应用数量，其他项目为0
+
+    // 统计（无分支的列扫描，编译器可向量化）
+
+    /**
+     * @brief 统计区间内指定类型的项目数
+     */
+    size_t countItems(RowRange rows, ItemType type) const;
+
+    /**
+     * @brief 统计区间内指定类型与跨度的项目数
+     */
+    size_t countItems(RowRange rows, ItemType type, int spanX, int spanY) const;
+
+    /**
+     * @brief 统计区间内包名ID为packageId的项目数
+     */
+    size_t countPackage(RowRange rows, uint32_t packageId) const;
+
+    /**
+     * @brief 按跨度统计区间内指定类型的项目数
+     * @param maxSpan 跨度上限，超出的按maxSpan计，小于1的按1计
+     * @return maxSpan*maxSpan个计数，(spanX, spanY)位于 (spanY-1)*maxSpan + (spanX-1)
+     */
+    std::vector<size_t> spanHistogram(RowRange rows, ItemType type, int maxSpan) const;
+
+private:
+    std::unique_ptr<ColumnarLayoutImpl> pImpl;
+};
+
+} // namespace exml
+
+#endif // EXML_COLUMNAR_H
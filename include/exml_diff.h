@@ -0,0 +1,88 @@
+#ifndef EXML_DIFF_H
+#define EXML_DIFF_H
+
+#include "exml_parser.h"
+#include <string>
+#include <vector>
+
+namespace exml {
+
+/**
+ * @brief 编辑类型
+ */
+enum class EditKind {
+    ADDED,      // 仅在新布局中存在
+    REMOVED,    // 仅在旧布局中存在
+    MOVED,      // 页面、screen或坐标变化，或在有序列表中的相对顺序变化（其他属性也可能同时变化）
+    MODIFIED    // 位置不变，其他属性变化
+};
+
+/**
+ * @brief 项目路径：顶层位置加文件夹内序号
+ */
+struct ItemPath {
+    ItemLocation location;      // 顶层项目的位置；文件夹内的项目为所属文件夹的位置
+    int child;                  // 文件夹内序号，顶层项目为-1
+};
+
+/**
+ * @brief 单个项目的编辑
+ */
+struct EXML_PARSER_API ItemEdit {
+    EditKind kind;
+    ItemPath from;                  // 在旧布局中的路径，ADDED时page为-1
+    ItemPath to;                    // 在新布局中的路径，REMOVED时page为-1
+    unsigned int changedAttributes; // MOVED/MODIFIED时取值不同的属性位（ItemAttribute）
+
+    ItemEdit();
+};
+
+/**
+ * @brief 配置项的变化
+ */
+struct EXML_PARSER_API ConfigEdit {
+    std::string tag;            // 配置元素名（如Rows）
+    std::string oldValue;
+    std::string newValue;
+
+    ConfigEdit();
+};
+
+/**
+ * @brief 两个布局之间的编辑脚本
+ */
+struct EXML_PARSER_API LayoutDiff {
+    std::vector<ItemEdit> items;    // 按区域顺序排列，文件夹内的编辑紧跟在文件夹之后
+    std::vector<ConfigEdit> config;
+
+    LayoutDiff();
+
+    bool empty() const { return items.empty() && config.empty(); }
+};
+
+/**
+ * @brief 比较两个布局
+ *
+ * 每个区域内按 (类型, 包名, 类名, 小部件ID) 的哈希匹配项目，同键的多个项目按出现顺序配对，
+ * 耗时与项目数近似线性。跨区域的移动表现为一次删除和一次添加；
+ * 配对成功的文件夹继续比较其中的项目。快捷栏、AppOrder与文件夹内的位置只由顺序表示，
+ * 保持相对顺序的最多项目（最长递增子序列）视为未动，其余配对项报告为移动。
+ * @param a 旧布局
+ * @param b 新布局
+ * @return 由a变为b的编辑脚本
+ */
+EXML_PARSER_API LayoutDiff diff(const EXMLParser& a, const EXMLParser& b);
+
+/**
+ * @brief 把编辑脚本格式化为每行一条的文本
+ *
+ * 行首符号：'+' 添加，'-' 删除，'>' 移动，'*' 修改，'~' 配置变化。
+ * @param changes diff()的结果
+ * @param a 旧布局
+ * @param b 新布局
+ */
+EXML_PARSER_API std::string formatDiff(const LayoutDiff& changes, const EXMLParser& a, const EXMLParser& b);
+
+} // namespace exml
+
+#endif // EXML_DIFF_H
@@ -0,0 +1,121 @@
+#ifndef EXML_MAPPED_H
+#define EXML_MAPPED_H
+
+#include "exml_parser.h"
+#include <string_view>
+#include <cstdint>
+
+namespace exml {
+
+// 前向声明
+class MappedLayoutImpl;
+
+/**
+ * @brief 只读项目视图
+ *
+ * 字符串字段直接指向映射的文件内容，生命周期与所属的MappedLayout相同。
+ */
+struct ItemView {
+    ItemType type;
+    std::string_view packageName;
+    std::string_view className;
+    std::string_view title;      // 文件夹标题
+    int screen;                  // 屏幕索引
+    int x, y;                    // 位置坐标
+    int spanX, spanY;            // 跨度（小部件用）
+    int appWidgetID;             // 小部件ID
+    int options;                 // 选项
+    int color;                   // 颜色
+    bool hidden;                 // 是否隐藏
+    uint32_t firstChild;         // 文件夹内第一个应用在子项表中的位置
+    uint32_t childCount;         // 文件夹内的应用数量
+};
+
+/**
+ * @brief 基于内存映射的只读布局
+ *
+ * 以mmap方式打开.exml文件，直接在映射内容上解析，
+ * 不为属性值分配字符串，适用于统计、查找等只读分析任务。
+ * 需要修改布局时请使用EXMLParser。
+ */
+class EXML_PARSER_API MappedLayout {
+public:
+    MappedLayout();
+    ~MappedLayout();
+
+    // 禁用拷贝构造和赋值
+    MappedLayout(const MappedLayout&) = delete;
+    MappedLayout& operator=(const MappedLayout&) = delete;
+
+    /**
+     * @brief 映射并解析EXML文件
+     * @param filePath EXML文件路径
+     * @return 是否打开成功
+     */
+    bool open(const std::string& filePath);
+
+    /**
+     * @brief 解除映射并释放所有视图
+     */
+    void close();
+
+    /**
+     * @brief 是否已打开文件
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief 获取布局配置
+     */
+    const LayoutConfig& getLayoutConfig() const;
+
+    /**
+     * @brief 获取Home区域的页面数量
+     */
+    size_t getHomePageCount() const;
+
+    /**
+     * @brief 获取Home区域指定页面的项目视图
+     * @param pageIndex 页面索引
+     */
+    Span<ItemView> getHomeItems(int pageIndex) const;
+
+    /**
+     * @brief 获取Hotseat区域的项目视图
+     */
+    Span<ItemView> getHotseatItems() const;
+
+    /**
+     * @brief 获取HomeOnly区域的页面数量
+     */
+    size_t getHomeOnlyPageCount() const;
+
+    /**
+     * @brief 获取HomeOnly区域指定页面的项目视图
+     * @param pageIndex 页面索引
+     */
+    Span<ItemView> getHomeOnlyItems(int pageIndex) const;
+
+    /**
+     * @brief 获取HotseatHomeOnly区域的项目视图
+     */
+    Span<ItemView> getHotseatHomeOnlyItems() const;
+
+    /**
+     * @brief 获取AppOrder区域的项目视图
+     */
+    Span<ItemView> getAppOrderItems() const;
+
+    /**
+     * @brief 获取文件夹内的应用视图
+     * @param folder 文件夹项目视图
+     */
+    Span<ItemView> getFolderItems(const ItemView& folder) const;
+
+private:
+    std::unique_ptr<MappedLayoutImpl> pImpl;
+};
+
+} // namespace exml
+
+#endif // EXML_MAPPED_H
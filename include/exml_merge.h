@@ -0,0 +1,76 @@
+#ifndef EXML_MERGE_H
+#define EXML_MERGE_H
+
+#include "exml_parser.h"
+#include <string>
+#include <vector>
+
+namespace exml {
+
+/**
+ * @brief 合并的一方
+ */
+enum class MergeSide {
+    THEIRS,     // 下发的版本（如IT管理的布局）
+    OURS        // 用户当前的版本
+};
+
+/**
+ * @brief 冲突类型
+ */
+enum class ConflictKind {
+    CELL,           // 双方的项目占用同一单元格（Home、HomeOnly）
+    HOTSEAT_SLOT,   // 双方的项目占用同一快捷栏位置（screen相同）
+    FOLDER,         // 双方都修改了同一文件夹（属性或其中的项目）
+    ITEM,           // 双方把同一项目的同一属性改为不同值，或一方修改而另一方删除
+    CONFIG          // 双方把同一配置项改为不同值
+};
+
+/**
+ * @brief 合并冲突及其处理结果
+ *
+ * 冲突按MergeOptions::preferred一方处理：CELL与HOTSEAT_SLOT中另一方的项目被移到空位，
+ * 其余冲突采用优先一方的版本。
+ */
+struct EXML_PARSER_API MergeConflict {
+    ConflictKind kind;
+    LayoutArea area;
+    ItemLocation theirs;        // 项目在theirs中的位置，不涉及时page为-1
+    ItemLocation ours;          // 项目在ours中的位置，不涉及时page为-1
+    ItemLocation relocated;     // CELL/HOTSEAT_SLOT：让位的项目在合并结果中的新位置，未能放置时page为-1
+    std::string tag;            // CONFIG：配置元素名
+
+    MergeConflict();
+};
+
+/**
+ * @brief 合并选项
+ */
+struct EXML_PARSER_API MergeOptions {
+    MergeSide preferred;        // 冲突时优先的一方，默认为THEIRS
+
+    MergeOptions();
+};
+
+/**
+ * @brief 三方合并布局
+ *
+ * 各区域分别以base为共同祖先，按 (类型, 包名, 类名, 小部件ID) 把theirs和ours的项目与base配对
+ * （与diff()相同），未冲突的属性修改、添加和删除从两边合入。耗时与项目数近似线性，全部在内存中完成。
+ * ours中的项目保持原有顺序，theirs新增的项目排在其后。合并结果以ours为基础：
+ * 文档骨架（未识别的顶层元素、空白等）与合并后没有变化的区域保持ours的原文，只重新生成有变化的区域。
+ * @param base 共同祖先
+ * @param theirs 一方的修改
+ * @param ours 另一方的修改
+ * @param result 接收合并结果，原有内容被清空；不能是三个输入之一
+ * @param conflicts 接收冲突列表（覆盖原有内容）
+ * @param options 合并选项
+ * @return 是否完成合并；存在冲突时同样返回true
+ */
+EXML_PARSER_API bool merge(const EXMLParser& base, const EXMLParser& theirs, const EXMLParser& ours,
+                           EXMLParser& result, std::vector<MergeConflict>& conflicts,
+                           const MergeOptions& options = MergeOptions());
+
+} // namespace exml
+
+#endif // EXML_MERGE_H
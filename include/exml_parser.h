@@ -2,9 +2,13 @@
 #define EXML_PARSER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <iterator>
 #include <memory>
 #include <map>
+#include <memory_resource>
+#include <cstdint>
 
 #ifdef _WIN32
     #ifdef EXML_PARSER_EXPORTS
@@ -20,6 +24,9 @@ namespace exml {
 
 // 前向声明
 class EXMLParserImpl;
+class StringPoolImpl;
+struct LayoutModel;
+struct ItemRecord;
 
 /**
  * @brief 应用项目类型枚举
@@ -30,6 +37,65 @@ enum class ItemType {
     APPWIDGET   // 小部件
 };
 
+/**
+ * @brief 布局区域枚举
+ */
+enum class LayoutArea {
+    HOME,               // 主屏幕（按页）
+    HOTSEAT,            // 底部快捷栏
+    HOME_ONLY,          // 仅主屏幕模式（按页）
+    HOTSEAT_HOME_ONLY,  // 仅主屏幕模式的快捷栏
+    APP_ORDER           // 应用抽屉
+};
+
+/**
+ * @brief 项目在布局中的位置（单列表区域的page恒为0）
+ */
+struct ItemLocation {
+    LayoutArea area;
+    int page;
+    size_t index;
+};
+
+/**
+ * @brief 项目属性位，用于 Item::attributeMask
+ */
+enum ItemAttribute : unsigned int {
+    ATTR_SCREEN        = 1u << 0,
+    ATTR_PACKAGE_NAME  = 1u << 1,
+    ATTR_CLASS_NAME    = 1u << 2,
+    ATTR_TITLE         = 1u << 3,
+    ATTR_OPTIONS       = 1u << 4,
+    ATTR_COLOR         = 1u << 5,
+    ATTR_X             = 1u << 6,
+    ATTR_Y             = 1u << 7,
+    ATTR_SPAN_X        = 1u << 8,
+    ATTR_SPAN_Y        = 1u << 9,
+    ATTR_APP_WIDGET_ID = 1u << 10,
+    ATTR_HIDDEN        = 1u << 11
+};
+
+/**
+ * @brief 只读连续区间视图（C++17下的简易span），不拥有数据
+ */
+template <typename T>
+class Span {
+public:
+    Span() : data_(nullptr), size_(0) {}
+    Span(const T* data, size_t size) : data_(data), size_(size) {}
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T& operator[](size_t index) const { return data_[index]; }
+
+private:
+    const T* data_;
+    size_t size_;
+};
+
 /**
  * @brief 应用项目结构体
  */
@@ -46,11 +112,170 @@ struct EXML_PARSER_API Item {
     int color;                   // 颜色
     bool hidden;                 // 是否隐藏
     std::vector<Item> favorites; // 文件夹内的应用列表
+    unsigned int attributeMask;  // 源文件中出现的属性（ItemAttribute位），为0时按所在区域的默认格式输出
     
     Item();
     ~Item();
     Item(const Item& other);
     Item& operator=(const Item& other);
+    Item(Item&& other) noexcept;
+    Item& operator=(Item&& other) noexcept;
+};
+
+/**
+ * @brief 字符串驻留池，每个不同的字符串只保存一份并分配紧凑ID
+ *
+ * ID从0开始连续分配，0固定对应空字符串。池可以通过 std::shared_ptr
+ * 在多个解析器之间共享（例如同一批次的加载）。
+ * 解析器内部的项目只保存packageName、className、title的ID，字符串本身只在池中保存一份；
+ * 视图与getItem()经池读取，get/find系列接口返回的Item为复制出的独立对象。
+ */
+class EXML_PARSER_API StringPool {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    /**
+     * @param concurrent 是否允许多线程同时使用（加读写锁）；
+     *                   解析器自带的池为false，跨线程共享时请显式创建并设置
+     */
+    explicit StringPool(bool concurrent = true);
+    ~StringPool();
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    /**
+     * @brief 驻留字符串
+     * @return 字符串的ID，已存在时返回原有ID
+     */
+    uint32_t intern(std::string_view value);
+
+    /**
+     * @brief 查找字符串的ID，不存在时返回npos（不会插入）
+     */
+    uint32_t find(std::string_view value) const;
+
+    /**
+     * @brief 根据ID获取字符串，视图在池销毁前有效
+     */
+    std::string_view lookup(uint32_t id) const;
+
+    /**
+     * @brief 已驻留的字符串数量
+     */
+    size_t size() const;
+
+    /**
+     * @brief 池占用内存的估算（字符串与查找表），单位字节
+     */
+    size_t memoryUsage() const;
+
+private:
+    std::unique_ptr<StringPoolImpl> pImpl;
+};
+
+/**
+ * @brief 解析器内部项目的只读引用，字符串从解析器的字符串池读取，不复制
+ *
+ * 与ItemsView相同，在解析器下一次修改或重新加载前有效；需要独立的副本时调用toItem()。
+ * 默认构造的引用为空（位置无效时getItem()返回空引用）。
+ */
+class EXML_PARSER_API ItemRef {
+public:
+    ItemRef() : record_(nullptr), pool_(nullptr) {}
+    ItemRef(const ItemRecord* record, const StringPool* pool) : record_(record), pool_(pool) {}
+
+    explicit operator bool() const { return record_ != nullptr; }
+
+    // 引用同一个内部项目时相等
+    bool operator==(const ItemRef& other) const { return record_ == other.record_; }
+    bool operator!=(const ItemRef& other) const { return record_ != other.record_; }
+
+    ItemType type() const;
+    std::string_view packageName() const;
+    std::string_view className() const;
+    std::string_view title() const;
+    int screen() const;
+    int x() const;
+    int y() const;
+    int spanX() const;
+    int spanY() const;
+    int appWidgetID() const;
+    int options() const;
+    int color() const;
+    bool hidden() const;
+    unsigned int attributeMask() const;
+
+    /**
+     * @brief packageName、className在解析器字符串池中的ID（同一个池中相同的名字ID相同）
+     */
+    uint32_t packageId() const;
+    uint32_t classId() const;
+
+    /**
+     * @brief 文件夹内的项目数量与引用
+     */
+    size_t childCount() const;
+    ItemRef child(size_t index) const;
+
+    /**
+     * @brief 复制为独立的Item
+     */
+    Item toItem() const;
+
+private:
+    const ItemRecord* record_;
+    const StringPool* pool_;
+};
+
+/**
+ * @brief 某区域某页项目的只读视图，直接引用解析器内部存储，不复制
+ *
+ * 元素为ItemRef。视图在解析器下一次修改或重新加载前有效。
+ */
+class EXML_PARSER_API ItemsView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ItemRef;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = ItemRef;
+
+        Iterator(const ItemsView* view, size_t index) : view_(view), index_(index) {}
+
+        ItemRef operator*() const { return (*view_)[index_]; }
+        Iterator& operator++() { ++index_; return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++index_; return old; }
+        bool operator==(const Iterator& other) const { return index_ == other.index_; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const ItemsView* view_;
+        size_t index_;
+    };
+
+    ItemsView() : data_(nullptr), size_(0), pool_(nullptr), area_(LayoutArea::HOME), page_(0) {}
+    ItemsView(LayoutArea area, int page, const ItemRecord* data, size_t size, const StringPool* pool)
+        : data_(data), size_(size), pool_(pool), area_(area), page_(page) {}
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    ItemRef operator[](size_t index) const;
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, size_); }
+
+    LayoutArea area() const { return area_; }
+    int page() const { return page_; }
+    ItemLocation locationOf(size_t index) const { return ItemLocation{area_, page_, index}; }
+
+private:
+    const ItemRecord* data_;
+    size_t size_;
+    const StringPool* pool_;
+    LayoutArea area_;
+    int page_;
 };
 
 /**
@@ -83,6 +308,100 @@ struct EXML_PARSER_API LayoutConfig {
     ~LayoutConfig();
     LayoutConfig(const LayoutConfig& other);
     LayoutConfig& operator=(const LayoutConfig& other);
+    LayoutConfig(LayoutConfig&& other) noexcept;
+    LayoutConfig& operator=(LayoutConfig&& other) noexcept;
+};
+
+/**
+ * @brief 加载模式枚举
+ */
+enum class LoadMode {
+    STREAMING,  // 流式读取，边扫描边构建Item，不生成中间DOM（默认）
+    DOM         // 先用tinyxml2构建完整DOM再遍历
+};
+
+/**
+ * @brief 区域位（按LayoutArea的顺序），用于 LoadOptions::sections
+ */
+enum SectionMask : unsigned int {
+    SECTION_HOME              = 1u << 0,
+    SECTION_HOTSEAT           = 1u << 1,
+    SECTION_HOME_ONLY         = 1u << 2,
+    SECTION_HOTSEAT_HOME_ONLY = 1u << 3,
+    SECTION_APP_ORDER         = 1u << 4,
+    SECTION_ALL               = (1u << 5) - 1
+};
+
+/**
+ * @brief 加载选项
+ */
+struct EXML_PARSER_API LoadOptions {
+    LoadMode mode;               // 加载模式
+    unsigned int sections;       // 加载时解析的区域（SectionMask位，默认SECTION_ALL）；
+                                 // 其余区域只记录源文本，首次访问该区域时再解析（仅流式模式）
+
+    LoadOptions();
+};
+
+/**
+ * @brief 加载时无法解码的字段
+ *
+ * 数值或布尔值格式错误时该字段保留默认值，加载继续进行，问题记录在诊断列表中。
+ */
+struct EXML_PARSER_API ParseDiagnostic {
+    std::string element;         // 元素名
+    std::string attribute;       // 属性名，配置元素的文本为空
+    std::string value;           // 无法解码的原始文本
+    int line;                    // 所在行号（从1开始）
+
+    ParseDiagnostic();
+};
+
+/**
+ * @brief 自动放置的选位策略
+ */
+enum class PlacementStrategy {
+    FIRST_FIT,  // 按页、行、列顺序的第一个空位（默认）
+    BEST_FIT    // 所有页中与已有项目及网格边界接触最多的空位，减少碎片
+};
+
+/**
+ * @brief 自动放置的位置
+ */
+struct EXML_PARSER_API Placement {
+    int page;   // 页面索引
+    int x;      // 列
+    int y;      // 行
+
+    Placement();
+};
+
+/**
+ * @brief 128位内容指纹
+ *
+ * 按模型内容计算，与源文件的属性顺序、空白和换行无关；
+ * 只需64位时取low。非加密哈希，仅用于比较与去重。
+ */
+struct EXML_PARSER_API Fingerprint {
+    uint64_t low;
+    uint64_t high;
+
+    Fingerprint();
+    Fingerprint(uint64_t low, uint64_t high);
+
+    bool operator==(const Fingerprint& other) const { return low == other.low && high == other.high; }
+    bool operator!=(const Fingerprint& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief 布局数据的内存分配方式
+ *
+ * 作用于区域容器与其中的项目（含文件夹内的项目）。项目的字符串保存在字符串池中，
+ * 池以及get/find系列接口返回的Item副本始终使用全局堆。
+ */
+enum class AllocationMode {
+    HEAP,   // 全局堆（默认）
+    ARENA   // 解析器自带的单调内存池，clear()、重新加载或析构时整体释放
 };
 
 /**
@@ -91,6 +410,19 @@ struct EXML_PARSER_API LayoutConfig {
 class EXML_PARSER_API EXMLParser {
 public:
     EXMLParser();
+
+    /**
+     * @brief 按指定分配方式构造解析器
+     * @param mode 分配方式
+     */
+    explicit EXMLParser(AllocationMode mode);
+
+    /**
+     * @brief 使用调用方提供的内存资源存放区域容器与项目（不含字符串池，见AllocationMode）
+     * @param resource 内存资源，生命周期需长于解析器；为空时使用默认资源
+     */
+    explicit EXMLParser(std::pmr::memory_resource* resource);
+
     ~EXMLParser();
     
     // 禁用拷贝构造和赋值
@@ -103,13 +435,96 @@ public:
      * @return 是否加载成功
      */
     bool loadFromFile(const std::string& filePath);
-    
+
+    /**
+     * @brief 按指定选项从文件加载EXML数据
+     * @param filePath EXML文件路径
+     * @param options 加载选项
+     * @return 是否加载成功
+     */
+    bool loadFromFile(const std::string& filePath, const LoadOptions& options);
+
+    /**
+     * @brief 从内存缓冲区加载EXML数据
+     * @param data 数据起始地址（无需以'\0'结尾）
+     * @param size 数据长度
+     * @param options 加载选项
+     * @return 是否加载成功
+     */
+    bool loadFromMemory(const char* data, size_t size, const LoadOptions& options = LoadOptions());
+
+    /**
+     * @brief 获取最近一次加载失败的原因
+     * @return 错误信息，加载成功时为空
+     */
+    const std::string& getLastError() const;
+
+    /**
+     * @brief 获取最近一次加载中无法解码的字段
+     * @return 诊断列表，按文档顺序排列
+     */
+    const std::vector<ParseDiagnostic>& getDiagnostics() const;
+
+    /**
+     * @brief 区域是否已解析（按LoadOptions::sections推迟的区域在首次访问后变为已解析）
+     */
+    bool isSectionLoaded(LayoutArea area) const;
+
+    /**
+     * @brief 区域在加载后是否被修改过（成功执行过该区域的添加、删除、移动操作；失败的操作不计）
+     *
+     * 保存时未修改的区域按源文件原文输出，只有修改过的区域重新序列化。
+     */
+    bool isSectionModified(LayoutArea area) const;
+
     /**
      * @brief 保存EXML数据到文件
+     *
+     * 按加载时记录的文档结构输出，未修改的文件可逐字节复原；
+     * 整个文档先写入预分配的缓冲区，再一次性写入文件。
      * @param filePath 目标文件路径
      * @return 是否保存成功
      */
     bool saveToFile(const std::string& filePath);
+
+    /**
+     * @brief 将EXML数据序列化为字符串
+     * @param output 输出内容（覆盖原有内容）
+     */
+    void saveToString(std::string& output) const;
+
+    /**
+     * @brief 保存二进制快照
+     *
+     * 快照包含配置、全部区域、字符串表与文档骨架，格式带版本号、与加载地址无关。
+     * 由快照加载后保存EXML的结果与保存快照时相同。
+     * @param filePath 目标文件路径
+     * @return 是否保存成功
+     */
+    bool saveSnapshot(const std::string& filePath) const;
+
+    /**
+     * @brief 将二进制快照写入字符串
+     * @param output 输出内容（覆盖原有内容）
+     */
+    void saveSnapshotToString(std::string& output) const;
+
+    /**
+     * @brief 加载二进制快照
+     *
+     * 整个文件一次读入后按定长记录解码，不经过XML解析。
+     * @param filePath 快照文件路径
+     * @return 是否加载成功；版本不符或内容损坏时返回false，原因见getLastError()
+     */
+    bool loadSnapshot(const std::string& filePath);
+
+    /**
+     * @brief 从内存缓冲区加载二进制快照
+     * @param data 数据起始地址
+     * @param size 数据长度
+     * @return 是否加载成功
+     */
+    bool loadSnapshotFromMemory(const char* data, size_t size);
     
     /**
      * @brief 获取布局配置
@@ -144,6 +559,7 @@ public:
      * @return 是否添加成功
      */
     bool addHomeItem(int pageIndex, const Item& item);
+    bool addHomeItem(int pageIndex, Item&& item);  // 与const Item&版本相同：项目转换为内部记录，不保留传入的对象
     
     /**
      * @brief 从Home区域删除项目
@@ -166,6 +582,8 @@ public:
     
     /**
      * @brief 查找Home区域项目
+     *
+     * 通过包名哈希索引查找，索引在首次查找时建立并随增删移动维护。
      * @param packageName 包名
      * @return 找到的项目列表
      */
@@ -190,6 +608,7 @@ public:
      * @return 是否添加成功
      */
     bool addHotseatItem(const Item& item);
+    bool addHotseatItem(Item&& item);  // 与const Item&版本相同：项目转换为内部记录，不保留传入的对象
     
     /**
      * @brief 从Hotseat区域删除项目
@@ -209,6 +628,8 @@ public:
     
     /**
      * @brief 查找Hotseat区域项目
+     *
+     * 通过包名哈希索引查找，索引在首次查找时建立并随增删移动维护。
      * @param packageName 包名
      * @return 找到的项目列表
      */
@@ -235,6 +656,7 @@ public:
      * @return 是否添加成功
      */
     bool addHomeOnlyItem(int pageIndex, const Item& item);
+    bool addHomeOnlyItem(int pageIndex, Item&& item);  // 与const Item&版本相同：项目转换为内部记录，不保留传入的对象
     
     /**
      * @brief 从HomeOnly区域删除项目
@@ -257,11 +679,59 @@ public:
     
     /**
      * @brief 查找HomeOnly区域项目
+     *
+     * 通过包名哈希索引查找，索引在首次查找时建立并随增删移动维护。
      * @param packageName 包名
      * @return 找到的项目列表
      */
     std::vector<Item> findHomeOnlyItems(const std::string& packageName) const;
     
+    // HotseatHomeOnly区域操作（仅主屏幕模式下的快捷栏）
+    /**
+     * @brief 获取HotseatHomeOnly区域的项目数量
+     * @return 项目数量
+     */
+    size_t getHotseatHomeOnlyItemCount() const;
+    
+    /**
+     * @brief 获取HotseatHomeOnly区域的所有项目
+     * @return 项目列表
+     */
+    std::vector<Item> getHotseatHomeOnlyItems() const;
+    
+    /**
+     * @brief 在HotseatHomeOnly区域添加项目
+     * @param item 要添加的项目
+     * @return 是否添加成功
+     */
+    bool addHotseatHomeOnlyItem(const Item& item);
+    bool addHotseatHomeOnlyItem(Item&& item);  // 与const Item&版本相同：项目转换为内部记录，不保留传入的对象
+    
+    /**
+     * @brief 从HotseatHomeOnly区域删除项目
+     * @param packageName 包名
+     * @param className 类名
+     * @return 是否删除成功
+     */
+    bool removeHotseatHomeOnlyItem(const std::string& packageName, const std::string& className);
+    
+    /**
+     * @brief 移动HotseatHomeOnly区域项目
+     * @param fromIndex 源索引
+     * @param toIndex 目标索引
+     * @return 是否移动成功
+     */
+    bool moveHotseatHomeOnlyItem(int fromIndex, int toIndex);
+    
+    /**
+     * @brief 查找HotseatHomeOnly区域项目
+     *
+     * 通过包名哈希索引查找，索引在首次查找时建立并随增删移动维护。
+     * @param packageName 包名
+     * @return 找到的项目列表
+     */
+    std::vector<Item> findHotseatHomeOnlyItems(const std::string& packageName) const;
+    
     // AppOrder区域操作
     /**
      * @brief 获取AppOrder区域的项目数量
@@ -281,6 +751,7 @@ public:
      * @return 是否添加成功
      */
     bool addAppOrderItem(const Item& item);
+    bool addAppOrderItem(Item&& item);  // 与const Item&版本相同：项目转换为内部记录，不保留传入的对象
     
     /**
      * @brief 从AppOrder区域删除项目
@@ -300,20 +771,240 @@ public:
     
     /**
      * @brief 查找AppOrder区域项目
+     *
+     * 通过包名哈希索引查找，索引在首次查找时建立并随增删移动维护。
      * @param packageName 包名
      * @return 找到的项目列表
      */
     std::vector<Item> findAppOrderItems(const std::string& packageName) const;
     
+    // 只读视图（不复制，在下一次修改或重新加载前有效）
+    /**
+     * @brief 获取Home区域指定页面的只读视图
+     * @param pageIndex 页面索引
+     * @return 项目视图，页面不存在时为空
+     */
+    ItemsView viewHomeItems(int pageIndex) const;
+
+    /**
+     * @brief 获取Hotseat区域的只读视图
+     */
+    ItemsView viewHotseatItems() const;
+
+    /**
+     * @brief 获取HomeOnly区域指定页面的只读视图
+     * @param pageIndex 页面索引
+     * @return 项目视图，页面不存在时为空
+     */
+    ItemsView viewHomeOnlyItems(int pageIndex) const;
+
+    /**
+     * @brief 获取HotseatHomeOnly区域的只读视图
+     */
+    ItemsView viewHotseatHomeOnlyItems() const;
+
+    /**
+     * @brief 获取AppOrder区域的只读视图
+     */
+    ItemsView viewAppOrderItems() const;
+
+    /**
+     * @brief 按包名查找Home区域项目的位置
+     * @param packageName 包名
+     * @return 位置列表（按页面、序号升序），直接引用内部索引
+     */
+    Span<ItemLocation> locateHomeItems(const std::string& packageName) const;
+
+    /**
+     * @brief 按包名查找Hotseat区域项目的位置
+     */
+    Span<ItemLocation> locateHotseatItems(const std::string& packageName) const;
+
+    /**
+     * @brief 按包名查找HomeOnly区域项目的位置
+     */
+    Span<ItemLocation> locateHomeOnlyItems(const std::string& packageName) const;
+
+    /**
+     * @brief 按包名查找HotseatHomeOnly区域项目的位置
+     */
+    Span<ItemLocation> locateHotseatHomeOnlyItems(const std::string& packageName) const;
+
+    /**
+     * @brief 按包名查找AppOrder区域项目的位置
+     */
+    Span<ItemLocation> locateAppOrderItems(const std::string& packageName) const;
+
+    /**
+     * @brief 根据位置获取项目
+     * @param location 项目位置
+     * @return 项目的只读引用，位置无效时为空引用
+     */
+    ItemRef getItem(const ItemLocation& location) const;
+
+    // 网格占用（Home、HomeOnly区域，按LayoutConfig的rows、columns划分单元格）
+    /**
+     * @brief 判断单元格是否空闲
+     *
+     * 占用表在首次查询时建立，随增删移动增量维护，查询为常数时间。
+     * @param area 区域，仅HOME、HOME_ONLY有网格
+     * @param pageIndex 页面索引
+     * @param x 列
+     * @param y 行
+     * @return 单元格在网格内且未被占用时返回true
+     */
+    bool isCellFree(LayoutArea area, int pageIndex, int x, int y) const;
+
+    /**
+     * @brief 判断项目能否按其x、y、spanX、spanY放入页面
+     *
+     * add*Item不做碰撞检查，需要时先调用本函数。
+     * @param area 区域，仅HOME、HOME_ONLY有网格
+     * @param pageIndex 页面索引
+     * @param item 待放置的项目
+     * @return 占用区域完全在网格内且与已有项目不重叠时返回true
+     */
+    bool canPlace(LayoutArea area, int pageIndex, const Item& item) const;
+
+    /**
+     * @brief 查找占用单元格的项目
+     * @param area 区域，仅HOME、HOME_ONLY有网格
+     * @param pageIndex 页面索引
+     * @param x 列
+     * @param y 行
+     * @param location 被占用时写入项目位置，可交给getItem()
+     * @return 单元格是否被占用
+     */
+    bool occupiedBy(LayoutArea area, int pageIndex, int x, int y, ItemLocation& location) const;
+
+    /**
+     * @brief 为spanX×spanY的项目查找空闲区域
+     *
+     * 按页搜索已有页面，每页以行位掩码的移位与运算求出可放置的列；
+     * 已有页面都放不下时返回最后一页之后的新页面。
+     * @param area 区域，仅HOME、HOME_ONLY有网格
+     * @param spanX 宽度（列数）
+     * @param spanY 高度（行数）
+     * @param placement 找到时写入位置
+     * @param strategy 选位策略
+     * @return 是否找到；跨度超出网格尺寸时返回false
+     */
+    bool findPlacement(LayoutArea area, int spanX, int spanY, Placement& placement,
+                       PlacementStrategy strategy = PlacementStrategy::FIRST_FIT) const;
+
+    /**
+     * @brief 按项目的spanX、spanY自动选位并添加
+     *
+     * 项目的screen、x、y按选中的位置改写；需要新页面时随之创建，
+     * 并在必要时增大LayoutConfig::pageCount。
+     * @param area 区域，仅HOME、HOME_ONLY有网格
+     * @param item 要添加的项目
+     * @param strategy 选位策略
+     * @param location 不为空时写入添加后的位置
+     * @return 是否添加成功
+     */
+    bool placeItem(LayoutArea area, const Item& item, PlacementStrategy strategy = PlacementStrategy::FIRST_FIT,
+                   ItemLocation* location = nullptr);
+
+    /**
+     * @brief 获取布局配置的指纹
+     */
+    Fingerprint getConfigFingerprint() const;
+
+    /**
+     * @brief 获取区域的指纹
+     *
+     * 首次查询时计算，之后随增删移动增量维护。Home、HomeOnly按页组合，
+     * 页内的项目顺序不影响指纹（位置由screen、x、y表示）；
+     * 两个快捷栏与AppOrder的顺序有意义，修改后在下次查询时重新计算。
+     * @param area 区域
+     */
+    Fingerprint getAreaFingerprint(LayoutArea area) const;
+
+    /**
+     * @brief 获取页面的指纹，空页面与不存在的页面相同
+     * @param area 区域，单列表区域只有第0页（即整个区域）
+     * @param pageIndex 页面索引
+     */
+    Fingerprint getPageFingerprint(LayoutArea area, int pageIndex) const;
+
+    /**
+     * @brief 获取项目的指纹，文件夹包含其中的项目（按顺序）
+     * @param location 项目位置，无效时返回空指纹
+     */
+    Fingerprint getItemFingerprint(const ItemLocation& location) const;
+
+    /**
+     * @brief 获取整个布局（配置与全部区域）的指纹
+     */
+    Fingerprint getLayoutFingerprint() const;
+
+    /**
+     * @brief 获取解析器使用的字符串池（默认的池不加锁，不能跨线程共享）
+     */
+    std::shared_ptr<StringPool> getStringPool() const;
+
+    /**
+     * @brief 更换字符串池（例如与其他解析器共享），已有项目的ID随之更新
+     * @param pool 新的字符串池，为空时创建独立的池
+     */
+    void setStringPool(std::shared_ptr<StringPool> pool);
+
     /**
      * @brief 清空所有数据
      */
     void clear();
 
 private:
+    friend const LayoutModel& layoutOf(const EXMLParser& parser);
+    friend void prepareForSharing(EXMLParser& parser);
+    friend LayoutModel& editableModel(EXMLParser& parser, LayoutArea area);
+    friend void areaEdited(EXMLParser& parser, LayoutArea area);
+    friend void copyLayout(const EXMLParser& from, EXMLParser& to);
+    friend size_t lazyStateMemory(const EXMLParser& parser);
+
     std::unique_ptr<EXMLParserImpl> pImpl;
 };
 
+/**
+ * @brief 批量加载选项
+ */
+struct EXML_PARSER_API BatchOptions {
+    LoadOptions load;            // 每个文件的加载选项
+    unsigned int threadCount;    // 工作线程数，0表示使用全部硬件线程
+    std::shared_ptr<StringPool> stringPool;  // 所有结果共享的字符串池，为空时各解析器独立
+    AllocationMode allocation;   // 每个解析器的内存分配方式
+
+    BatchOptions();
+};
+
+/**
+ * @brief 单个文件的批量加载结果
+ */
+struct EXML_PARSER_API ParseResult {
+    std::string path;                    // 文件路径
+    bool success;                        // 是否加载成功
+    std::string error;                   // 失败原因
+    std::unique_ptr<EXMLParser> parser;  // 加载成功时持有解析结果
+
+    ParseResult();
+    ~ParseResult();
+    ParseResult(ParseResult&& other) noexcept;
+    ParseResult& operator=(ParseResult&& other) noexcept;
+};
+
+/**
+ * @brief 在有界线程池上批量加载EXML文件
+ *
+ * 每个工作线程复用自己的读文件缓冲区（DOM模式下还复用XMLDocument），
+ * 单个文件失败不影响其他文件。
+ * @param paths 文件路径列表
+ * @param options 批量加载选项
+ * @return 与paths一一对应的加载结果
+ */
+EXML_PARSER_API std::vector<ParseResult> parseMany(const std::vector<std::string>& paths,
+                                                   const BatchOptions& options = BatchOptions());
+
 } // namespace exml
 
 #endif // EXML_PARSER_H
@@ -0,0 +1,103 @@
+#ifndef EXML_STORE_H
+#define EXML_STORE_H
+
+#include "exml_parser.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace exml {
+
+// 前向声明
+class LayoutStoreImpl;
+
+/**
+ * @brief 布局中的一个内容块：Home、HomeOnly的一页，或一个单列表区域
+ */
+struct EXML_PARSER_API ChunkRef {
+    LayoutArea area;
+    int page;                   // 单列表区域为0
+    Fingerprint chunk;          // 即getPageFingerprint(area, page)
+
+    ChunkRef();
+};
+
+/**
+ * @brief 按内容寻址的布局存储
+ *
+ * 每个布局拆分为配置块、文档骨架块（未识别的顶层元素、空白与换行风格等）
+ * 与页面/区域块，块以指纹为键，相同的块只保存一份；布局本身只记录所引用的块。
+ * 空页面与空区域不保存。
+ * 块的指纹与页内顺序无关（见EXMLParser::getPageFingerprint），布局另外记录
+ * 与块中版本不同的项目顺序与显式写出的属性，恢复后保存的文档与存入时相同
+ * （与快照相同，区域按模型重新序列化，项目中未识别的属性不保留）。
+ * 非线程安全。
+ */
+class EXML_PARSER_API LayoutStore {
+public:
+    LayoutStore();
+    ~LayoutStore();
+
+    // 禁用拷贝构造和赋值
+    LayoutStore(const LayoutStore&) = delete;
+    LayoutStore& operator=(const LayoutStore&) = delete;
+
+    /**
+     * @brief 存入布局，同名布局被替换
+     * @param name 布局名（如设备或备份ID）
+     * @param layout 要存入的布局
+     */
+    void put(const std::string& name, const EXMLParser& layout);
+
+    /**
+     * @brief 按名字恢复布局
+     * @param name 布局名
+     * @param out 接收布局，原有内容被清空
+     * @return 布局是否存在
+     */
+    bool restore(const std::string& name, EXMLParser& out) const;
+
+    /**
+     * @brief 删除布局，不再被引用的块随之释放
+     * @return 布局是否存在
+     */
+    bool remove(const std::string& name);
+
+    bool contains(const std::string& name) const;
+
+    /**
+     * @brief 获取布局引用的页面/区域块
+     * @return 按区域、页面顺序排列；布局不存在时为空
+     */
+    std::vector<ChunkRef> getChunks(const std::string& name) const;
+
+    /**
+     * @brief 查找包含某个块（页面、区域、配置或骨架指纹）的所有布局
+     * @return 布局名，按存入顺序排列
+     */
+    std::vector<std::string> findLayouts(const Fingerprint& chunk) const;
+
+    size_t getLayoutCount() const;
+
+    /**
+     * @brief 不同的块数（含配置块与骨架块）
+     */
+    size_t getChunkCount() const;
+
+    /**
+     * @brief 各块中保存的顶层项目总数，与逐个保存相比可估算去重效果
+     */
+    size_t getStoredItemCount() const;
+
+    /**
+     * @brief 删除全部布局与块
+     */
+    void clear();
+
+private:
+    std::unique_ptr<LayoutStoreImpl> pImpl;
+};
+
+} // namespace exml
+
+#endif // EXML_STORE_H
@@ -0,0 +1,76 @@
+#ifndef EXML_TRANSACTION_H
+#define EXML_TRANSACTION_H
+
+#include "exml_parser.h"
+#include <memory>
+#include <string>
+
+namespace exml {
+
+// 前向声明
+class LayoutTransactionImpl;
+
+/**
+ * @brief 批量修改布局的事务
+ *
+ * 添加、删除、移动操作先记录下来，commit()时按记录顺序校验，全部有效才一次性生效：
+ * 每个受影响的区域只重建一次容器，项目按最终顺序放入，不再为每个操作移动后续项目。
+ * 结果与依次调用EXMLParser的同名单项操作相同。
+ * 事务持有解析器的引用，解析器的生命周期需长于事务；析构时未提交的操作被丢弃。
+ */
+class EXML_PARSER_API LayoutTransaction {
+public:
+    explicit LayoutTransaction(EXMLParser& parser);
+    ~LayoutTransaction();
+
+    // 禁用拷贝构造和赋值
+    LayoutTransaction(const LayoutTransaction&) = delete;
+    LayoutTransaction& operator=(const LayoutTransaction&) = delete;
+
+    /**
+     * @brief 记录添加操作（同addHomeItem等，单列表区域忽略pageIndex）
+     */
+    void addItem(LayoutArea area, int pageIndex, const Item& item);
+    void addItem(LayoutArea area, int pageIndex, Item&& item);
+
+    /**
+     * @brief 记录删除操作（同removeHomeItem等，单列表区域忽略pageIndex）
+     */
+    void removeItem(LayoutArea area, int pageIndex, const std::string& packageName, const std::string& className);
+
+    /**
+     * @brief 记录移动操作（同moveHomeItem等，单列表区域忽略页码）
+     */
+    void moveItem(LayoutArea area, int fromPage, int fromIndex, int toPage, int toIndex);
+
+    /**
+     * @brief 已记录的操作数
+     */
+    size_t size() const;
+
+    /**
+     * @brief 提交全部操作
+     *
+     * 任一操作无效（对应的单项操作会返回false）时布局保持不变，原因见getError()。
+     * 无论成功与否，已记录的操作都被清空。
+     * @return 是否全部生效
+     */
+    bool commit();
+
+    /**
+     * @brief 丢弃已记录的操作
+     */
+    void rollback();
+
+    /**
+     * @brief 最近一次提交失败的原因，成功时为空
+     */
+    const std::string& getError() const;
+
+private:
+    std::unique_ptr<LayoutTransactionImpl> pImpl;
+};
+
+} // namespace exml
+
+#endif // EXML_TRANSACTION_H
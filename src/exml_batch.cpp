@@ -0,0 +1,75 @@
+#include "exml_parser.h"
+#include "exml_internal.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace exml {
+
+BatchOptions::BatchOptions() : threadCount(0), allocation(AllocationMode::HEAP) {}
+
+ParseResult::ParseResult() : success(false) {}
+ParseResult::~ParseResult() = default;
+ParseResult::ParseResult(ParseResult&& other) noexcept = default;
+ParseResult& ParseResult::operator=(ParseResult&& other) noexcept = default;
+
+namespace {
+
+void parseOne(const std::string& path, const BatchOptions& options, std::string& buffer, ParseResult& result) {
+    result.path = path;
+    auto parser = std::make_unique<EXMLParser>(options.allocation);
+    if (options.stringPool) parser->setStringPool(options.stringPool);
+    if (options.load.mode == LoadMode::DOM) {
+        result.success = parser->loadFromFile(path, options.load);
+    } else if (readFileContents(path, buffer)) {
+        result.success = parser->loadFromMemory(buffer.data(), buffer.size(), options.load);
+    } else {
+        result.error = "Failed to load XML file: " + path;
+        return;
+    }
+    if (result.success) result.parser = std::move(parser);
+    else result.error = parser->getLastError();
+}
+
+} // namespace
+
+std::vector<ParseResult> parseMany(const std::vector<std::string>& paths, const BatchOptions& options) {
+    std::vector<ParseResult> results(paths.size());
+    if (paths.empty()) return results;
+
+    size_t threadCount = options.threadCount ? options.threadCount : std::thread::hardware_concurrency();
+    threadCount = std::min(std::max<size_t>(threadCount, 1), paths.size());
+
+    // 工作线程按序号领取文件，结果直接写入对应位置
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        std::string buffer;   // 读文件缓冲区，在同一线程内复用
+        for (size_t index = next++; index < paths.size(); index = next++) {
+#if EXML_HAS_EXCEPTIONS
+            // 解码本身不抛异常，这里只兜住内存不足等情况，不让单个文件影响整批
+            try {
+                parseOne(paths[index], options, buffer, results[index]);
+            } catch (const std::exception& e) {
+                results[index].success = false;
+                results[index].parser.reset();
+                results[index].error = e.what();
+            }
+#else
+            parseOne(paths[index], options, buffer, results[index]);
+#endif
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
+} // namespace exml
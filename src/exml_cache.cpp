@@ -0,0 +1,266 @@
+#include "exml_cache.h"
+#include "exml_fingerprint.h"
+#include "exml_internal.h"
+#include "exml_model.h"
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _WIN32
+    #include <filesystem>
+#else
+    #include <sys/stat.h>
+#endif
+
+namespace exml {
+
+CacheOptions::CacheOptions() : byteBudget(64u << 20), validation(CacheValidation::FILE_IDENTITY) {}
+
+CacheStats::CacheStats() : hits(0), misses(0), evictions(0) {}
+
+namespace {
+
+// 文件的身份：任一字段变化即视为文件已改变
+struct FileIdentity {
+    uint64_t size = 0;
+    int64_t modified = 0;   // 修改时间（纳秒或平台的文件时间单位）
+    uint64_t device = 0;
+    uint64_t inode = 0;
+
+    bool operator==(const FileIdentity& other) const {
+        return size == other.size && modified == other.modified && device == other.device && inode == other.inode;
+    }
+};
+
+bool statFile(const std::string& path, FileIdentity& identity) {
+#ifdef _WIN32
+    // Windows上没有稳定的inode，只比较大小与修改时间
+    std::error_code ec;
+    identity.size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    identity.modified = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+    identity.size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+    identity.modified = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    identity.modified = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    identity.device = static_cast<uint64_t>(st.st_dev);
+    identity.inode = static_cast<uint64_t>(st.st_ino);
+    return true;
+#endif
+}
+
+// 项目只保存字符串ID，字符串本身在字符串池中
+size_t itemMemory(const ItemRecord& item) {
+    size_t bytes = sizeof(ItemRecord) + (item.favorites.capacity() - item.favorites.size()) * sizeof(ItemRecord);
+    for (const auto& child : item.favorites) bytes += itemMemory(child);
+    return bytes;
+}
+
+size_t itemsMemory(const ItemList& items) {
+    size_t bytes = (items.capacity() - items.size()) * sizeof(ItemRecord);
+    for (const auto& item : items) bytes += itemMemory(item);
+    // 每个项目在包名索引中约占一个位置记录
+    return bytes + items.size() * sizeof(ItemLocation);
+}
+
+// 解析结果占用内存的估算：项目、文档骨架（含区域原文）、按页的容器开销、
+// 按需建立的索引/占用表/指纹，以及解析器独占的字符串池
+size_t layoutMemory(const EXMLParser& parser) {
+    const LayoutModel& model = layoutOf(parser);
+    constexpr size_t kPageOverhead = 64;
+    size_t bytes = sizeof(EXMLParser) + sizeof(LayoutModel);
+    for (const PagedItems* pages : {&model.homeItems, &model.homeOnlyItems}) {
+        for (const auto& page : *pages) bytes += kPageOverhead + itemsMemory(page.second);
+    }
+    bytes += itemsMemory(model.hotseatItems) + itemsMemory(model.hotseatHomeOnlyItems) +
+             itemsMemory(model.appOrderItems);
+    for (const auto& segment : model.skeleton) {
+        bytes += sizeof(DocumentSegment) + stringMemory(segment.text) + stringMemory(segment.source) +
+                 stringMemory(segment.itemSeparator) + stringMemory(segment.closeSeparator) +
+                 stringMemory(segment.childSeparator) + stringMemory(segment.childCloseSeparator);
+    }
+    bytes += lazyStateMemory(parser);
+    // 与其他解析器共享的池不随本条目释放，不计入
+    if (model.stringPool.use_count() == 1) bytes += model.stringPool->memoryUsage();
+    return bytes;
+}
+
+std::string contentKey(const std::string& data) {
+    FingerprintHasher hasher;
+    hasher.add(std::string_view(data));
+    const Fingerprint fingerprint = hasher.finish();
+    std::string key(sizeof(fingerprint.low) + sizeof(fingerprint.high), '\0');
+    std::memcpy(&key[0], &fingerprint.low, sizeof(fingerprint.low));
+    std::memcpy(&key[sizeof(fingerprint.low)], &fingerprint.high, sizeof(fingerprint.high));
+    return key;
+}
+
+} // namespace
+
+class LayoutCacheImpl {
+public:
+    // 链表头部为最近使用的条目
+    struct Entry {
+        std::string key;            // FILE_IDENTITY为路径，CONTENT_HASH为内容指纹
+        FileIdentity identity;
+        std::shared_ptr<const EXMLParser> layout;
+        size_t bytes = 0;
+    };
+
+    explicit LayoutCacheImpl(const CacheOptions& options) : options(options) {}
+
+    CacheOptions options;
+    mutable std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t memoryUsage = 0;
+    CacheStats stats;
+
+    // 以下方法均需持有mutex
+
+    std::shared_ptr<const EXMLParser> find(const std::string& key, const FileIdentity* identity) {
+        auto it = index.find(key);
+        if (it == index.end()) return nullptr;
+        if (identity && !(it->second->identity == *identity)) {
+            erase(it->second);
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        ++stats.hits;
+        return it->second->layout;
+    }
+
+    void insert(const std::string& key, const FileIdentity& identity, const std::shared_ptr<const EXMLParser>& layout,
+                size_t bytes) {
+        auto it = index.find(key);
+        if (it != index.end()) erase(it->second);
+        if (bytes > options.byteBudget) return;
+
+        Entry entry;
+        entry.key = key;
+        entry.identity = identity;
+        entry.layout = layout;
+        entry.bytes = bytes;
+        entries.push_front(std::move(entry));
+        index.emplace(key, entries.begin());
+        memoryUsage += bytes;
+        evict();
+    }
+
+    void erase(std::list<Entry>::iterator entry) {
+        memoryUsage -= entry->bytes;
+        index.erase(entry->key);
+        entries.erase(entry);
+    }
+
+    void evict() {
+        while (memoryUsage > options.byteBudget && !entries.empty()) {
+            erase(std::prev(entries.end()));
+            ++stats.evictions;
+        }
+    }
+};
+
+LayoutCache::LayoutCache(const CacheOptions& options) : pImpl(std::make_unique<LayoutCacheImpl>(options)) {}
+
+LayoutCache::~LayoutCache() = default;
+
+std::shared_ptr<const EXMLParser> LayoutCache::load(const std::string& filePath, std::string* error) {
+    const bool byContent = pImpl->options.validation == CacheValidation::CONTENT_HASH;
+    FileIdentity identity;
+    std::string buffer;
+    std::string key = filePath;
+    if (!statFile(filePath, identity) || (byContent && !readFileContents(filePath, buffer))) {
+        if (error) *error = "Failed to load XML file: " + filePath;
+        return nullptr;
+    }
+    if (byContent) key = contentKey(buffer);
+
+    {
+        std::lock_guard<std::mutex> lock(pImpl->mutex);
+        // 按内容缓存时键已包含内容，不再比较文件身份
+        std::shared_ptr<const EXMLParser> cached = pImpl->find(key, byContent ? nullptr : &identity);
+        if (cached) return cached;
+        ++pImpl->stats.misses;
+    }
+
+    // 解析在锁外进行，不阻塞其他文件的命中
+    auto parser = std::make_shared<EXMLParser>();
+    bool loaded = false;
+    if (byContent) {
+        // 解析计算键时读入的内容，不再读取文件：文件在两次读取之间改变时，缓存的结果仍与键一致
+        loaded = parser->loadFromMemory(buffer.data(), buffer.size(), pImpl->options.load);
+    } else if (pImpl->options.load.mode == LoadMode::DOM) {
+        loaded = parser->loadFromFile(filePath, pImpl->options.load);
+    } else if (readFileContents(filePath, buffer)) {
+        loaded = parser->loadFromMemory(buffer.data(), buffer.size(), pImpl->options.load);
+    }
+    if (!loaded) {
+        if (error) *error = parser->getLastError().empty() ? "Failed to load XML file: " + filePath
+                                                           : parser->getLastError();
+        return nullptr;
+    }
+    prepareForSharing(*parser);
+
+    std::shared_ptr<const EXMLParser> layout = std::move(parser);
+    const size_t bytes = layoutMemory(*layout);
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->insert(key, identity, layout, bytes);
+    return layout;
+}
+
+bool LayoutCache::invalidate(const std::string& filePath) {
+    std::string key = filePath;
+    if (pImpl->options.validation == CacheValidation::CONTENT_HASH) {
+        std::string buffer;
+        if (!readFileContents(filePath, buffer)) return false;
+        key = contentKey(buffer);
+    }
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    auto it = pImpl->index.find(key);
+    if (it == pImpl->index.end()) return false;
+    pImpl->erase(it->second);
+    return true;
+}
+
+void LayoutCache::clear() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->entries.clear();
+    pImpl->index.clear();
+    pImpl->memoryUsage = 0;
+}
+
+void LayoutCache::setByteBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->options.byteBudget = bytes;
+    pImpl->evict();
+}
+
+size_t LayoutCache::getByteBudget() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->options.byteBudget;
+}
+
+size_t LayoutCache::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->memoryUsage;
+}
+
+size_t LayoutCache::getEntryCount() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->entries.size();
+}
+
+CacheStats LayoutCache::getStats() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->stats;
+}
+
+} // namespace exml
@@ -0,0 +1,427 @@
+#include "exml_columnar.h"
+#include "exml_internal.h"
+#include "exml_model.h"
+#include "exml_schema.h"
+#include "exml_walker.h"
+#include <algorithm>
+#include <iostream>
+
+namespace exml {
+
+RowRange::RowRange() : begin(0), end(0) {}
+
+RowRange::RowRange(uint32_t begin, uint32_t end) : begin(begin), end(end) {}
+
+namespace {
+
+// 加载时的一行，区域读完后再按列拆开
+struct Row {
+    uint8_t type = static_cast<uint8_t>(ItemType::FAVORITE);
+    int screen = 0;
+    int x = 0;
+    int y = 0;
+    int spanX = 1;
+    int spanY = 1;
+    int appWidgetID = 0;
+    int options = 0;
+    int color = -1;
+    uint8_t hidden = 0;
+    uint32_t packageId = 0;
+    uint32_t classId = 0;
+    uint32_t titleId = 0;
+    uint32_t firstChild = 0;    // 加载时为在子项表中的位置
+    uint32_t childCount = 0;
+};
+
+bool isPaged(LayoutArea area) {
+    return area == LayoutArea::HOME || area == LayoutArea::HOME_ONLY;
+}
+
+} // namespace
+
+class ColumnarLayoutImpl {
+public:
+    explicit ColumnarLayoutImpl(std::shared_ptr<StringPool> pool)
+        : stringPool(pool ? std::move(pool) : std::make_shared<StringPool>(false)) {}
+
+    std::shared_ptr<StringPool> stringPool;
+    LayoutConfig layoutConfig;
+
+    std::vector<uint8_t> areas;
+    std::vector<uint8_t> types;
+    std::vector<int> screens;
+    std::vector<int> xs;
+    std::vector<int> ys;
+    std::vector<int> spanXs;
+    std::vector<int> spanYs;
+    std::vector<int> appWidgetIDs;
+    std::vector<int> options;
+    std::vector<int> colors;
+    std::vector<uint8_t> hidden;
+    std::vector<uint32_t> packageIds;
+    std::vector<uint32_t> classIds;
+    std::vector<uint32_t> titleIds;
+    std::vector<uint32_t> firstChildren;
+    std::vector<uint32_t> childCounts;
+    RowRange areaRows[kLayoutAreaCount];
+    uint32_t itemCount = 0;                     // 顶层项目数，文件夹内的应用从此行开始
+
+    // 加载过程中的暂存
+    std::vector<Row> pending[kLayoutAreaCount];
+    std::vector<Row> pendingChildren;
+    std::string decoded;                        // 含实体的属性值解码后再驻留，复用容量
+
+    void clearColumns() {
+        for (auto* column : {&areas, &types, &hidden}) column->clear();
+        for (auto* column : {&screens, &xs, &ys, &spanXs, &spanYs, &appWidgetIDs, &options, &colors}) {
+            column->clear();
+        }
+        for (auto* column : {&packageIds, &classIds, &titleIds, &firstChildren, &childCounts}) {
+            column->clear();
+        }
+        for (auto& range : areaRows) range = RowRange();
+        itemCount = 0;
+    }
+
+    void reset() {
+        clearColumns();
+        layoutConfig = LayoutConfig();
+        for (auto& rows : pending) rows.clear();
+        pendingChildren.clear();
+    }
+
+    void appendRow(const Row& row, uint8_t area, int screen, uint32_t childBase) {
+        areas.push_back(area);
+        types.push_back(row.type);
+        screens.push_back(screen);
+        xs.push_back(row.x);
+        ys.push_back(row.y);
+        spanXs.push_back(row.spanX);
+        spanYs.push_back(row.spanY);
+        appWidgetIDs.push_back(row.appWidgetID);
+        options.push_back(row.options);
+        colors.push_back(row.color);
+        hidden.push_back(row.hidden);
+        packageIds.push_back(row.packageId);
+        classIds.push_back(row.classId);
+        titleIds.push_back(row.titleId);
+        firstChildren.push_back(row.childCount ? childBase + row.firstChild : 0);
+        childCounts.push_back(row.childCount);
+    }
+
+    // 把暂存的行按区域顺序写入各列：Home、HomeOnly按screen稳定排序，文件夹内的应用排在最后
+    void flush() {
+        size_t total = pendingChildren.size();
+        for (const auto& rows : pending) total += rows.size();
+        clearColumns();
+        for (auto* column : {&areas, &types, &hidden}) column->reserve(total);
+        for (auto* column : {&screens, &xs, &ys, &spanXs, &spanYs, &appWidgetIDs, &options, &colors}) {
+            column->reserve(total);
+        }
+        for (auto* column : {&packageIds, &classIds, &titleIds, &firstChildren, &childCounts}) {
+            column->reserve(total);
+        }
+
+        for (const auto& rows : pending) itemCount += static_cast<uint32_t>(rows.size());
+        // 文件夹内的应用沿用所属文件夹的区域与screen
+        std::vector<uint32_t> parents(pendingChildren.size(), 0);
+        for (int area = 0; area < kLayoutAreaCount; ++area) {
+            std::vector<Row>& rows = pending[area];
+            if (isPaged(static_cast<LayoutArea>(area))) {
+                std::stable_sort(rows.begin(), rows.end(),
+                    [](const Row& a, const Row& b) { return a.screen < b.screen; });
+            }
+            areaRows[area].begin = static_cast<uint32_t>(types.size());
+            for (const Row& row : rows) {
+                for (uint32_t i = 0; i < row.childCount; ++i) {
+                    parents[row.firstChild + i] = static_cast<uint32_t>(types.size());
+                }
+                appendRow(row, static_cast<uint8_t>(area), row.screen, itemCount);
+            }
+            areaRows[area].end = static_cast<uint32_t>(types.size());
+        }
+        for (size_t i = 0; i < pendingChildren.size(); ++i) {
+            appendRow(pendingChildren[i], areas[parents[i]], screens[parents[i]], 0);
+        }
+
+        for (auto& rows : pending) rows.clear();
+        pendingChildren.clear();
+    }
+
+    // ===== 由XML加载 =====
+
+    uint32_t internValue(const detail::XmlAttribute& attr) {
+        if (!attr.hasEntity) return stringPool->intern(attr.value);
+        decoded.clear();
+        detail::appendDecoded(attr.value, decoded);
+        return stringPool->intern(decoded);
+    }
+
+    void assignAttribute(Row& row, const detail::XmlAttribute& attr) {
+        const detail::AttributeDesc* desc = detail::findItemAttribute(attr.name);
+        if (!desc) return;
+        bool flag = false;
+        switch (desc->bit) {
+            case ATTR_PACKAGE_NAME: row.packageId = internValue(attr); break;
+            case ATTR_CLASS_NAME: row.classId = internValue(attr); break;
+            case ATTR_TITLE: row.titleId = internValue(attr); break;
+            case ATTR_SCREEN: decodeInt(attr.value, row.screen); break;
+            case ATTR_X: decodeInt(attr.value, row.x); break;
+            case ATTR_Y: decodeInt(attr.value, row.y); break;
+            case ATTR_SPAN_X: decodeInt(attr.value, row.spanX); break;
+            case ATTR_SPAN_Y: decodeInt(attr.value, row.spanY); break;
+            case ATTR_APP_WIDGET_ID: decodeInt(attr.value, row.appWidgetID); break;
+            case ATTR_OPTIONS: decodeInt(attr.value, row.options); break;
+            case ATTR_COLOR: decodeInt(attr.value, row.color); break;
+            case ATTR_HIDDEN:
+                if (decodeBool(attr.value, flag)) row.hidden = flag ? 1 : 0;
+                break;
+        }
+    }
+
+    bool readItem(detail::XmlReader& reader, const detail::XmlToken& start, Row& row) {
+        row.type = static_cast<uint8_t>(itemTypeFromTag(start.name));
+        for (const auto& attr : reader.attributes()) {
+            assignAttribute(row, attr);
+        }
+        if (start.selfClosing) return true;
+        if (row.type != static_cast<uint8_t>(ItemType::FOLDER)) return detail::skipElement(reader);
+
+        // 文件夹内只有favorite元素，不会再嵌套文件夹，子项连续存放
+        row.firstChild = static_cast<uint32_t>(pendingChildren.size());
+        detail::XmlToken token;
+        while (reader.next(token)) {
+            if (token.type == detail::XmlTokenType::EndElement) {
+                row.childCount = static_cast<uint32_t>(pendingChildren.size()) - row.firstChild;
+                return token.name == start.name;
+            }
+            if (token.type != detail::XmlTokenType::StartElement) continue;
+            if (token.name == "favorite") {
+                Row child;
+                if (!readItem(reader, token, child)) return false;
+                pendingChildren.push_back(child);
+            } else if (!token.selfClosing && !detail::skipElement(reader)) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // walkDocument回调
+    bool isSection(std::string_view tag) const {
+        LayoutArea area;
+        return findSectionArea(tag, area);
+    }
+
+    bool readSection(detail::XmlReader& reader, const detail::XmlToken& start) {
+        LayoutArea area = LayoutArea::APP_ORDER;
+        findSectionArea(start.name, area);
+        std::vector<Row>& target = pending[static_cast<int>(area)];
+        if (start.selfClosing) return true;
+
+        detail::XmlToken token;
+        while (reader.next(token)) {
+            if (token.type == detail::XmlTokenType::EndElement) return token.name == start.name;
+            if (token.type != detail::XmlTokenType::StartElement) continue;
+            Row row;
+            if (!readItem(reader, token, row)) return false;
+            target.push_back(row);
+        }
+        return false;
+    }
+
+    bool configValue(std::string_view tag, const std::string& text, std::string_view) {
+        return applyConfigValue(layoutConfig, tag, text);
+    }
+
+    void raw(std::string_view) {}
+
+    // ===== 由模型生成 =====
+
+    // 与解析器共用字符串池时直接沿用其ID
+    uint32_t internString(uint32_t id, const StringPool& source, bool samePool) {
+        return samePool ? id : stringPool->intern(source.lookup(id));
+    }
+
+    Row rowOf(const ItemRecord& item, const StringPool& source, bool samePool) {
+        Row row;
+        row.type = static_cast<uint8_t>(item.type);
+        row.screen = item.screen;
+        row.x = item.x;
+        row.y = item.y;
+        row.spanX = item.spanX;
+        row.spanY = item.spanY;
+        row.appWidgetID = item.appWidgetID;
+        row.options = item.options;
+        row.color = item.color;
+        row.hidden = item.hidden ? 1 : 0;
+        row.packageId = internString(item.packageId, source, samePool);
+        row.classId = internString(item.classId, source, samePool);
+        row.titleId = internString(item.titleId, source, samePool);
+        return row;
+    }
+
+    // 按页存储的区域以页码为screen，与EXMLParser的分页一致
+    void stageItems(const ItemList& items, int area, int page, const StringPool& source, bool samePool) {
+        for (const ItemRecord& item : items) {
+            Row row = rowOf(item, source, samePool);
+            if (isPaged(static_cast<LayoutArea>(area))) row.screen = page;
+            row.firstChild = static_cast<uint32_t>(pendingChildren.size());
+            row.childCount = static_cast<uint32_t>(item.favorites.size());
+            for (const ItemRecord& child : item.favorites) pendingChildren.push_back(rowOf(child, source, samePool));
+            pending[area].push_back(row);
+        }
+    }
+};
+
+ColumnarLayout::ColumnarLayout(std::shared_ptr<StringPool> pool)
+    : pImpl(std::make_unique<ColumnarLayoutImpl>(std::move(pool))) {}
+
+ColumnarLayout::~ColumnarLayout() = default;
+
+bool ColumnarLayout::loadFromFile(const std::string& filePath) {
+    std::string buffer;
+    if (!readFileContents(filePath, buffer)) {
+        std::cerr << "Failed to load XML file: " << filePath << std::endl;
+        clear();
+        return false;
+    }
+    return loadFromMemory(buffer.data(), buffer.size());
+}
+
+bool ColumnarLayout::loadFromMemory(const char* data, size_t size) {
+    pImpl->reset();
+    detail::XmlReader reader(data, size);
+    std::string error;
+    if (!detail::walkDocument(reader, *pImpl, error)) {
+        std::cerr << "Error parsing XML: " << error << std::endl;
+        pImpl->reset();
+        return false;
+    }
+    pImpl->flush();
+    return true;
+}
+
+void ColumnarLayout::build(const EXMLParser& parser) {
+    pImpl->reset();
+    const LayoutModel& model = layoutOf(parser);
+    const StringPool& source = *model.stringPool;
+    const bool samePool = model.stringPool == pImpl->stringPool;
+    pImpl->layoutConfig = model.layoutConfig;
+    for (const auto& page : model.homeItems) {
+        pImpl->stageItems(page.second, static_cast<int>(LayoutArea::HOME), page.first, source, samePool);
+    }
+    pImpl->stageItems(model.hotseatItems, static_cast<int>(LayoutArea::HOTSEAT), 0, source, samePool);
+    for (const auto& page : model.homeOnlyItems) {
+        pImpl->stageItems(page.second, static_cast<int>(LayoutArea::HOME_ONLY), page.first, source, samePool);
+    }
+    pImpl->stageItems(model.hotseatHomeOnlyItems, static_cast<int>(LayoutArea::HOTSEAT_HOME_ONLY), 0, source,
+                      samePool);
+    pImpl->stageItems(model.appOrderItems, static_cast<int>(LayoutArea::APP_ORDER), 0, source, samePool);
+    pImpl->flush();
+}
+
+void ColumnarLayout::clear() {
+    pImpl->reset();
+}
+
+const LayoutConfig& ColumnarLayout::getLayoutConfig() const {
+    return pImpl->layoutConfig;
+}
+
+std::shared_ptr<StringPool> ColumnarLayout::getStringPool() const {
+    return pImpl->stringPool;
+}
+
+size_t ColumnarLayout::getRowCount() const {
+    return pImpl->types.size();
+}
+
+RowRange ColumnarLayout::getAreaRows(LayoutArea area) const {
+    return pImpl->areaRows[static_cast<int>(area)];
+}
+
+RowRange ColumnarLayout::getItemRows() const {
+    return RowRange(0, pImpl->itemCount);
+}
+
+RowRange ColumnarLayout::getFolderChildRows() const {
+    return RowRange(pImpl->itemCount, static_cast<uint32_t>(pImpl->types.size()));
+}
+
+namespace {
+
+template <typename T>
+Span<T> columnSpan(const std::vector<T>& column) {
+    return Span<T>(column.data(), column.size());
+}
+
+} // namespace
+
+Span<uint8_t> ColumnarLayout::areas() const { return columnSpan(pImpl->areas); }
+Span<uint8_t> ColumnarLayout::types() const { return columnSpan(pImpl->types); }
+Span<int> ColumnarLayout::screens() const { return columnSpan(pImpl->screens); }
+Span<int> ColumnarLayout::xs() const { return columnSpan(pImpl->xs); }
+Span<int> ColumnarLayout::ys() const { return columnSpan(pImpl->ys); }
+Span<int> ColumnarLayout::spanXs() const { return columnSpan(pImpl->spanXs); }
+Span<int> ColumnarLayout::spanYs() const { return columnSpan(pImpl->spanYs); }
+Span<int> ColumnarLayout::appWidgetIDs() const { return columnSpan(pImpl->appWidgetIDs); }
+Span<int> ColumnarLayout::options() const { return columnSpan(pImpl->options); }
+Span<int> ColumnarLayout::colors() const { return columnSpan(pImpl->colors); }
+Span<uint8_t> ColumnarLayout::hidden() const { return columnSpan(pImpl->hidden); }
+Span<uint32_t> ColumnarLayout::packageIds() const { return columnSpan(pImpl->packageIds); }
+Span<uint32_t> ColumnarLayout::classIds() const { return columnSpan(pImpl->classIds); }
+Span<uint32_t> ColumnarLayout::titleIds() const { return columnSpan(pImpl->titleIds); }
+Span<uint32_t> ColumnarLayout::firstChildren() const { return columnSpan(pImpl->firstChildren); }
+Span<uint32_t> ColumnarLayout::childCounts() const { return columnSpan(pImpl->childCounts); }
+
+// 以下循环只做比较与累加，不含分支与跨行依赖，以便编译器向量化
+
+size_t ColumnarLayout::countItems(RowRange rows, ItemType type) const {
+    const uint32_t end = std::min(rows.end, static_cast<uint32_t>(pImpl->types.size()));
+    const uint8_t* types = pImpl->types.data();
+    const uint8_t wanted = static_cast<uint8_t>(type);
+    size_t count = 0;
+    for (uint32_t i = rows.begin; i < end; ++i) count += types[i] == wanted;
+    return count;
+}
+
+size_t ColumnarLayout::countItems(RowRange rows, ItemType type, int spanX, int spanY) const {
+    const uint32_t end = std::min(rows.end, static_cast<uint32_t>(pImpl->types.size()));
+    const uint8_t* types = pImpl->types.data();
+    const int* spanXs = pImpl->spanXs.data();
+    const int* spanYs = pImpl->spanYs.data();
+    const uint8_t wanted = static_cast<uint8_t>(type);
+    size_t count = 0;
+    for (uint32_t i = rows.begin; i < end; ++i) {
+        count += (types[i] == wanted) & (spanXs[i] == spanX) & (spanYs[i] == spanY);
+    }
+    return count;
+}
+
+size_t ColumnarLayout::countPackage(RowRange rows, uint32_t packageId) const {
+    const uint32_t end = std::min(rows.end, static_cast<uint32_t>(pImpl->packageIds.size()));
+    const uint32_t* packageIds = pImpl->packageIds.data();
+    size_t count = 0;
+    for (uint32_t i = rows.begin; i < end; ++i) count += packageIds[i] == packageId;
+    return count;
+}
+
+std::vector<size_t> ColumnarLayout::spanHistogram(RowRange rows, ItemType type, int maxSpan) const {
+    if (maxSpan < 1) maxSpan = 1;
+    std::vector<size_t> counts(static_cast<size_t>(maxSpan) * maxSpan, 0);
+    const uint32_t end = std::min(rows.end, static_cast<uint32_t>(pImpl->types.size()));
+    const uint8_t* types = pImpl->types.data();
+    const int* spanXs = pImpl->spanXs.data();
+    const int* spanYs = pImpl->spanYs.data();
+    const uint8_t wanted = static_cast<uint8_t>(type);
+    // 单次扫描：跨度先截断到[1, maxSpan]，不匹配的行累加0，不需要分支
+    for (uint32_t i = rows.begin; i < end; ++i) {
+        const int x = std::min(std::max(spanXs[i], 1), maxSpan) - 1;
+        const int y = std::min(std::max(spanYs[i], 1), maxSpan) - 1;
+        counts[static_cast<size_t>(y) * maxSpan + x] += types[i] == wanted;
+    }
+    return counts;
+}
+
+} // namespace exml
@@ -0,0 +1,192 @@
+#include "exml_internal.h"
+#include "exml_model.h"
+#include <charconv>
+
+namespace exml {
+
+namespace {
+
+enum class ConfigValueType {
+    STRING,
+    BOOL,
+    INT
+};
+
+/**
+ * @brief 配置字段描述：元素名与LayoutConfig成员的对应关系
+ */
+struct ConfigField {
+    const char* tag;
+    ConfigValueType type;
+    std::string LayoutConfig::* stringMember;
+    bool LayoutConfig::* boolMember;
+    int LayoutConfig::* intMember;
+};
+
+constexpr ConfigField stringField(const char* tag, std::string LayoutConfig::* member) {
+    return {tag, ConfigValueType::STRING, member, nullptr, nullptr};
+}
+
+constexpr ConfigField boolField(const char* tag, bool LayoutConfig::* member) {
+    return {tag, ConfigValueType::BOOL, nullptr, member, nullptr};
+}
+
+constexpr ConfigField intField(const char* tag, int LayoutConfig::* member) {
+    return {tag, ConfigValueType::INT, nullptr, nullptr, member};
+}
+
+// 按三星备份文件中的出现顺序排列，默认格式输出时沿用此顺序
+const ConfigField kConfigFields[] = {
+    stringField("category", &LayoutConfig::category),
+    stringField("FolderGrid", &LayoutConfig::folderGrid),
+    boolField("restore_max_size_grid", &LayoutConfig::restoreMaxSizeGrid),
+    stringField("zeroPageContents", &LayoutConfig::zeroPageContents),
+    stringField("selectedMinusonePackage", &LayoutConfig::selectedMinusonePackage),
+    boolField("zeroPage", &LayoutConfig::zeroPage),
+    boolField("notification_panel_setting", &LayoutConfig::notificationPanelSetting),
+    boolField("lock_layout_setting", &LayoutConfig::lockLayoutSetting),
+    boolField("quick_access_finder", &LayoutConfig::quickAccessFinder),
+    intField("badge_on_off_setting", &LayoutConfig::badgeOnOffSetting),
+    boolField("only_portrait_mode_setting", &LayoutConfig::onlyPortraitModeSetting),
+    boolField("add_icon_to_home_setting", &LayoutConfig::addIconToHomeSetting),
+    boolField("suggested_apps", &LayoutConfig::suggestedApps),
+    intField("expand_hotseat_size", &LayoutConfig::expandHotseatSize),
+    stringField("home_grid_list", &LayoutConfig::homeGridList),
+    stringField("apps_grid_list", &LayoutConfig::appsGridList),
+    intField("Rows", &LayoutConfig::rows),
+    intField("Columns", &LayoutConfig::columns),
+    intField("PageCount", &LayoutConfig::pageCount),
+    intField("ScreenIndex", &LayoutConfig::screenIndex),
+    stringField("viewType_appOrder", &LayoutConfig::viewTypeAppOrder),
+};
+
+constexpr int kConfigFieldCount = static_cast<int>(sizeof(kConfigFields) / sizeof(kConfigFields[0]));
+
+/**
+ * @brief 区域元素描述，按LayoutArea的取值顺序排列
+ */
+struct SectionDesc {
+    std::string_view tag;
+    LayoutArea area;
+};
+
+constexpr SectionDesc kSections[] = {
+    {"home", LayoutArea::HOME},
+    {"hotseat", LayoutArea::HOTSEAT},
+    {"homeOnly", LayoutArea::HOME_ONLY},
+    {"hotseat_homeOnly", LayoutArea::HOTSEAT_HOME_ONLY},
+    {"appOrder", LayoutArea::APP_ORDER},
+};
+
+static_assert(sizeof(kSections) / sizeof(kSections[0]) == kLayoutAreaCount, "kSections must cover every LayoutArea");
+
+} // namespace
+
+bool findSectionArea(std::string_view tag, LayoutArea& area) {
+    for (const auto& section : kSections) {
+        if (section.tag == tag) {
+            area = section.area;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* sectionTag(LayoutArea area) {
+    return kSections[static_cast<int>(area)].tag.data();
+}
+
+int configFieldCount() {
+    return kConfigFieldCount;
+}
+
+int findConfigField(std::string_view tag) {
+    for (int i = 0; i < kConfigFieldCount; ++i) {
+        if (tag == kConfigFields[i].tag) return i;
+    }
+    return -1;
+}
+
+const char* configFieldTag(int field) {
+    return kConfigFields[field].tag;
+}
+
+bool applyConfigValue(LayoutConfig& config, std::string_view tag, const std::string& text) {
+    int field = findConfigField(tag);
+    if (field < 0) return false;
+    applyConfigField(config, field, text);
+    return true;
+}
+
+bool applyConfigField(LayoutConfig& config, int field, const std::string& text) {
+    const ConfigField& desc = kConfigFields[field];
+    switch (desc.type) {
+        case ConfigValueType::STRING:
+            config.*desc.stringMember = text;
+            return true;
+        case ConfigValueType::BOOL: {
+            bool value = LayoutConfig().*desc.boolMember;
+            const bool ok = text.empty() || decodeBool(text, value);
+            config.*desc.boolMember = value;
+            return ok;
+        }
+        case ConfigValueType::INT: {
+            int value = LayoutConfig().*desc.intMember;
+            const bool ok = text.empty() || decodeInt(text, value);
+            config.*desc.intMember = value;
+            return ok;
+        }
+    }
+    return true;
+}
+
+bool configFieldEquals(const LayoutConfig& a, const LayoutConfig& b, int field) {
+    const ConfigField& desc = kConfigFields[field];
+    switch (desc.type) {
+        case ConfigValueType::STRING: return a.*desc.stringMember == b.*desc.stringMember;
+        case ConfigValueType::BOOL: return a.*desc.boolMember == b.*desc.boolMember;
+        case ConfigValueType::INT: return a.*desc.intMember == b.*desc.intMember;
+    }
+    return true;
+}
+
+void copyConfigField(const LayoutConfig& from, LayoutConfig& to, int field) {
+    const ConfigField& desc = kConfigFields[field];
+    switch (desc.type) {
+        case ConfigValueType::STRING: to.*desc.stringMember = from.*desc.stringMember; break;
+        case ConfigValueType::BOOL: to.*desc.boolMember = from.*desc.boolMember; break;
+        case ConfigValueType::INT: to.*desc.intMember = from.*desc.intMember; break;
+    }
+}
+
+void appendConfigValue(const LayoutConfig& config, int field, std::string& out) {
+    const ConfigField& desc = kConfigFields[field];
+    switch (desc.type) {
+        case ConfigValueType::STRING:
+            out += config.*desc.stringMember;
+            break;
+        case ConfigValueType::BOOL:
+            out += config.*desc.boolMember ? "true" : "false";
+            break;
+        case ConfigValueType::INT: {
+            char buffer[16];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), config.*desc.intMember);
+            out.append(buffer, result.ptr - buffer);
+            break;
+        }
+    }
+}
+
+void appendConfigElement(const LayoutConfig& config, int field, std::string& out) {
+    const ConfigField& desc = kConfigFields[field];
+    out += '<';
+    out += desc.tag;
+    out += '>';
+    if (desc.type == ConfigValueType::STRING) appendEscapedText(config.*desc.stringMember, out);
+    else appendConfigValue(config, field, out);
+    out += "</";
+    out += desc.tag;
+    out += '>';
+}
+
+} // namespace exml
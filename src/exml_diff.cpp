@@ -0,0 +1,293 @@
+#include "exml_diff.h"
+#include "exml_internal.h"
+#include "exml_match.h"
+#include "exml_schema.h"
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+namespace exml {
+
+ItemEdit::ItemEdit() : kind(EditKind::ADDED), from{{LayoutArea::HOME, -1, 0}, -1},
+                       to{{LayoutArea::HOME, -1, 0}, -1}, changedAttributes(0) {}
+
+ConfigEdit::ConfigEdit() = default;
+
+LayoutDiff::LayoutDiff() = default;
+
+size_t ItemKeyHash::operator()(const ItemKey& key) const {
+    size_t hash = std::hash<std::string_view>()(key.packageName);
+    hash = hash * 31 + std::hash<std::string_view>()(key.className);
+    hash = hash * 31 + static_cast<size_t>(key.appWidgetID);
+    return hash * 31 + static_cast<size_t>(key.type);
+}
+
+void collectEntries(const LayoutModel& model, LayoutArea area, const ItemList& items, int page,
+                    std::vector<ItemEntry>& out) {
+    for (size_t i = 0; i < items.size(); ++i) {
+        out.push_back(ItemEntry{&items[i], model.stringPool.get(), ItemPath{ItemLocation{area, page, i}, -1}});
+    }
+}
+
+void collectEntries(const LayoutModel& model, LayoutArea area, const PagedItems& pages, std::vector<ItemEntry>& out) {
+    for (const auto& page : pages) {
+        collectEntries(model, area, page.second, page.first, out);
+    }
+}
+
+void collectChildren(const ItemEntry& folder, std::vector<ItemEntry>& out) {
+    const auto& children = folder.item->favorites;
+    for (size_t i = 0; i < children.size(); ++i) {
+        out.push_back(ItemEntry{&children[i], folder.pool, ItemPath{folder.path.location, static_cast<int>(i)}});
+    }
+}
+
+void matchEntries(const std::vector<ItemEntry>& before, const std::vector<ItemEntry>& after, std::vector<int>& matches) {
+    // 同键的旧项目按出现顺序排队，新项目依次取队首
+    struct Candidates {
+        std::vector<int> positions;
+        size_t next = 0;
+    };
+    std::unordered_map<ItemKey, Candidates, ItemKeyHash> byKey;
+    byKey.reserve(before.size());
+    for (size_t i = 0; i < before.size(); ++i) {
+        byKey[ItemKey(*before[i].item, *before[i].pool)].positions.push_back(static_cast<int>(i));
+    }
+
+    matches.assign(after.size(), -1);
+    for (size_t i = 0; i < after.size(); ++i) {
+        auto it = byKey.find(ItemKey(*after[i].item, *after[i].pool));
+        if (it != byKey.end() && it->second.next < it->second.positions.size()) {
+            matches[i] = it->second.positions[it->second.next++];
+        }
+    }
+}
+
+unsigned int changedAttributes(const ItemRecord& a, const StringPool& aPool, const ItemRecord& b,
+                               const StringPool& bPool) {
+    const bool samePool = &aPool == &bPool;
+    unsigned int changed = 0;
+    for (const auto& desc : detail::kItemAttributes) {
+        bool same = true;
+        switch (desc.type) {
+            case detail::AttributeType::STRING:
+                same = samePool ? a.*desc.idMember == b.*desc.idMember
+                                : aPool.lookup(a.*desc.idMember) == bPool.lookup(b.*desc.idMember);
+                break;
+            case detail::AttributeType::INT: same = a.*desc.recordIntMember == b.*desc.recordIntMember; break;
+            case detail::AttributeType::BOOL: same = a.*desc.recordBoolMember == b.*desc.recordBoolMember; break;
+        }
+        if (!same) changed |= desc.bit;
+    }
+    return changed;
+}
+
+namespace {
+
+constexpr unsigned int kPositionAttributes = ATTR_SCREEN | ATTR_X | ATTR_Y;
+
+// 有序序列中保持相对顺序的最多配对项：按旧序号求最长递增子序列，其余配对项的位置视为变化
+std::vector<bool> keptInOrder(const std::vector<int>& matches) {
+    std::vector<int> tails;                     // tails[k]：长度为k+1的递增子序列末项在matches中的下标
+    std::vector<int> previous(matches.size(), -1);
+    for (size_t i = 0; i < matches.size(); ++i) {
+        if (matches[i] < 0) continue;
+        auto it = std::lower_bound(tails.begin(), tails.end(), matches[i],
+                                   [&matches](int at, int value) { return matches[at] < value; });
+        if (it != tails.begin()) previous[i] = *(it - 1);
+        if (it == tails.end()) tails.push_back(static_cast<int>(i));
+        else *it = static_cast<int>(i);
+    }
+    std::vector<bool> kept(matches.size(), false);
+    for (int at = tails.empty() ? -1 : tails.back(); at >= 0; at = previous[at]) {
+        kept[at] = true;
+    }
+    return kept;
+}
+
+// ordered：序列的位置只由顺序表示（快捷栏、AppOrder与文件夹内的项目）
+void diffEntries(const std::vector<ItemEntry>& before, const std::vector<ItemEntry>& after, bool ordered,
+                 std::vector<ItemEdit>& out) {
+    std::vector<int> matches;
+    matchEntries(before, after, matches);
+    const std::vector<bool> kept = ordered ? keptInOrder(matches) : std::vector<bool>();
+
+    std::vector<bool> matched(before.size(), false);
+    std::vector<ItemEntry> childrenBefore;
+    std::vector<ItemEntry> childrenAfter;
+    for (size_t i = 0; i < after.size(); ++i) {
+        const ItemEntry& entry = after[i];
+        if (matches[i] < 0) {
+            ItemEdit edit;
+            edit.kind = EditKind::ADDED;
+            edit.to = entry.path;
+            out.push_back(edit);
+            continue;
+        }
+
+        const ItemEntry& old = before[matches[i]];
+        matched[matches[i]] = true;
+        const unsigned int changed = changedAttributes(old, entry);
+        const bool moved = old.path.location.page != entry.path.location.page || (changed & kPositionAttributes) ||
+                           (ordered && !kept[i]);
+        if (changed || moved) {
+            ItemEdit edit;
+            edit.kind = moved ? EditKind::MOVED : EditKind::MODIFIED;
+            edit.from = old.path;
+            edit.to = entry.path;
+            edit.changedAttributes = changed;
+            out.push_back(edit);
+        }
+
+        // 配对的文件夹继续比较其中的项目
+        if (entry.item->type == ItemType::FOLDER && entry.path.child < 0) {
+            childrenBefore.clear();
+            childrenAfter.clear();
+            collectChildren(old, childrenBefore);
+            collectChildren(entry, childrenAfter);
+            diffEntries(childrenBefore, childrenAfter, true, out);
+        }
+    }
+
+    for (size_t i = 0; i < before.size(); ++i) {
+        if (matched[i]) continue;
+        ItemEdit edit;
+        edit.kind = EditKind::REMOVED;
+        edit.from = before[i].path;
+        out.push_back(edit);
+    }
+}
+
+void diffArea(const LayoutModel& beforeModel, const LayoutModel& afterModel, LayoutArea area,
+              const PagedItems& before, const PagedItems& after, std::vector<ItemEdit>& out) {
+    std::vector<ItemEntry> a;
+    std::vector<ItemEntry> b;
+    collectEntries(beforeModel, area, before, a);
+    collectEntries(afterModel, area, after, b);
+    diffEntries(a, b, false, out);
+}
+
+void diffArea(const LayoutModel& beforeModel, const LayoutModel& afterModel, LayoutArea area,
+              const ItemList& before, const ItemList& after, std::vector<ItemEdit>& out) {
+    std::vector<ItemEntry> a;
+    std::vector<ItemEntry> b;
+    collectEntries(beforeModel, area, before, 0, a);
+    collectEntries(afterModel, area, after, 0, b);
+    diffEntries(a, b, true, out);
+}
+
+ItemRef itemAtPath(const EXMLParser& parser, const ItemPath& path) {
+    const ItemRef item = parser.getItem(path.location);
+    return item && path.child >= 0 ? item.child(static_cast<size_t>(path.child)) : item;
+}
+
+void appendPath(const ItemPath& path, std::string& out) {
+    out += sectionTag(path.location.area);
+    out += '[';
+    out += std::to_string(path.location.page);
+    out += ':';
+    out += std::to_string(path.location.index);
+    if (path.child >= 0) {
+        out += '/';
+        out += std::to_string(path.child);
+    }
+    out += ']';
+}
+
+void appendName(const ItemRef& item, std::string& out) {
+    if (!item) return;
+    out += ' ';
+    if (!item.packageName().empty()) {
+        out += item.packageName();
+        if (!item.className().empty()) {
+            out += '/';
+            out += item.className();
+        }
+    } else {
+        out += '"';
+        out += item.title();
+        out += '"';
+    }
+}
+
+void appendAttributes(unsigned int changed, std::string& out) {
+    const char* separator = " {";
+    for (const auto& desc : detail::kItemAttributes) {
+        if (!(changed & desc.bit)) continue;
+        out += separator;
+        out.append(desc.name.data(), desc.name.size());
+        separator = ",";
+    }
+    if (changed) out += '}';
+}
+
+} // namespace
+
+LayoutDiff diff(const EXMLParser& a, const EXMLParser& b) {
+    const LayoutModel& before = layoutOf(a);
+    const LayoutModel& after = layoutOf(b);
+    LayoutDiff result;
+
+    diffArea(before, after, LayoutArea::HOME, before.homeItems, after.homeItems, result.items);
+    diffArea(before, after, LayoutArea::HOTSEAT, before.hotseatItems, after.hotseatItems, result.items);
+    diffArea(before, after, LayoutArea::HOME_ONLY, before.homeOnlyItems, after.homeOnlyItems, result.items);
+    diffArea(before, after, LayoutArea::HOTSEAT_HOME_ONLY, before.hotseatHomeOnlyItems, after.hotseatHomeOnlyItems,
+             result.items);
+    diffArea(before, after, LayoutArea::APP_ORDER, before.appOrderItems, after.appOrderItems, result.items);
+
+    for (int field = 0; field < configFieldCount(); ++field) {
+        if (configFieldEquals(before.layoutConfig, after.layoutConfig, field)) continue;
+        ConfigEdit edit;
+        edit.tag = configFieldTag(field);
+        appendConfigValue(before.layoutConfig, field, edit.oldValue);
+        appendConfigValue(after.layoutConfig, field, edit.newValue);
+        result.config.push_back(std::move(edit));
+    }
+    return result;
+}
+
+std::string formatDiff(const LayoutDiff& changes, const EXMLParser& a, const EXMLParser& b) {
+    std::string out;
+    for (const auto& edit : changes.config) {
+        out += "~ ";
+        out += edit.tag;
+        out += ": ";
+        out += edit.oldValue;
+        out += " -> ";
+        out += edit.newValue;
+        out += '\n';
+    }
+    for (const auto& edit : changes.items) {
+        switch (edit.kind) {
+            case EditKind::ADDED:
+                out += "+ ";
+                appendPath(edit.to, out);
+                appendName(itemAtPath(b, edit.to), out);
+                break;
+            case EditKind::REMOVED:
+                out += "- ";
+                appendPath(edit.from, out);
+                appendName(itemAtPath(a, edit.from), out);
+                break;
+            case EditKind::MOVED:
+                out += "> ";
+                appendPath(edit.from, out);
+                out += " -> ";
+                appendPath(edit.to, out);
+                appendName(itemAtPath(b, edit.to), out);
+                appendAttributes(edit.changedAttributes, out);
+                break;
+            case EditKind::MODIFIED:
+                out += "* ";
+                appendPath(edit.to, out);
+                appendName(itemAtPath(b, edit.to), out);
+                appendAttributes(edit.changedAttributes, out);
+                break;
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+} // namespace exml
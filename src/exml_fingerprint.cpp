@@ -0,0 +1,178 @@
+#include "exml_fingerprint.h"
+#include "exml_internal.h"
+#include "exml_schema.h"
+#include <cstring>
+
+namespace exml {
+
+namespace {
+
+constexpr uint64_t kMulA = 0x9E3779B97F4A7C15ull;
+constexpr uint64_t kMulB = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kMulC = 0x165667B19E3779F9ull;
+
+uint64_t rotate(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// splitmix64的终结函数，使每个输入位影响全部输出位
+uint64_t avalanche(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+Fingerprint plus(const Fingerprint& a, const Fingerprint& b) {
+    return Fingerprint(a.low + b.low, a.high + b.high);
+}
+
+Fingerprint minus(const Fingerprint& a, const Fingerprint& b) {
+    return Fingerprint(a.low - b.low, a.high - b.high);
+}
+
+// 区域指纹中一个页面的贡献，空页面不计入
+Fingerprint pageContribution(int page, const Fingerprint& fingerprint) {
+    if (fingerprint == Fingerprint()) return Fingerprint();
+    FingerprintHasher hasher;
+    hasher.add(static_cast<uint64_t>(static_cast<int64_t>(page)));
+    hasher.add(fingerprint);
+    return hasher.finish();
+}
+
+} // namespace
+
+FingerprintHasher::FingerprintHasher() : a_(0x243F6A8885A308D3ull), b_(0x13198A2E03707344ull), count_(0) {}
+
+void FingerprintHasher::add(uint64_t value) {
+    a_ = rotate(a_ ^ (value * kMulA), 29) * kMulB;
+    b_ = rotate(b_ + (value * kMulC), 31) * kMulA ^ a_;
+    ++count_;
+}
+
+void FingerprintHasher::add(std::string_view text) {
+    add(static_cast<uint64_t>(text.size()));
+    size_t at = 0;
+    for (; at + 8 <= text.size(); at += 8) {
+        uint64_t word;
+        std::memcpy(&word, text.data() + at, 8);
+        add(word);
+    }
+    if (at < text.size()) {
+        uint64_t word = 0;
+        std::memcpy(&word, text.data() + at, text.size() - at);
+        add(word);
+    }
+}
+
+void FingerprintHasher::add(const Fingerprint& fingerprint) {
+    add(fingerprint.low);
+    add(fingerprint.high);
+}
+
+Fingerprint FingerprintHasher::finish() const {
+    return Fingerprint(avalanche(a_ ^ count_), avalanche(b_ + rotate(a_, 17)));
+}
+
+Fingerprint itemFingerprint(const ItemRecord& item, const StringPool& pool) {
+    FingerprintHasher hasher;
+    hasher.add(static_cast<uint64_t>(item.type));
+    for (const auto& desc : detail::kItemAttributes) {
+        switch (desc.type) {
+            case detail::AttributeType::STRING: hasher.add(pool.lookup(item.*desc.idMember)); break;
+            case detail::AttributeType::INT:
+                hasher.add(static_cast<uint64_t>(static_cast<int64_t>(item.*desc.recordIntMember)));
+                break;
+            case detail::AttributeType::BOOL: hasher.add(static_cast<uint64_t>(item.*desc.recordBoolMember)); break;
+        }
+    }
+    hasher.add(static_cast<uint64_t>(item.favorites.size()));
+    for (const auto& child : item.favorites) {
+        hasher.add(itemFingerprint(child, pool));
+    }
+    return hasher.finish();
+}
+
+Fingerprint configFingerprint(const LayoutConfig& config) {
+    FingerprintHasher hasher;
+    std::string value;
+    for (int field = 0; field < configFieldCount(); ++field) {
+        value.clear();
+        appendConfigValue(config, field, value);
+        hasher.add(value);
+    }
+    return hasher.finish();
+}
+
+AreaFingerprint::AreaFingerprint(bool ordered) : ordered_(ordered), built_(false) {}
+
+void AreaFingerprint::invalidate() {
+    pages_.clear();
+    area_ = Fingerprint();
+    built_ = false;
+}
+
+size_t AreaFingerprint::memoryUsage() const {
+    return hashMapMemory(pages_);
+}
+
+void AreaFingerprint::build(const PagedItems& pages, const StringPool& pool) {
+    invalidate();
+    for (const auto& page : pages) {
+        for (const auto& item : page.second) {
+            update(page.first, itemFingerprint(item, pool), true);
+        }
+    }
+    built_ = true;
+}
+
+void AreaFingerprint::build(const ItemList& items, const StringPool& pool) {
+    invalidate();
+    if (ordered_) {
+        FingerprintHasher hasher;
+        hasher.add(static_cast<uint64_t>(items.size()));
+        for (const auto& item : items) {
+            hasher.add(itemFingerprint(item, pool));
+        }
+        area_ = hasher.finish();
+        pages_[0] = area_;
+    } else {
+        for (const auto& item : items) {
+            update(0, itemFingerprint(item, pool), true);
+        }
+    }
+    built_ = true;
+}
+
+Fingerprint AreaFingerprint::page(int page) const {
+    auto it = pages_.find(page);
+    return it != pages_.end() ? it->second : Fingerprint();
+}
+
+void AreaFingerprint::inserted(const ItemList& items, int page, size_t index, const StringPool& pool) {
+    if (!built_) return;
+    if (ordered_) {
+        invalidate();
+        return;
+    }
+    update(page, itemFingerprint(items[index], pool), true);
+}
+
+void AreaFingerprint::erasing(const ItemList& items, int page, size_t index, const StringPool& pool) {
+    if (!built_) return;
+    if (ordered_) {
+        invalidate();
+        return;
+    }
+    update(page, itemFingerprint(items[index], pool), false);
+}
+
+void AreaFingerprint::update(int page, const Fingerprint& item, bool adding) {
+    Fingerprint& fingerprint = pages_[page];
+    area_ = minus(area_, pageContribution(page, fingerprint));
+    fingerprint = adding ? plus(fingerprint, item) : minus(fingerprint, item);
+    area_ = plus(area_, pageContribution(page, fingerprint));
+}
+
+} // namespace exml
@@ -0,0 +1,98 @@
+#ifndef EXML_FINGERPRINT_H
+#define EXML_FINGERPRINT_H
+
+#include "exml_model.h"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace exml {
+
+/**
+ * @brief 两条64位通道的非加密流式哈希
+ *
+ * 字符串带长度前缀写入，相邻字段不会拼接出相同的字节序列。
+ */
+class FingerprintHasher {
+public:
+    FingerprintHasher();
+
+    void add(uint64_t value);
+    void add(std::string_view text);
+    void add(const Fingerprint& fingerprint);
+
+    Fingerprint finish() const;
+
+private:
+    uint64_t a_;
+    uint64_t b_;
+    uint64_t count_;
+};
+
+/**
+ * @brief 以指纹为键的哈希容器使用（指纹各位已充分混合，直接取low）
+ */
+struct FingerprintHash {
+    size_t operator()(const Fingerprint& fingerprint) const { return static_cast<size_t>(fingerprint.low); }
+};
+
+/**
+ * @brief 项目的规范指纹：类型与属性表中的全部属性（按表的顺序），文件夹再按顺序加入其中的项目
+ *
+ * 字符串按内容（经pool读取）计算，与所用的字符串池无关。
+ */
+Fingerprint itemFingerprint(const ItemRecord& item, const StringPool& pool);
+
+/**
+ * @brief 配置的规范指纹：按配置字段表的顺序加入每个字段的值
+ */
+Fingerprint configFingerprint(const LayoutConfig& config);
+
+/**
+ * @brief 单个区域的指纹
+ *
+ * 无序区域（Home、HomeOnly的页面，位置由screen、x、y表示）的页面指纹为项目指纹按通道求和，
+ * 区域指纹为各非空页面的 (页码, 页面指纹) 之和，增删项目时常数时间更新。
+ * 有序区域（两个快捷栏与AppOrder，保存时按列表顺序输出）按顺序计算，修改时标记失效，下次查询时重算。
+ * 与ItemIndex相同：首次查询时建立，未建立时维护操作直接跳过。
+ */
+class AreaFingerprint {
+public:
+    explicit AreaFingerprint(bool ordered);
+
+    bool built() const { return built_; }
+    void invalidate();
+
+    /**
+     * @brief 按页指纹占用内存的估算，单位字节
+     */
+    size_t memoryUsage() const;
+
+    void build(const PagedItems& pages, const StringPool& pool);
+    void build(const ItemList& items, const StringPool& pool);
+
+    Fingerprint area() const { return area_; }
+    Fingerprint page(int page) const;
+
+    /**
+     * @brief items[index]已插入到page后调用
+     */
+    void inserted(const ItemList& items, int page, size_t index, const StringPool& pool);
+
+    /**
+     * @brief items[index]将从page中删除前调用
+     */
+    void erasing(const ItemList& items, int page, size_t index, const StringPool& pool);
+
+private:
+    void update(int page, const Fingerprint& item, bool adding);
+
+    std::unordered_map<int, Fingerprint> pages_;
+    Fingerprint area_;
+    bool ordered_;
+    bool built_;
+};
+
+} // namespace exml
+
+#endif // EXML_FINGERPRINT_H
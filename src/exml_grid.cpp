@@ -0,0 +1,222 @@
+#include "exml_grid.h"
+#include "exml_internal.h"
+#include <algorithm>
+
+namespace exml {
+
+namespace {
+
+// 从第x列开始、宽spanX列的掩码（调用方保证 0 <= x, x + spanX <= 64）
+uint64_t spanMask(int x, int spanX) {
+    const uint64_t bits = spanX >= OccupancyGrid::kMaxColumns ? ~uint64_t(0) : (uint64_t(1) << spanX) - 1;
+    return bits << x;
+}
+
+int lowestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int bit = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+int bitCount(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    int count = 0;
+    for (; value; value &= value - 1) ++count;
+    return count;
+#endif
+}
+
+} // namespace
+
+OccupancyGrid::OccupancyGrid() : rows_(0), columns_(0), built_(false) {}
+
+void OccupancyGrid::invalidate() {
+    pages_.clear();
+    built_ = false;
+}
+
+size_t OccupancyGrid::memoryUsage() const {
+    size_t bytes = hashMapMemory(pages_);
+    for (const auto& page : pages_) {
+        bytes += page.second.rowMasks.capacity() * sizeof(uint64_t) + page.second.cells.capacity() * sizeof(int32_t);
+    }
+    return bytes;
+}
+
+void OccupancyGrid::build(const PagedItems& pages, int rows, int columns) {
+    pages_.clear();
+    rows_ = std::max(rows, 0);
+    columns_ = std::min(std::max(columns, 0), kMaxColumns);
+    for (const auto& page : pages) {
+        rebuild(pageAt(page.first), page.second, page.second.size());
+    }
+    built_ = true;
+}
+
+bool OccupancyGrid::isCellFree(int page, int x, int y) const {
+    return inGrid(x, y) && (rowMask(page, y) >> x & 1) == 0;
+}
+
+bool OccupancyGrid::isFree(int page, int x, int y, int spanX, int spanY) const {
+    if (x < 0 || y < 0 || spanX < 1 || spanY < 1 || spanX > columns_ - x || spanY > rows_ - y) return false;
+    const Page* grid = findPage(page);
+    if (!grid) return true;
+    const uint64_t mask = spanMask(x, spanX);
+    for (int row = y; row < y + spanY; ++row) {
+        if (grid->rowMasks[row] & mask) return false;
+    }
+    return true;
+}
+
+int OccupancyGrid::occupant(int page, int x, int y) const {
+    const Page* grid = inGrid(x, y) ? findPage(page) : nullptr;
+    return grid ? grid->cells[y * columns_ + x] : -1;
+}
+
+uint64_t OccupancyGrid::rowMask(int page, int y) const {
+    const Page* grid = y >= 0 && y < rows_ ? findPage(page) : nullptr;
+    return grid ? grid->rowMasks[y] : 0;
+}
+
+uint64_t OccupancyGrid::fitMask(int page, int y, int spanX, int spanY) const {
+    if (y < 0 || spanX < 1 || spanY < 1 || spanX > columns_ || spanY > rows_ - y) return 0;
+    const uint64_t full = spanMask(0, columns_);
+    uint64_t fit = full;
+    for (int row = y; row < y + spanY && fit; ++row) {
+        // 空闲段：第x位为1表示第x..x+spanX-1列都空闲（高位移入的0排除了越界位置）
+        const uint64_t free = ~rowMask(page, row) & full;
+        uint64_t run = free;
+        for (int shift = 1; shift < spanX && run; ++shift) run &= free >> shift;
+        fit &= run;
+    }
+    return fit;
+}
+
+bool OccupancyGrid::findFirstFit(int page, int spanX, int spanY, int& x, int& y) const {
+    for (int row = 0; row + spanY <= rows_; ++row) {
+        const uint64_t fit = fitMask(page, row, spanX, spanY);
+        if (fit) {
+            x = lowestBit(fit);
+            y = row;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool OccupancyGrid::findBestFit(int page, int spanX, int spanY, int& x, int& y, int& score) const {
+    bool found = false;
+    for (int row = 0; row + spanY <= rows_; ++row) {
+        for (uint64_t fit = fitMask(page, row, spanX, spanY); fit; fit &= fit - 1) {
+            const int column = lowestBit(fit);
+            const int candidate = contactScore(page, column, row, spanX, spanY);
+            if (!found || candidate > score) {
+                found = true;
+                x = column;
+                y = row;
+                score = candidate;
+            }
+        }
+    }
+    return found;
+}
+
+int OccupancyGrid::contactScore(int page, int x, int y, int spanX, int spanY) const {
+    // 上下两行按位计数，左右两列逐行检查；网格边界按已占用计
+    const uint64_t span = spanMask(x, spanX);
+    int score = y == 0 ? spanX : bitCount(rowMask(page, y - 1) & span);
+    score += y + spanY == rows_ ? spanX : bitCount(rowMask(page, y + spanY) & span);
+    for (int row = y; row < y + spanY; ++row) {
+        const uint64_t mask = rowMask(page, row);
+        score += x == 0 || (mask >> (x - 1) & 1) ? 1 : 0;
+        score += x + spanX == columns_ || (mask >> (x + spanX) & 1) ? 1 : 0;
+    }
+    return score;
+}
+
+void OccupancyGrid::inserted(const ItemList& items, int page, size_t index) {
+    if (!built_) return;
+    Page& grid = pageAt(page);
+    const int32_t at = static_cast<int32_t>(index);
+    for (auto& cell : grid.cells) {
+        if (cell >= at) ++cell;
+    }
+    mark(grid, items[index], at);
+    if (grid.overlapping && index + 1 < items.size()) {
+        // 插在中间且与后面的项目重叠时，占用者应为页内靠前的项目，整页重建
+        rebuild(grid, items, items.size());
+    }
+}
+
+void OccupancyGrid::erasing(const ItemList& items, int page, size_t index) {
+    if (!built_) return;
+    Page& grid = pageAt(page);
+    if (grid.overlapping) {
+        // 被删项目下面可能压着其他项目，整页重建
+        rebuild(grid, items, index);
+        return;
+    }
+    const int32_t at = static_cast<int32_t>(index);
+    for (size_t cell = 0; cell < grid.cells.size(); ++cell) {
+        if (grid.cells[cell] == at) {
+            grid.cells[cell] = -1;
+            grid.rowMasks[cell / columns_] &= ~(uint64_t(1) << (cell % columns_));
+        } else if (grid.cells[cell] > at) {
+            --grid.cells[cell];
+        }
+    }
+}
+
+OccupancyGrid::Page& OccupancyGrid::pageAt(int page) {
+    Page& grid = pages_[page];
+    if (grid.rowMasks.empty() && rows_ > 0) {
+        grid.rowMasks.assign(rows_, 0);
+        grid.cells.assign(static_cast<size_t>(rows_) * columns_, -1);
+    }
+    return grid;
+}
+
+const OccupancyGrid::Page* OccupancyGrid::findPage(int page) const {
+    auto it = pages_.find(page);
+    return it != pages_.end() && !it->second.rowMasks.empty() ? &it->second : nullptr;
+}
+
+void OccupancyGrid::mark(Page& page, const ItemRecord& item, int32_t index) {
+    // 超出网格的部分不记录
+    const int left = std::max(item.x, 0);
+    const int top = std::max(item.y, 0);
+    const int right = std::min(item.x + std::max(item.spanX, 1), columns_);
+    const int bottom = std::min(item.y + std::max(item.spanY, 1), rows_);
+    for (int y = top; y < bottom; ++y) {
+        for (int x = left; x < right; ++x) {
+            int32_t& cell = page.cells[y * columns_ + x];
+            if (cell >= 0) {
+                page.overlapping = true;   // 保留先出现的占用者
+                continue;
+            }
+            cell = index;
+            page.rowMasks[y] |= uint64_t(1) << x;
+        }
+    }
+}
+
+void OccupancyGrid::rebuild(Page& page, const ItemList& items, size_t skip) {
+    std::fill(page.rowMasks.begin(), page.rowMasks.end(), 0);
+    std::fill(page.cells.begin(), page.cells.end(), -1);
+    page.overlapping = false;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i == skip) continue;
+        mark(page, items[i], static_cast<int32_t>(i > skip ? i - 1 : i));
+    }
+}
+
+} // namespace exml
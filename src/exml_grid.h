@@ -0,0 +1,105 @@
+#ifndef EXML_GRID_H
+#define EXML_GRID_H
+
+#include "exml_model.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace exml {
+
+/**
+ * @brief 按页的网格占用表（Home、HomeOnly区域）
+ *
+ * 每页保存每行一个位掩码和每个单元格的占用者序号（页内index，-1为空闲；
+ * 多个项目重叠时为页内最靠前的项目），
+ * 单元格查询为常数时间，矩形查询每行一次掩码与运算。超出网格的部分不记录。
+ * 与ItemIndex相同：首次查询时建立，之后随增删移动增量维护；未建立时维护操作直接跳过。
+ */
+class OccupancyGrid {
+public:
+    static constexpr int kMaxColumns = 64;   // 行掩码的位数
+
+    OccupancyGrid();
+
+    bool built() const { return built_; }
+    void invalidate();
+
+    /**
+     * @brief 占用表占用内存的估算，单位字节
+     */
+    size_t memoryUsage() const;
+
+    void build(const PagedItems& pages, int rows, int columns);
+
+    int rows() const { return rows_; }
+    int columns() const { return columns_; }
+
+    bool isCellFree(int page, int x, int y) const;
+
+    /**
+     * @brief 矩形是否完全在网格内且没有被占用的单元格
+     */
+    bool isFree(int page, int x, int y, int spanX, int spanY) const;
+
+    /**
+     * @brief 返回占用单元格的项目序号，空闲或超出网格时返回-1
+     */
+    int occupant(int page, int x, int y) const;
+
+    /**
+     * @brief 返回页面第y行的占用掩码（第x位对应第x列），空页返回0
+     */
+    uint64_t rowMask(int page, int y) const;
+
+    /**
+     * @brief 返回以第y行为上边、能放下spanX×spanY的所有列位置（第x位表示左上角可在第x列）
+     *
+     * 每行先用移位与运算求出长度为spanX的空闲段，再把spanY行的结果相与。
+     */
+    uint64_t fitMask(int page, int y, int spanX, int spanY) const;
+
+    /**
+     * @brief 按行优先顺序查找第一个能放下spanX×spanY的位置
+     */
+    bool findFirstFit(int page, int spanX, int spanY, int& x, int& y) const;
+
+    /**
+     * @brief 查找与已占用单元格及网格边界接触最多的位置（最贴合），同分时取行优先靠前者
+     * @param score 返回接触的单元格边数
+     */
+    bool findBestFit(int page, int spanX, int spanY, int& x, int& y, int& score) const;
+
+    /**
+     * @brief items[index]已插入到page后调用
+     */
+    void inserted(const ItemList& items, int page, size_t index);
+
+    /**
+     * @brief items[index]将从page中删除前调用
+     */
+    void erasing(const ItemList& items, int page, size_t index);
+
+private:
+    struct Page {
+        std::vector<uint64_t> rowMasks;
+        std::vector<int32_t> cells;
+        bool overlapping = false;   // 存在重叠项目时，删除需重建该页
+    };
+
+    Page& pageAt(int page);
+    const Page* findPage(int page) const;
+    void mark(Page& page, const ItemRecord& item, int32_t index);
+    void rebuild(Page& page, const ItemList& items, size_t skip);
+    bool inGrid(int x, int y) const { return x >= 0 && y >= 0 && x < columns_ && y < rows_; }
+    int contactScore(int page, int x, int y, int spanX, int spanY) const;
+
+    std::unordered_map<int, Page> pages_;
+    int rows_;
+    int columns_;
+    bool built_;
+};
+
+} // namespace exml
+
+#endif // EXML_GRID_H
@@ -0,0 +1,93 @@
+#include "exml_index.h"
+#include "exml_internal.h"
+#include <algorithm>
+
+namespace exml {
+
+namespace {
+
+bool positionLess(const ItemLocation& a, const ItemLocation& b) {
+    return a.page != b.page ? a.page < b.page : a.index < b.index;
+}
+
+} // namespace
+
+ItemIndex::ItemIndex(LayoutArea area) : area_(area), built_(false) {}
+
+void ItemIndex::invalidate() {
+    byPackage_.clear();
+    built_ = false;
+}
+
+size_t ItemIndex::memoryUsage() const {
+    size_t bytes = hashMapMemory(byPackage_);
+    for (const auto& entry : byPackage_) bytes += entry.second.capacity() * sizeof(ItemLocation);
+    return bytes;
+}
+
+void ItemIndex::build(const PagedItems& pages) {
+    byPackage_.clear();
+    for (const auto& page : pages) {
+        for (size_t i = 0; i < page.second.size(); ++i) {
+            add(page.second[i].packageId, page.first, i);
+        }
+    }
+    built_ = true;
+}
+
+void ItemIndex::build(const ItemList& items) {
+    byPackage_.clear();
+    for (size_t i = 0; i < items.size(); ++i) {
+        add(items[i].packageId, 0, i);
+    }
+    built_ = true;
+}
+
+const std::vector<ItemLocation>* ItemIndex::find(uint32_t packageId) const {
+    auto it = byPackage_.find(packageId);
+    return it != byPackage_.end() ? &it->second : nullptr;
+}
+
+void ItemIndex::inserted(const ItemList& items, int page, size_t index) {
+    if (!built_) return;
+    // 从后往前移动，避免与尚未移动的位置重合
+    for (size_t i = items.size() - 1; i > index; --i) {
+        shift(items[i].packageId, page, i - 1, i);
+    }
+    add(items[index].packageId, page, index);
+}
+
+void ItemIndex::erasing(const ItemList& items, int page, size_t index) {
+    if (!built_) return;
+    auto it = byPackage_.find(items[index].packageId);
+    if (it != byPackage_.end()) {
+        auto& positions = it->second;
+        positions.erase(std::remove_if(positions.begin(), positions.end(),
+            [&](const ItemLocation& position) {
+                return position.page == page && position.index == index;
+            }), positions.end());
+        if (positions.empty()) byPackage_.erase(it);
+    }
+    for (size_t i = index + 1; i < items.size(); ++i) {
+        shift(items[i].packageId, page, i, i - 1);
+    }
+}
+
+void ItemIndex::add(uint32_t packageId, int page, size_t index) {
+    auto& positions = byPackage_[packageId];
+    const ItemLocation position{area_, page, index};
+    positions.insert(std::upper_bound(positions.begin(), positions.end(), position, positionLess), position);
+}
+
+void ItemIndex::shift(uint32_t packageId, int page, size_t from, size_t to) {
+    auto it = byPackage_.find(packageId);
+    if (it == byPackage_.end()) return;
+    for (auto& position : it->second) {
+        if (position.page == page && position.index == from) {
+            position.index = to;
+            return;
+        }
+    }
+}
+
+} // namespace exml
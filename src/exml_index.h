@@ -0,0 +1,58 @@
+#ifndef EXML_INDEX_H
+#define EXML_INDEX_H
+
+#include "exml_model.h"
+#include <unordered_map>
+#include <vector>
+
+namespace exml {
+
+/**
+ * @brief 单个区域的包名索引
+ *
+ * 包名ID（ItemRecord::packageId）-> 位置列表（按page、index升序），package+class
+ * 查找在同包名的少量位置中比较classId。索引在首次查找时建立，之后随
+ * 增删移动增量维护；未建立时维护操作直接跳过。
+ */
+class ItemIndex {
+public:
+    explicit ItemIndex(LayoutArea area);
+
+    bool built() const { return built_; }
+    void invalidate();
+
+    /**
+     * @brief 索引占用内存的估算，单位字节
+     */
+    size_t memoryUsage() const;
+
+    void build(const PagedItems& pages);
+    void build(const ItemList& items);
+
+    /**
+     * @brief 返回包名对应的位置列表，不存在时返回nullptr
+     */
+    const std::vector<ItemLocation>* find(uint32_t packageId) const;
+
+    /**
+     * @brief items[index]已插入到page后调用，后续项目的位置依次后移
+     */
+    void inserted(const ItemList& items, int page, size_t index);
+
+    /**
+     * @brief items[index]将从page中删除前调用，后续项目的位置依次前移
+     */
+    void erasing(const ItemList& items, int page, size_t index);
+
+private:
+    void add(uint32_t packageId, int page, size_t index);
+    void shift(uint32_t packageId, int page, size_t from, size_t to);
+
+    std::unordered_map<uint32_t, std::vector<ItemLocation>> byPackage_;
+    LayoutArea area_;
+    bool built_;
+};
+
+} // namespace exml
+
+#endif // EXML_INDEX_H
@@ -0,0 +1,155 @@
+#ifndef EXML_INTERNAL_H
+#define EXML_INTERNAL_H
+
+#include "exml_parser.h"
+#include <string>
+#include <string_view>
+
+// 以-fno-exceptions编译（EXML_NO_EXCEPTIONS选项）时不能使用try/catch
+#if defined(__cpp_exceptions) || defined(_CPPUNWIND)
+    #define EXML_HAS_EXCEPTIONS 1
+#else
+    #define EXML_HAS_EXCEPTIONS 0
+#endif
+
+namespace exml {
+
+// 库内部共享的辅助函数（不对外导出）
+
+/**
+ * @brief 根据元素名确定项目类型，未知元素按应用图标处理
+ */
+ItemType itemTypeFromTag(std::string_view tag);
+
+/**
+ * @brief 将配置元素的文本写入LayoutConfig
+ * @return 元素是否为已知的配置项
+ */
+bool applyConfigValue(LayoutConfig& config, std::string_view tag, const std::string& text);
+
+/**
+ * @brief 解码整数文本（允许首尾空白和正负号），不抛出异常
+ * @return 是否为完整且不溢出的整数；失败时value保持不变
+ */
+bool decodeInt(std::string_view text, int& value);
+
+/**
+ * @brief 解码布尔文本（true/false/1/0）
+ * @return 是否为可识别的布尔值；失败时value保持不变
+ */
+bool decodeBool(std::string_view text, bool& value);
+
+/**
+ * @brief 解析器的数据模型，供diff等跨解析器的算法直接读取
+ */
+const LayoutModel& layoutOf(const EXMLParser& parser);
+
+/**
+ * @brief 预先建立解析器中按需建立的全部状态，之后多个线程可同时调用其const方法
+ */
+void prepareForSharing(EXMLParser& parser);
+
+/**
+ * @brief 解析推迟的区域后返回可直接修改的模型；修改区域后必须调用areaEdited()
+ */
+LayoutModel& editableModel(EXMLParser& parser, LayoutArea area);
+
+/**
+ * @brief 把from的整个布局复制到to（含文档骨架、区域原文与修改状态），项目的字符串驻留到to的池
+ */
+void copyLayout(const EXMLParser& from, EXMLParser& to);
+
+/**
+ * @brief 区域的容器被直接替换后调用：使索引、占用表与指纹失效，并把区域标记为已修改
+ */
+void areaEdited(EXMLParser& parser, LayoutArea area);
+
+/**
+ * @brief 通过公共接口把项目添加到解析器的区域中（单列表区域忽略page）
+ */
+void addItemToArea(EXMLParser& parser, LayoutArea area, int page, const Item& item);
+
+/**
+ * @brief 字符串在对象之外占用的堆内存（短字符串优化范围内为0）
+ */
+inline size_t stringMemory(const std::string& value) {
+    return value.capacity() > std::string().capacity() ? value.capacity() + 1 : 0;
+}
+
+/**
+ * @brief 哈希表的桶与节点占用的内存估算，不含元素自身在节点之外的堆内存
+ */
+template <typename Map>
+size_t hashMapMemory(const Map& map) {
+    return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*));
+}
+
+/**
+ * @brief 解析器中按需建立的包名索引、占用表与指纹占用的内存估算（未建立的不计）
+ */
+size_t lazyStateMemory(const EXMLParser& parser);
+
+/**
+ * @brief 将整个文件读入buffer（覆盖原有内容，复用其容量）
+ */
+bool readFileContents(const std::string& filePath, std::string& buffer);
+
+/**
+ * @brief 将data一次性写入文件，失败时输出错误信息
+ */
+bool writeFileContents(const std::string& filePath, const std::string& data);
+
+// ===== 区域表与配置字段表（exml_config.cpp） =====
+
+/**
+ * @brief 根据元素名查找区域
+ * @return 元素是否为区域元素
+ */
+bool findSectionArea(std::string_view tag, LayoutArea& area);
+
+/**
+ * @brief 区域对应的元素名
+ */
+const char* sectionTag(LayoutArea area);
+
+int configFieldCount();
+
+/**
+ * @brief 根据元素名查找配置字段序号，未知返回-1
+ */
+int findConfigField(std::string_view tag);
+
+const char* configFieldTag(int field);
+
+/**
+ * @brief 按字段类型解码文本并写入LayoutConfig，空文本保留默认值
+ * @return 文本能否按字段类型解码；失败时字段保留默认值
+ */
+bool applyConfigField(LayoutConfig& config, int field, const std::string& text);
+
+bool configFieldEquals(const LayoutConfig& a, const LayoutConfig& b, int field);
+
+/**
+ * @brief 将from的配置字段复制到to
+ */
+void copyConfigField(const LayoutConfig& from, LayoutConfig& to, int field);
+
+/**
+ * @brief 输出配置字段的值（字符串不转义）
+ */
+void appendConfigValue(const LayoutConfig& config, int field, std::string& out);
+
+/**
+ * @brief 以 <tag>value</tag> 形式输出配置字段
+ */
+void appendConfigElement(const LayoutConfig& config, int field, std::string& out);
+
+// ===== 转义输出（exml_writer.cpp） =====
+
+void appendEscapedText(std::string_view text, std::string& out);
+
+void appendEscapedAttribute(std::string_view value, std::string& out);
+
+} // namespace exml
+
+#endif // EXML_INTERNAL_H
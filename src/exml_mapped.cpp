@@ -0,0 +1,331 @@
+#include "exml_mapped.h"
+#include "exml_internal.h"
+#include "exml_schema.h"
+#include "exml_walker.h"
+#include <algorithm>
+#include <deque>
+#include <iostream>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace exml {
+
+namespace {
+
+// 按屏幕分组后的页面区间
+struct PageRange {
+    int screen;
+    uint32_t begin;
+    uint32_t count;
+};
+
+ItemView defaultItemView() {
+    ItemView view;
+    view.type = ItemType::FAVORITE;
+    view.screen = 0;
+    view.x = 0;
+    view.y = 0;
+    view.spanX = 1;
+    view.spanY = 1;
+    view.appWidgetID = 0;
+    view.options = 0;
+    view.color = -1;
+    view.hidden = false;
+    view.firstChild = 0;
+    view.childCount = 0;
+    return view;
+}
+
+} // namespace
+
+// 实现类
+class MappedLayoutImpl {
+public:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool opened = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    LayoutConfig layoutConfig;
+    std::vector<ItemView> homeItems;
+    std::vector<ItemView> hotseatItems;
+    std::vector<ItemView> homeOnlyItems;
+    std::vector<ItemView> hotseatHomeOnlyItems;
+    std::vector<ItemView> appOrderItems;
+    std::vector<ItemView> children;            // 所有文件夹内的应用，按文件夹连续存放
+    std::vector<PageRange> homePages;
+    std::vector<PageRange> homeOnlyPages;
+    std::deque<std::string> decodedValues;     // 含实体的属性值需要解码，单独保存
+
+    ~MappedLayoutImpl() { unmap(); }
+
+    bool map(const std::string& filePath) {
+#ifdef _WIN32
+        file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) return false;
+        size = static_cast<size_t>(fileSize.QuadPart);
+        if (size == 0) return true;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        return data != nullptr;
+#else
+        int fd = ::open(filePath.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size = static_cast<size_t>(st.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            size = 0;
+            return false;
+        }
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(addr);
+        return true;
+#endif
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) ::munmap(const_cast<char*>(data), size);
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    void resetContent() {
+        layoutConfig = LayoutConfig();
+        homeItems.clear();
+        hotseatItems.clear();
+        homeOnlyItems.clear();
+        hotseatHomeOnlyItems.clear();
+        appOrderItems.clear();
+        children.clear();
+        homePages.clear();
+        homeOnlyPages.clear();
+        decodedValues.clear();
+    }
+
+    std::string_view stringValue(const detail::XmlAttribute& attr) {
+        if (!attr.hasEntity) return attr.value;
+        decodedValues.emplace_back();
+        detail::appendDecoded(attr.value, decodedValues.back());
+        return decodedValues.back();
+    }
+
+    // ItemView的成员与Item不同，按属性表查到的位分派
+    void assignAttribute(ItemView& view, const detail::XmlAttribute& attr) {
+        const detail::AttributeDesc* desc = detail::findItemAttribute(attr.name);
+        if (!desc) return;
+        switch (desc->bit) {
+            case ATTR_PACKAGE_NAME: view.packageName = stringValue(attr); break;
+            case ATTR_CLASS_NAME: view.className = stringValue(attr); break;
+            case ATTR_TITLE: view.title = stringValue(attr); break;
+            case ATTR_SCREEN: decodeInt(attr.value, view.screen); break;
+            case ATTR_X: decodeInt(attr.value, view.x); break;
+            case ATTR_Y: decodeInt(attr.value, view.y); break;
+            case ATTR_SPAN_X: decodeInt(attr.value, view.spanX); break;
+            case ATTR_SPAN_Y: decodeInt(attr.value, view.spanY); break;
+            case ATTR_APP_WIDGET_ID: decodeInt(attr.value, view.appWidgetID); break;
+            case ATTR_OPTIONS: decodeInt(attr.value, view.options); break;
+            case ATTR_COLOR: decodeInt(attr.value, view.color); break;
+            case ATTR_HIDDEN: decodeBool(attr.value, view.hidden); break;
+        }
+    }
+
+    bool readItem(detail::XmlReader& reader, const detail::XmlToken& start, ItemView& view) {
+        view = defaultItemView();
+        view.type = itemTypeFromTag(start.name);
+        for (const auto& attr : reader.attributes()) {
+            assignAttribute(view, attr);
+        }
+        if (start.selfClosing) return true;
+        if (view.type != ItemType::FOLDER) return detail::skipElement(reader);
+
+        view.firstChild = static_cast<uint32_t>(children.size());
+        detail::XmlToken token;
+        while (reader.next(token)) {
+            if (token.type == detail::XmlTokenType::EndElement) {
+                view.childCount = static_cast<uint32_t>(children.size()) - view.firstChild;
+                return token.name == start.name;
+            }
+            if (token.type != detail::XmlTokenType::StartElement) continue;
+            if (token.name == "favorite") {
+                ItemView child;
+                if (!readItem(reader, token, child)) return false;
+                children.push_back(child);
+            } else if (!token.selfClosing && !detail::skipElement(reader)) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // walkDocument回调
+    bool isSection(std::string_view tag) const {
+        LayoutArea area;
+        return findSectionArea(tag, area);
+    }
+
+    std::vector<ItemView>& sectionItems(LayoutArea area) {
+        switch (area) {
+            case LayoutArea::HOME: return homeItems;
+            case LayoutArea::HOTSEAT: return hotseatItems;
+            case LayoutArea::HOME_ONLY: return homeOnlyItems;
+            case LayoutArea::HOTSEAT_HOME_ONLY: return hotseatHomeOnlyItems;
+            case LayoutArea::APP_ORDER: break;
+        }
+        return appOrderItems;
+    }
+
+    bool readSection(detail::XmlReader& reader, const detail::XmlToken& start) {
+        LayoutArea area = LayoutArea::APP_ORDER;
+        findSectionArea(start.name, area);
+        std::vector<ItemView>* target = &sectionItems(area);
+        if (start.selfClosing) return true;
+
+        detail::XmlToken token;
+        while (reader.next(token)) {
+            if (token.type == detail::XmlTokenType::EndElement) return token.name == start.name;
+            if (token.type != detail::XmlTokenType::StartElement) continue;
+            ItemView view;
+            if (!readItem(reader, token, view)) return false;
+            target->push_back(view);
+        }
+        return false;
+    }
+
+    bool configValue(std::string_view tag, const std::string& text, std::string_view) {
+        return applyConfigValue(layoutConfig, tag, text);
+    }
+
+    void raw(std::string_view) {}
+
+    // 按屏幕稳定排序，并生成页面区间表
+    static void buildPages(std::vector<ItemView>& items, std::vector<PageRange>& pages) {
+        std::stable_sort(items.begin(), items.end(),
+            [](const ItemView& a, const ItemView& b) { return a.screen < b.screen; });
+        for (uint32_t i = 0; i < items.size(); ++i) {
+            if (pages.empty() || pages.back().screen != items[i].screen) {
+                pages.push_back({items[i].screen, i, 0});
+            }
+            ++pages.back().count;
+        }
+    }
+
+    Span<ItemView> page(const std::vector<ItemView>& items, const std::vector<PageRange>& pages, int screen) const {
+        auto it = std::lower_bound(pages.begin(), pages.end(), screen,
+            [](const PageRange& range, int value) { return range.screen < value; });
+        if (it == pages.end() || it->screen != screen) return Span<ItemView>();
+        return Span<ItemView>(items.data() + it->begin, it->count);
+    }
+};
+
+// MappedLayout实现
+MappedLayout::MappedLayout() : pImpl(std::make_unique<MappedLayoutImpl>()) {}
+
+MappedLayout::~MappedLayout() = default;
+
+bool MappedLayout::open(const std::string& filePath) {
+    close();
+    if (!pImpl->map(filePath)) {
+        std::cerr << "Failed to map XML file: " << filePath << std::endl;
+        close();
+        return false;
+    }
+
+    detail::XmlReader reader(pImpl->data, pImpl->size);
+    std::string error;
+    if (!detail::walkDocument(reader, *pImpl, error)) {
+        std::cerr << "Error parsing XML: " << error << std::endl;
+        close();
+        return false;
+    }
+
+    MappedLayoutImpl::buildPages(pImpl->homeItems, pImpl->homePages);
+    MappedLayoutImpl::buildPages(pImpl->homeOnlyItems, pImpl->homeOnlyPages);
+    pImpl->opened = true;
+    return true;
+}
+
+void MappedLayout::close() {
+    pImpl->resetContent();
+    pImpl->unmap();
+    pImpl->opened = false;
+}
+
+bool MappedLayout::isOpen() const {
+    return pImpl->opened;
+}
+
+const LayoutConfig& MappedLayout::getLayoutConfig() const {
+    return pImpl->layoutConfig;
+}
+
+size_t MappedLayout::getHomePageCount() const {
+    return pImpl->homePages.size();
+}
+
+Span<ItemView> MappedLayout::getHomeItems(int pageIndex) const {
+    return pImpl->page(pImpl->homeItems, pImpl->homePages, pageIndex);
+}
+
+Span<ItemView> MappedLayout::getHotseatItems() const {
+    return Span<ItemView>(pImpl->hotseatItems.data(), pImpl->hotseatItems.size());
+}
+
+size_t MappedLayout::getHomeOnlyPageCount() const {
+    return pImpl->homeOnlyPages.size();
+}
+
+Span<ItemView> MappedLayout::getHomeOnlyItems(int pageIndex) const {
+    return pImpl->page(pImpl->homeOnlyItems, pImpl->homeOnlyPages, pageIndex);
+}
+
+Span<ItemView> MappedLayout::getHotseatHomeOnlyItems() const {
+    return Span<ItemView>(pImpl->hotseatHomeOnlyItems.data(), pImpl->hotseatHomeOnlyItems.size());
+}
+
+Span<ItemView> MappedLayout::getAppOrderItems() const {
+    return Span<ItemView>(pImpl->appOrderItems.data(), pImpl->appOrderItems.size());
+}
+
+Span<ItemView> MappedLayout::getFolderItems(const ItemView& folder) const {
+    if (folder.childCount == 0 || folder.firstChild + folder.childCount > pImpl->children.size()) {
+        return Span<ItemView>();
+    }
+    return Span<ItemView>(pImpl->children.data() + folder.firstChild, folder.childCount);
+}
+
+} // namespace exml
@@ -0,0 +1,73 @@
+#ifndef EXML_MATCH_H
+#define EXML_MATCH_H
+
+#include "exml_diff.h"
+#include "exml_model.h"
+#include <string_view>
+#include <vector>
+
+namespace exml {
+
+/**
+ * @brief 跨布局匹配项目的键：(类型, 包名, 类名, 小部件ID)
+ */
+struct ItemKey {
+    ItemType type;
+    std::string_view packageName;
+    std::string_view className;
+    int appWidgetID;
+
+    ItemKey(const ItemRecord& item, const StringPool& pool)
+        : type(item.type), packageName(pool.lookup(item.packageId)), className(pool.lookup(item.classId)),
+          appWidgetID(item.appWidgetID) {}
+
+    bool operator==(const ItemKey& other) const {
+        return type == other.type && appWidgetID == other.appWidgetID &&
+               packageName == other.packageName && className == other.className;
+    }
+};
+
+struct ItemKeyHash {
+    size_t operator()(const ItemKey& key) const;
+};
+
+/**
+ * @brief 待匹配序列中的一项及其路径，pool为项目所属布局的字符串池
+ */
+struct ItemEntry {
+    const ItemRecord* item;
+    const StringPool* pool;
+    ItemPath path;
+};
+
+void collectEntries(const LayoutModel& model, LayoutArea area, const ItemList& items, int page,
+                    std::vector<ItemEntry>& out);
+
+void collectEntries(const LayoutModel& model, LayoutArea area, const PagedItems& pages, std::vector<ItemEntry>& out);
+
+/**
+ * @brief 追加文件夹内的项目，路径为文件夹的位置加子序号
+ */
+void collectChildren(const ItemEntry& folder, std::vector<ItemEntry>& out);
+
+/**
+ * @brief 按键把after中的项目与before配对，同键的多个项目按出现顺序配对
+ * @param matches 返回after[i]配对的before序号，未配对为-1
+ */
+void matchEntries(const std::vector<ItemEntry>& before, const std::vector<ItemEntry>& after, std::vector<int>& matches);
+
+/**
+ * @brief 按属性表比较，返回取值不同的属性位
+ *
+ * 字符串按内容比较；两个项目使用同一个字符串池时直接比较ID。
+ */
+unsigned int changedAttributes(const ItemRecord& a, const StringPool& aPool, const ItemRecord& b,
+                               const StringPool& bPool);
+
+inline unsigned int changedAttributes(const ItemEntry& a, const ItemEntry& b) {
+    return changedAttributes(*a.item, *a.pool, *b.item, *b.pool);
+}
+
+} // namespace exml
+
+#endif // EXML_MATCH_H
@@ -0,0 +1,414 @@
+#include "exml_merge.h"
+#include "exml_internal.h"
+#include "exml_match.h"
+#include "exml_schema.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+
+namespace exml {
+
+MergeConflict::MergeConflict()
+    : kind(ConflictKind::ITEM), area(LayoutArea::HOME), theirs{LayoutArea::HOME, -1, 0},
+      ours{LayoutArea::HOME, -1, 0}, relocated{LayoutArea::HOME, -1, 0} {}
+
+MergeOptions::MergeOptions() : preferred(MergeSide::THEIRS) {}
+
+namespace {
+
+// 决定项目所占单元格或快捷栏位置的属性
+constexpr unsigned int kCellAttributes = ATTR_SCREEN | ATTR_X | ATTR_Y | ATTR_SPAN_X | ATTR_SPAN_Y;
+
+enum class Origin {
+    BASE,       // 位置未变或双方一致（与ours中的位置相同）
+    THEIRS,
+    OURS
+};
+
+/**
+ * @brief 合并后的项目（复制为Item，写入结果时再驻留到结果的字符串池）
+ */
+struct MergedItem {
+    Item item;
+    int page;
+    Origin origin;          // 项目位置取自哪一方
+    ItemLocation theirs;
+    ItemLocation ours;
+    bool relocate;          // 与优先一方的项目冲突，需另找位置
+    int conflict;           // relocate时对应的冲突序号
+    bool fromOurs;          // 与ours中的版本完全相同
+};
+
+const ItemLocation kNoLocation{LayoutArea::HOME, -1, 0};
+
+/**
+ * @brief 一个区域的合并状态
+ */
+struct AreaMerge {
+    LayoutArea area;
+    Origin preferred;
+    std::vector<MergeConflict>& conflicts;
+    std::vector<MergedItem> items;
+};
+
+// 两个版本是否完全相同（含页面与文件夹内的项目）
+bool sameVersion(const ItemEntry& a, const ItemEntry& b) {
+    if (a.path.location.page != b.path.location.page || changedAttributes(a, b)) return false;
+    const auto& left = a.item->favorites;
+    const auto& right = b.item->favorites;
+    if (left.size() != right.size()) return false;
+    for (size_t i = 0; i < left.size(); ++i) {
+        if (left[i].type != right[i].type || changedAttributes(left[i], *a.pool, right[i], *b.pool)) return false;
+    }
+    return true;
+}
+
+void copyAttribute(const detail::AttributeDesc& desc, const ItemEntry& from, Item& to) {
+    switch (desc.type) {
+        case detail::AttributeType::STRING: to.*desc.stringMember = from.pool->lookup(from.item->*desc.idMember); break;
+        case detail::AttributeType::INT: to.*desc.intMember = from.item->*desc.recordIntMember; break;
+        case detail::AttributeType::BOOL: to.*desc.boolMember = from.item->*desc.recordBoolMember; break;
+    }
+}
+
+ConflictKind itemConflictKind(const ItemRecord& item) {
+    return item.type == ItemType::FOLDER ? ConflictKind::FOLDER : ConflictKind::ITEM;
+}
+
+void report(AreaMerge& merge, ConflictKind kind, const ItemEntry* theirs, const ItemEntry* ours) {
+    MergeConflict conflict;
+    conflict.kind = kind;
+    conflict.area = merge.area;
+    if (theirs) conflict.theirs = theirs->path.location;
+    if (ours) conflict.ours = ours->path.location;
+    merge.conflicts.push_back(conflict);
+}
+
+void keep(AreaMerge& merge, const ItemEntry& entry, Origin origin, const ItemEntry* theirs, const ItemEntry* ours) {
+    merge.items.push_back(MergedItem{makeItem(*entry.item, *entry.pool), entry.path.location.page, origin,
+                                     theirs ? theirs->path.location : kNoLocation,
+                                     ours ? ours->path.location : kNoLocation, false, -1, &entry == ours});
+}
+
+// 冲突时采用优先一方的整个版本
+void keepPreferred(AreaMerge& merge, const ItemEntry* theirs, const ItemEntry* ours) {
+    const ItemEntry* chosen = merge.preferred == Origin::THEIRS ? theirs : ours;
+    if (chosen) keep(merge, *chosen, merge.preferred, theirs, ours);
+}
+
+// base中的项目在ours中仍存在，theirs中可能已删除
+void mergeMatched(AreaMerge& merge, const ItemEntry& base, const ItemEntry* theirs, const ItemEntry& ours) {
+    const bool oursChanged = !sameVersion(base, ours);
+    if (!theirs) {
+        if (!oursChanged) return;
+        report(merge, itemConflictKind(*ours.item), nullptr, &ours);
+        keepPreferred(merge, nullptr, &ours);
+        return;
+    }
+
+    const bool theirsChanged = !sameVersion(base, *theirs);
+    if (!theirsChanged || !oursChanged || sameVersion(*theirs, ours)) {
+        if (theirsChanged && !oursChanged) keep(merge, *theirs, Origin::THEIRS, theirs, &ours);
+        else keep(merge, ours, oursChanged && !theirsChanged ? Origin::OURS : Origin::BASE, theirs, &ours);
+        return;
+    }
+
+    // 双方都修改了文件夹：不逐项合并其中的项目
+    if (ours.item->type == ItemType::FOLDER) {
+        report(merge, ConflictKind::FOLDER, theirs, &ours);
+        keepPreferred(merge, theirs, &ours);
+        return;
+    }
+
+    // 按属性合并，同一属性改为不同值时取优先一方
+    const int basePage = base.path.location.page;
+    const int theirsPage = theirs->path.location.page;
+    const int oursPage = ours.path.location.page;
+    const unsigned int theirsBits = changedAttributes(base, *theirs);
+    const unsigned int oursBits = changedAttributes(base, ours);
+    const unsigned int conflicting = theirsBits & oursBits & changedAttributes(*theirs, ours);
+    const bool pageConflict = theirsPage != basePage && oursPage != basePage && theirsPage != oursPage;
+    const bool preferTheirs = merge.preferred == Origin::THEIRS;
+
+    MergedItem merged{makeItem(*ours.item, *ours.pool), oursPage, merge.preferred, theirs->path.location,
+                      ours.path.location, false, -1, true};
+    for (const auto& desc : detail::kItemAttributes) {
+        if (!(theirsBits & desc.bit)) continue;
+        if (!(oursBits & desc.bit) || ((conflicting & desc.bit) && preferTheirs)) {
+            copyAttribute(desc, *theirs, merged.item);
+            merged.fromOurs = false;
+        }
+    }
+    if (theirsPage != basePage && (oursPage == basePage || (pageConflict && preferTheirs))) {
+        merged.page = theirsPage;
+        merged.fromOurs = false;
+    }
+
+    const bool theirsMoved = (theirsBits & kCellAttributes) || theirsPage != basePage;
+    const bool oursMoved = (oursBits & kCellAttributes) || oursPage != basePage;
+    if (theirsMoved != oursMoved) merged.origin = theirsMoved ? Origin::THEIRS : Origin::OURS;
+
+    if (conflicting || pageConflict) report(merge, ConflictKind::ITEM, theirs, &ours);
+    merge.items.push_back(merged);
+}
+
+// base中的项目在ours中已删除，theirs中仍存在
+void mergeDeletedByOurs(AreaMerge& merge, const ItemEntry& base, const ItemEntry& theirs) {
+    if (sameVersion(base, theirs)) return;
+    report(merge, itemConflictKind(*theirs.item), &theirs, nullptr);
+    keepPreferred(merge, &theirs, nullptr);
+}
+
+// base中没有的项目；双方添加了同键的项目时视为同一项目
+void mergeAdded(AreaMerge& merge, const ItemEntry* theirs, const ItemEntry* ours) {
+    if (!theirs) {
+        keep(merge, *ours, Origin::OURS, nullptr, ours);
+    } else if (!ours) {
+        keep(merge, *theirs, Origin::THEIRS, theirs, nullptr);
+    } else if (sameVersion(*theirs, *ours)) {
+        keep(merge, *ours, Origin::BASE, theirs, ours);
+    } else {
+        report(merge, itemConflictKind(*ours->item), theirs, ours);
+        keepPreferred(merge, theirs, ours);
+    }
+}
+
+void mergeEntries(AreaMerge& merge, const std::vector<ItemEntry>& base, const std::vector<ItemEntry>& theirs,
+                  const std::vector<ItemEntry>& ours) {
+    std::vector<int> theirsMatches;
+    std::vector<int> oursMatches;
+    matchEntries(base, theirs, theirsMatches);
+    matchEntries(base, ours, oursMatches);
+
+    std::vector<int> baseToTheirs(base.size(), -1);
+    std::vector<int> baseToOurs(base.size(), -1);
+    std::vector<ItemEntry> theirsAdded;
+    std::vector<ItemEntry> oursAdded;
+    for (size_t i = 0; i < theirs.size(); ++i) {
+        if (theirsMatches[i] >= 0) baseToTheirs[theirsMatches[i]] = static_cast<int>(i);
+        else theirsAdded.push_back(theirs[i]);
+    }
+    for (size_t i = 0; i < ours.size(); ++i) {
+        if (oursMatches[i] >= 0) baseToOurs[oursMatches[i]] = static_cast<int>(i);
+        else oursAdded.push_back(ours[i]);
+    }
+
+    // 双方新增的项目同样按键配对
+    std::vector<int> addedMatches;
+    matchEntries(theirsAdded, oursAdded, addedMatches);
+    std::vector<bool> theirsAddedPaired(theirsAdded.size(), false);
+
+    // 先按ours的顺序输出，再追加theirs独有的项目
+    size_t added = 0;
+    for (size_t i = 0; i < ours.size(); ++i) {
+        if (oursMatches[i] >= 0) {
+            const int match = baseToTheirs[oursMatches[i]];
+            mergeMatched(merge, base[oursMatches[i]], match >= 0 ? &theirs[match] : nullptr, ours[i]);
+            continue;
+        }
+        const int pair = addedMatches[added++];
+        if (pair >= 0) theirsAddedPaired[pair] = true;
+        mergeAdded(merge, pair >= 0 ? &theirsAdded[pair] : nullptr, &ours[i]);
+    }
+
+    added = 0;
+    for (size_t i = 0; i < theirs.size(); ++i) {
+        if (theirsMatches[i] >= 0) {
+            if (baseToOurs[theirsMatches[i]] < 0) mergeDeletedByOurs(merge, base[theirsMatches[i]], theirs[i]);
+            continue;
+        }
+        if (!theirsAddedPaired[added++]) mergeAdded(merge, &theirs[i], nullptr);
+    }
+}
+
+Origin opposite(Origin origin) {
+    return origin == Origin::THEIRS ? Origin::OURS : Origin::THEIRS;
+}
+
+void reportRelocation(AreaMerge& merge, ConflictKind kind, MergedItem& loser, const MergedItem& winner) {
+    const MergedItem& theirs = loser.origin == Origin::THEIRS ? loser : winner;
+    const MergedItem& ours = loser.origin == Origin::OURS ? loser : winner;
+    MergeConflict conflict;
+    conflict.kind = kind;
+    conflict.area = merge.area;
+    conflict.theirs = theirs.theirs;
+    conflict.ours = ours.ours;
+    loser.relocate = true;
+    loser.conflict = static_cast<int>(merge.conflicts.size());
+    merge.conflicts.push_back(conflict);
+}
+
+// 网格区域：另一方的项目与优先一方或双方都未移动的项目重叠时让位
+void resolveCells(AreaMerge& merge, int rows, int columns) {
+    if (rows <= 0 || columns <= 0) return;
+    std::map<int, std::vector<size_t>> pages;
+    for (size_t i = 0; i < merge.items.size(); ++i) {
+        pages[merge.items[i].page].push_back(i);
+    }
+
+    const Origin loserOrigin = opposite(merge.preferred);
+    std::vector<int> owners;
+    for (const auto& page : pages) {
+        owners.assign(static_cast<size_t>(rows) * columns, -1);
+        for (const Origin pass : {Origin::BASE, merge.preferred, loserOrigin}) {
+            for (size_t index : page.second) {
+                MergedItem& merged = merge.items[index];
+                if (merged.origin != pass) continue;
+                const Item& item = merged.item;
+                const int left = std::max(item.x, 0);
+                const int top = std::max(item.y, 0);
+                const int right = std::min(item.x + std::max(item.spanX, 1), columns);
+                const int bottom = std::min(item.y + std::max(item.spanY, 1), rows);
+                int winner = -1;
+                for (int y = top; y < bottom && winner < 0; ++y) {
+                    for (int x = left; x < right; ++x) {
+                        const int owner = owners[y * columns + x];
+                        if (pass == loserOrigin && owner >= 0) {
+                            winner = owner;
+                            break;
+                        }
+                        if (pass != loserOrigin) owners[y * columns + x] = static_cast<int>(index);
+                    }
+                }
+                if (winner >= 0) reportRelocation(merge, ConflictKind::CELL, merged, merge.items[winner]);
+            }
+        }
+    }
+}
+
+// 快捷栏：另一方的项目与优先一方或双方都未移动的项目screen相同时让位
+void resolveSlots(AreaMerge& merge) {
+    const Origin loserOrigin = opposite(merge.preferred);
+    std::unordered_map<int, size_t> owners;
+    for (size_t i = 0; i < merge.items.size(); ++i) {
+        if (merge.items[i].origin != loserOrigin) owners.emplace(merge.items[i].item.screen, i);
+    }
+    for (auto& merged : merge.items) {
+        if (merged.origin != loserOrigin) continue;
+        auto it = owners.find(merged.item.screen);
+        if (it != owners.end()) reportRelocation(merge, ConflictKind::HOTSEAT_SLOT, merged, merge.items[it->second]);
+    }
+}
+
+// 合并结果与ours的该区域完全相同：结果中ours的副本（含区域原文）保持不变
+bool sameAsOurs(const AreaMerge& merge, size_t oursCount) {
+    if (merge.items.size() != oursCount) return false;
+    for (const auto& merged : merge.items) {
+        if (!merged.fromOurs || merged.relocate) return false;
+    }
+    return true;
+}
+
+void writeArea(AreaMerge& merge, EXMLParser& result) {
+    const bool grid = merge.area == LayoutArea::HOME || merge.area == LayoutArea::HOME_ONLY;
+    size_t count = 0;
+    int nextSlot = 0;
+    for (const auto& merged : merge.items) {
+        if (merged.relocate) continue;
+        addItemToArea(result, merge.area, merged.page, merged.item);
+        ++count;
+        nextSlot = std::max(nextSlot, merged.item.screen + 1);
+    }
+
+    // 让位的项目：网格区域自动选位，快捷栏排到最后
+    for (auto& merged : merge.items) {
+        if (!merged.relocate) continue;
+        ItemLocation& location = merge.conflicts[merged.conflict].relocated;
+        if (grid) {
+            if (!result.placeItem(merge.area, merged.item, PlacementStrategy::FIRST_FIT, &location)) {
+                location = kNoLocation;
+            }
+            continue;
+        }
+        merged.item.screen = nextSlot++;
+        addItemToArea(result, merge.area, 0, merged.item);
+        location = ItemLocation{merge.area, 0, count++};
+    }
+}
+
+// 三个布局的模型，按区域取出各自的项目
+struct MergeInputs {
+    const LayoutModel& base;
+    const LayoutModel& theirs;
+    const LayoutModel& ours;
+};
+
+// result中已是ours的副本，只有合并结果与ours不同的区域才替换
+template <typename Items>
+void mergeArea(const MergeInputs& inputs, LayoutArea area, Items LayoutModel::* items, Origin preferred,
+               const LayoutConfig& config, EXMLParser& result, std::vector<MergeConflict>& conflicts) {
+    std::vector<ItemEntry> baseEntries;
+    std::vector<ItemEntry> theirsEntries;
+    std::vector<ItemEntry> oursEntries;
+    if constexpr (std::is_same_v<Items, PagedItems>) {
+        collectEntries(inputs.base, area, inputs.base.*items, baseEntries);
+        collectEntries(inputs.theirs, area, inputs.theirs.*items, theirsEntries);
+        collectEntries(inputs.ours, area, inputs.ours.*items, oursEntries);
+    } else {
+        collectEntries(inputs.base, area, inputs.base.*items, 0, baseEntries);
+        collectEntries(inputs.theirs, area, inputs.theirs.*items, 0, theirsEntries);
+        collectEntries(inputs.ours, area, inputs.ours.*items, 0, oursEntries);
+    }
+
+    AreaMerge merge{area, preferred, conflicts, {}};
+    mergeEntries(merge, baseEntries, theirsEntries, oursEntries);
+    if (area == LayoutArea::HOME || area == LayoutArea::HOME_ONLY) {
+        resolveCells(merge, config.rows, config.columns);
+    } else if (area == LayoutArea::HOTSEAT || area == LayoutArea::HOTSEAT_HOME_ONLY) {
+        resolveSlots(merge);
+    }
+    if (sameAsOurs(merge, oursEntries.size())) return;
+
+    (editableModel(result, area).*items).clear();
+    areaEdited(result, area);
+    writeArea(merge, result);
+}
+
+} // namespace
+
+bool merge(const EXMLParser& base, const EXMLParser& theirs, const EXMLParser& ours,
+           EXMLParser& result, std::vector<MergeConflict>& conflicts, const MergeOptions& options) {
+    if (&result == &base || &result == &theirs || &result == &ours) {
+        std::cerr << "Merge result must not be one of the inputs" << std::endl;
+        return false;
+    }
+    const LayoutModel& baseModel = layoutOf(base);
+    const LayoutModel& theirsModel = layoutOf(theirs);
+    const LayoutModel& oursModel = layoutOf(ours);
+    const Origin preferred = options.preferred == MergeSide::THEIRS ? Origin::THEIRS : Origin::OURS;
+    conflicts.clear();
+
+    // 配置逐字段三方合并
+    LayoutConfig config = oursModel.layoutConfig;
+    for (int field = 0; field < configFieldCount(); ++field) {
+        const bool theirsChanged = !configFieldEquals(baseModel.layoutConfig, theirsModel.layoutConfig, field);
+        const bool oursChanged = !configFieldEquals(baseModel.layoutConfig, oursModel.layoutConfig, field);
+        const bool conflicting = theirsChanged && oursChanged &&
+                                 !configFieldEquals(theirsModel.layoutConfig, oursModel.layoutConfig, field);
+        if (theirsChanged && (!oursChanged || (conflicting && preferred == Origin::THEIRS))) {
+            copyConfigField(theirsModel.layoutConfig, config, field);
+        }
+        if (conflicting) {
+            MergeConflict conflict;
+            conflict.kind = ConflictKind::CONFIG;
+            conflict.tag = configFieldTag(field);
+            conflicts.push_back(std::move(conflict));
+        }
+    }
+
+    // 从ours的副本开始（保留文档骨架与未修改区域的原文），只替换合并后有变化的区域
+    copyLayout(ours, result);
+    result.setLayoutConfig(config);
+    const MergeInputs inputs{baseModel, theirsModel, oursModel};
+    mergeArea(inputs, LayoutArea::HOME, &LayoutModel::homeItems, preferred, config, result, conflicts);
+    mergeArea(inputs, LayoutArea::HOTSEAT, &LayoutModel::hotseatItems, preferred, config, result, conflicts);
+    mergeArea(inputs, LayoutArea::HOME_ONLY, &LayoutModel::homeOnlyItems, preferred, config, result, conflicts);
+    mergeArea(inputs, LayoutArea::HOTSEAT_HOME_ONLY, &LayoutModel::hotseatHomeOnlyItems, preferred, config, result,
+              conflicts);
+    mergeArea(inputs, LayoutArea::APP_ORDER, &LayoutModel::appOrderItems, preferred, config, result, conflicts);
+    return true;
+}
+
+} // namespace exml
@@ -0,0 +1,151 @@
+#ifndef EXML_MODEL_H
+#define EXML_MODEL_H
+
+#include "exml_parser.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace exml {
+
+// LayoutArea的取值个数
+constexpr int kLayoutAreaCount = 5;
+
+/**
+ * @brief 解析器内部保存的项目
+ *
+ * 字段与Item相同（默认值也相同），但packageName、className、title只保存
+ * 在解析器字符串池中的ID，同名字符串在所有项目间只存一份。
+ * 公共接口通过ItemRef读取，get/find系列接口复制为Item。
+ *
+ * 记录支持分配器：放入区域容器时，文件夹内的项目与容器使用同一内存资源。
+ */
+struct ItemRecord {
+    using allocator_type = std::pmr::polymorphic_allocator<ItemRecord>;
+
+    ItemRecord() = default;
+    explicit ItemRecord(const allocator_type& allocator) : favorites(allocator) {}
+    ItemRecord(const ItemRecord& other, const allocator_type& allocator);
+    ItemRecord(ItemRecord&& other, const allocator_type& allocator);
+    ItemRecord(const ItemRecord&) = default;
+    ItemRecord(ItemRecord&&) noexcept = default;
+    ItemRecord& operator=(const ItemRecord&) = default;
+    ItemRecord& operator=(ItemRecord&&) = default;
+
+    ItemType type = ItemType::FAVORITE;
+    bool hidden = false;
+    uint32_t packageId = 0;
+    uint32_t classId = 0;
+    uint32_t titleId = 0;
+    int screen = 0;
+    int x = 0;
+    int y = 0;
+    int spanX = 1;
+    int spanY = 1;
+    int appWidgetID = 0;
+    int options = 0;
+    int color = -1;
+    unsigned int attributeMask = 0;
+    std::pmr::vector<ItemRecord> favorites;
+};
+
+/**
+ * @brief 把项目的字符串驻留到pool，转换为内部记录
+ * @param allocator 记录（含文件夹内项目）使用的分配器
+ */
+ItemRecord makeRecord(const Item& item, StringPool& pool, const ItemRecord::allocator_type& allocator = {});
+
+/**
+ * @brief 由内部记录复制出Item，字符串从pool读取
+ */
+Item makeItem(const ItemRecord& record, const StringPool& pool);
+
+// 区域容器与其中的项目记录使用多态分配器，可由调用方提供内存资源；字符串在字符串池中
+using ItemList = std::pmr::vector<ItemRecord>;
+using PagedItems = std::pmr::map<int, ItemList>;
+
+/**
+ * @brief 文档骨架片段类型
+ */
+enum class SegmentKind {
+    RAW,        // 原样输出的字节（声明、空白、未识别元素等）
+    CONFIG,     // 已识别的配置元素，未修改时原样输出，否则按LayoutConfig重新生成
+    SECTION     // 区域元素，由模型重新序列化
+};
+
+/**
+ * @brief 文档骨架片段
+ *
+ * 加载时按源文件顺序记录顶层结构，保存时据此还原，
+ * 使未修改的文件能够逐字节复原。
+ */
+struct DocumentSegment {
+    SegmentKind kind = SegmentKind::RAW;
+    std::string text;                 // RAW/CONFIG：源字节
+    int field = -1;                   // CONFIG：配置字段序号
+    LayoutArea area = LayoutArea::HOME;       // SECTION：区域
+    bool selfClosing = false;         // SECTION：源文件中为 <tag /> 形式
+    std::string itemSeparator;        // SECTION：项目前的空白
+    std::string closeSeparator;       // SECTION：结束标签前的空白
+    std::string childSeparator;       // SECTION：文件夹内项目前的空白
+    std::string childCloseSeparator;  // SECTION：文件夹结束标签前的空白
+    std::string source;               // SECTION：源文件中的原文（含起止标签），区域未修改时保存直接输出
+    int sourceLine = 0;               // SECTION：推迟解析时原文的起始行号
+};
+
+/**
+ * @brief 布局数据模型，EXMLParser的全部状态
+ */
+struct LayoutModel {
+    explicit LayoutModel(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    LayoutConfig layoutConfig;
+    PagedItems homeItems;                              // 按页面存储
+    ItemList hotseatItems;
+    PagedItems homeOnlyItems;                          // 按页面存储
+    ItemList appOrderItems;
+    ItemList hotseatHomeOnlyItems;
+
+    std::vector<DocumentSegment> skeleton;             // 为空表示按默认格式输出
+    std::string newline = "\n";                        // 源文件的换行风格
+    LayoutConfig loadedConfig;                         // 加载时的配置，用于判断配置项是否被修改
+    unsigned int dirtySections = 0;                    // 加载后修改过的区域（SectionMask位）
+
+    std::shared_ptr<StringPool> stringPool;            // 项目中字符串ID所属的池
+
+    // 新建项目记录应使用的分配器，与区域容器相同
+    ItemRecord::allocator_type itemAllocator() const { return hotseatItems.get_allocator(); }
+};
+
+/**
+ * @brief 将模型序列化为EXML文本，追加到out
+ */
+void writeDocument(const LayoutModel& model, std::string& out);
+
+/**
+ * @brief 将模型写为二进制快照（exml_snapshot.cpp），追加到out
+ */
+void writeSnapshot(const LayoutModel& model, std::string& out);
+
+/**
+ * @brief 只写文档骨架的快照：配置写为加载时的配置，五个区域为空，追加到out
+ *
+ * LayoutStore以此保存布局中项目以外的部分（未识别的元素、空白与换行风格等），
+ * 用readSnapshot读回后再添加项目，即可按原格式输出。
+ */
+void writeSkeletonSnapshot(const LayoutModel& model, std::string& out);
+
+/**
+ * @brief 从二进制快照读取模型，model应为空
+ *
+ * 项目的字符串驻留到model.stringPool，快照中每个不同的字符串只驻留一次。
+ * @param error 失败时写入原因
+ */
+bool readSnapshot(const char* data, size_t size, LayoutModel& model, std::string& error);
+
+} // namespace exml
+
+#endif // EXML_MODEL_H
@@ -1,19 +1,126 @@
 #include "exml_parser.h"
+#include "exml_fingerprint.h"
+#include "exml_grid.h"
+#include "exml_index.h"
+#include "exml_internal.h"
+#include "exml_model.h"
+#include "exml_schema.h"
+#include "exml_walker.h"
 #include "tinyxml2.h"
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
-#include <stdexcept>
+#include <charconv>
 
 namespace exml {
 
 // Item结构体实现
 Item::Item() : type(ItemType::FAVORITE), screen(0), x(0), y(0), spanX(1), spanY(1), 
-               appWidgetID(0), options(0), color(-1), hidden(false) {}
+               appWidgetID(0), options(0), color(-1), hidden(false), attributeMask(0) {}
 Item::~Item() = default;
 Item::Item(const Item& other) = default;
 Item& Item::operator=(const Item& other) = default;
+Item::Item(Item&& other) noexcept = default;
+Item& Item::operator=(Item&& other) noexcept = default;
+
+namespace {
+
+// 复制记录的类型与属性字段，不含文件夹内的项目
+void copyFields(const ItemRecord& from, ItemRecord& to) {
+    to.type = from.type;
+    to.attributeMask = from.attributeMask;
+    for (const auto& desc : detail::kItemAttributes) {
+        switch (desc.type) {
+            case detail::AttributeType::STRING: to.*desc.idMember = from.*desc.idMember; break;
+            case detail::AttributeType::INT: to.*desc.recordIntMember = from.*desc.recordIntMember; break;
+            case detail::AttributeType::BOOL: to.*desc.recordBoolMember = from.*desc.recordBoolMember; break;
+        }
+    }
+}
+
+} // namespace
+
+// 指定分配器的复制与移动：文件夹内的项目按uses-allocator规则逐层使用同一分配器
+ItemRecord::ItemRecord(const ItemRecord& other, const allocator_type& allocator)
+    : favorites(other.favorites, allocator) {
+    copyFields(other, *this);
+}
+
+ItemRecord::ItemRecord(ItemRecord&& other, const allocator_type& allocator)
+    : favorites(std::move(other.favorites), allocator) {
+    copyFields(other, *this);
+}
+
+// 内部记录与Item之间的转换
+ItemRecord makeRecord(const Item& item, StringPool& pool, const ItemRecord::allocator_type& allocator) {
+    ItemRecord record(allocator);
+    record.type = item.type;
+    record.attributeMask = item.attributeMask;
+    for (const auto& desc : detail::kItemAttributes) {
+        switch (desc.type) {
+            case detail::AttributeType::STRING: record.*desc.idMember = pool.intern(item.*desc.stringMember); break;
+            case detail::AttributeType::INT: record.*desc.recordIntMember = item.*desc.intMember; break;
+            case detail::AttributeType::BOOL: record.*desc.recordBoolMember = item.*desc.boolMember; break;
+        }
+    }
+    record.favorites.reserve(item.favorites.size());
+    for (const auto& child : item.favorites) {
+        record.favorites.push_back(makeRecord(child, pool, allocator));
+    }
+    return record;
+}
+
+Item makeItem(const ItemRecord& record, const StringPool& pool) {
+    Item item;
+    item.type = record.type;
+    item.attributeMask = record.attributeMask;
+    for (const auto& desc : detail::kItemAttributes) {
+        switch (desc.type) {
+            case detail::AttributeType::STRING: item.*desc.stringMember = pool.lookup(record.*desc.idMember); break;
+            case detail::AttributeType::INT: item.*desc.intMember = record.*desc.recordIntMember; break;
+            case detail::AttributeType::BOOL: item.*desc.boolMember = record.*desc.recordBoolMember; break;
+        }
+    }
+    item.favorites.reserve(record.favorites.size());
+    for (const auto& child : record.favorites) {
+        item.favorites.push_back(makeItem(child, pool));
+    }
+    return item;
+}
+
+// ItemRef实现
+ItemType ItemRef::type() const { return record_->type; }
+std::string_view ItemRef::packageName() const { return pool_->lookup(record_->packageId); }
+std::string_view ItemRef::className() const { return pool_->lookup(record_->classId); }
+std::string_view ItemRef::title() const { return pool_->lookup(record_->titleId); }
+int ItemRef::screen() const { return record_->screen; }
+int ItemRef::x() const { return record_->x; }
+int ItemRef::y() const { return record_->y; }
+int ItemRef::spanX() const { return record_->spanX; }
+int ItemRef::spanY() const { return record_->spanY; }
+int ItemRef::appWidgetID() const { return record_->appWidgetID; }
+int ItemRef::options() const { return record_->options; }
+int ItemRef::color() const { return record_->color; }
+bool ItemRef::hidden() const { return record_->hidden; }
+unsigned int ItemRef::attributeMask() const { return record_->attributeMask; }
+uint32_t ItemRef::packageId() const { return record_->packageId; }
+uint32_t ItemRef::classId() const { return record_->classId; }
+size_t ItemRef::childCount() const { return record_->favorites.size(); }
+
+ItemRef ItemRef::child(size_t index) const {
+    return index < record_->favorites.size() ? ItemRef(&record_->favorites[index], pool_) : ItemRef();
+}
+
+Item ItemRef::toItem() const {
+    return record_ ? makeItem(*record_, *pool_) : Item();
+}
+
+ItemRef ItemsView::operator[](size_t index) const {
+    return ItemRef(data_ + index, pool_);
+}
 
 // LayoutConfig结构体实现
 LayoutConfig::LayoutConfig() : rows(5), columns(4), pageCount(1), screenIndex(0),
@@ -25,68 +132,201 @@ LayoutConfig::LayoutConfig() : rows(5), columns(4), pageCount(1), screenIndex(0)
 LayoutConfig::~LayoutConfig() = default;
 LayoutConfig::LayoutConfig(const LayoutConfig& other) = default;
 LayoutConfig& LayoutConfig::operator=(const LayoutConfig& other) = default;
+LayoutConfig::LayoutConfig(LayoutConfig&& other) noexcept = default;
+LayoutConfig& LayoutConfig::operator=(LayoutConfig&& other) noexcept = default;
+
+// LoadOptions结构体实现
+LoadOptions::LoadOptions() : mode(LoadMode::STREAMING), sections(SECTION_ALL) {}
+
+// Placement结构体实现
+Placement::Placement() : page(0), x(0), y(0) {}
+
+Fingerprint::Fingerprint() : low(0), high(0) {}
+
+Fingerprint::Fingerprint(uint64_t low, uint64_t high) : low(low), high(high) {}
+
+// ParseDiagnostic结构体实现
+ParseDiagnostic::ParseDiagnostic() : line(0) {}
+
+namespace {
+
+// DOM模式的文档对象按线程复用（批量加载时即每个工作线程一份）
+tinyxml2::XMLDocument& reusableDocument() {
+    static thread_local tinyxml2::XMLDocument document;
+    return document;
+}
+
+} // namespace
+
+// 一次性读取整个文件到缓冲区
+bool readFileContents(const std::string& filePath, std::string& buffer) {
+    FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file) return false;
+    bool ok = std::fseek(file, 0, SEEK_END) == 0;
+    long size = ok ? std::ftell(file) : -1;
+    ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+    if (ok) {
+        buffer.resize(static_cast<size_t>(size));
+        ok = size == 0 || std::fread(&buffer[0], 1, buffer.size(), file) == buffer.size();
+    }
+    std::fclose(file);
+    return ok;
+}
+
+bool writeFileContents(const std::string& filePath, const std::string& data) {
+    FILE* file = std::fopen(filePath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open file for writing: " << filePath << std::endl;
+        return false;
+    }
+    // 关闭stdio缓冲，整个内容通过一次write写入
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Failed to write file: " << filePath << std::endl;
+    }
+    return ok;
+}
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string_view trimmed(std::string_view text) {
+    while (!text.empty() && isSpace(text.front())) text.remove_prefix(1);
+    while (!text.empty() && isSpace(text.back())) text.remove_suffix(1);
+    return text;
+}
+
+} // namespace
+
+bool decodeInt(std::string_view text, int& value) {
+    text = trimmed(text);
+    // from_chars不接受正号
+    if (text.size() > 1 && text.front() == '+' && text[1] != '-') text.remove_prefix(1);
+    int result = 0;
+    const char* end = text.data() + text.size();
+    auto parsed = std::from_chars(text.data(), end, result);
+    if (parsed.ec != std::errc() || parsed.ptr != end) return false;
+    value = result;
+    return true;
+}
+
+bool decodeBool(std::string_view text, bool& value) {
+    text = trimmed(text);
+    if (text == "true" || text == "1") value = true;
+    else if (text == "false" || text == "0") value = false;
+    else return false;
+    return true;
+}
+
+ItemType itemTypeFromTag(std::string_view tag) {
+    if (tag == "folder") return ItemType::FOLDER;
+    if (tag == "appwidget") return ItemType::APPWIDGET;
+    return ItemType::FAVORITE;
+}
+
+LayoutModel::LayoutModel(std::pmr::memory_resource* resource)
+    : homeItems(resource), hotseatItems(resource), homeOnlyItems(resource),
+      appOrderItems(resource), hotseatHomeOnlyItems(resource), stringPool(std::make_shared<StringPool>(false)) {}
+
+// 解析器自带的内存池，需先于LayoutModel构造、后于其析构
+struct ArenaHolder {
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+
+    explicit ArenaHolder(AllocationMode mode)
+        : arena(mode == AllocationMode::ARENA ? std::make_unique<std::pmr::monotonic_buffer_resource>() : nullptr) {}
+};
 
 // 实现类
-class EXMLParserImpl {
+class EXMLParserImpl : private ArenaHolder, public LayoutModel {
 public:
-    LayoutConfig layoutConfig;
-    std::map<int, std::vector<Item>> homeItems;        // 按页面存储
-    std::vector<Item> hotseatItems;
-    std::map<int, std::vector<Item>> homeOnlyItems;    // 按页面存储
-    std::vector<Item> appOrderItems;
-    std::vector<Item> hotseatHomeOnlyItems;
+    explicit EXMLParserImpl(AllocationMode mode = AllocationMode::HEAP)
+        : ArenaHolder(mode), LayoutModel(arena ? arena.get() : std::pmr::get_default_resource()) {}
+
+    explicit EXMLParserImpl(std::pmr::memory_resource* resource)
+        : ArenaHolder(AllocationMode::HEAP), LayoutModel(resource) {}
+
+    std::string lastError;   // 最近一次加载失败的原因
+    std::vector<ParseDiagnostic> diagnostics;   // 最近一次加载中无法解码的字段
+    const detail::XmlReader* streamReader = nullptr;   // 流式加载期间用于换算行号
+    int streamLineBase = 0;   // 解析推迟的区域时，其源文本之前的行数
+    unsigned int loadSections = SECTION_ALL;   // 流式加载时立即解析的区域
+    unsigned int pendingSections = 0;          // 已推迟、尚未解析的区域
+    std::string decoded;                       // 流式加载时解码含实体的字符串属性
 
-    // 辅助函数
-    static std::string getAttributeValue(const tinyxml2::XMLElement* element, const char* attrName, const std::string& defaultValue = "") {
-        const char* value = element->Attribute(attrName);
-        return value ? value : defaultValue;
+    // 各区域的包名索引，首次查找时建立
+    ItemIndex homeIndex{LayoutArea::HOME};
+    ItemIndex hotseatIndex{LayoutArea::HOTSEAT};
+    ItemIndex homeOnlyIndex{LayoutArea::HOME_ONLY};
+    ItemIndex hotseatHomeOnlyIndex{LayoutArea::HOTSEAT_HOME_ONLY};
+    ItemIndex appOrderIndex{LayoutArea::APP_ORDER};
+
+    // Home与HomeOnly区域的网格占用表，首次查询时按当前行列数建立
+    OccupancyGrid homeGrid;
+    OccupancyGrid homeOnlyGrid;
+
+    // 各区域的内容指纹，首次查询时计算
+    AreaFingerprint homeFingerprint{false};
+    AreaFingerprint hotseatFingerprint{true};
+    AreaFingerprint homeOnlyFingerprint{false};
+    AreaFingerprint hotseatHomeOnlyFingerprint{true};
+    AreaFingerprint appOrderFingerprint{true};
+
+    bool fail(const std::string& message) {
+        lastError = message;
+        std::cerr << message << std::endl;
+        return false;
     }
 
-    static int getAttributeIntValue(const tinyxml2::XMLElement* element, const char* attrName, int defaultValue = 0) {
-        const char* value = element->Attribute(attrName);
-        return value ? std::stoi(value) : defaultValue;
+    void diagnose(std::string_view element, std::string_view attribute, std::string_view value, int line) {
+        ParseDiagnostic diagnostic;
+        diagnostic.element.assign(element.data(), element.size());
+        diagnostic.attribute.assign(attribute.data(), attribute.size());
+        diagnostic.value.assign(value.data(), value.size());
+        diagnostic.line = line;
+        diagnostics.push_back(std::move(diagnostic));
     }
 
-    static bool getAttributeBoolValue(const tinyxml2::XMLElement* element, const char* attrName, bool defaultValue = false) {
-        const char* value = element->Attribute(attrName);
-        if (!value) return defaultValue;
-        std::string str(value);
-        return str == "true" || str == "1";
+    // 流式加载时由记号在文档中的位置换算行号（只在出错时调用）
+    int streamLine(const char* at) const {
+        return streamReader ? streamLineBase + streamReader->lineAt(static_cast<size_t>(at - streamReader->data())) : 0;
     }
 
-    Item parseItem(const tinyxml2::XMLElement* element) {
-        Item item;
-        
-        // 确定项目类型
-        const char* tagName = element->Value();
-        if (strcmp(tagName, "favorite") == 0) {
-            item.type = ItemType::FAVORITE;
-        } else if (strcmp(tagName, "folder") == 0) {
-            item.type = ItemType::FOLDER;
-        } else if (strcmp(tagName, "appwidget") == 0) {
-            item.type = ItemType::APPWIDGET;
+    // 按属性表解码数值/布尔属性（字符串属性由调用方处理实体）
+    static bool decodeAttribute(ItemRecord& item, const detail::AttributeDesc& desc, std::string_view value) {
+        switch (desc.type) {
+            case detail::AttributeType::INT: return decodeInt(value, item.*desc.recordIntMember);
+            case detail::AttributeType::BOOL: return decodeBool(value, item.*desc.recordBoolMember);
+            case detail::AttributeType::STRING: break;
+        }
+        return true;
+    }
+
+    ItemRecord parseItem(const tinyxml2::XMLElement* element) {
+        ItemRecord item(itemAllocator());
+        item.type = itemTypeFromTag(element->Value());
+
+        // 每个属性只访问一次，经属性表分派到记录成员；未出现的属性保留默认值
+        for (const tinyxml2::XMLAttribute* attr = element->FirstAttribute(); attr; attr = attr->Next()) {
+            const detail::AttributeDesc* desc = detail::findItemAttribute(attr->Name());
+            if (!desc) continue;
+            item.attributeMask |= desc->bit;
+            if (desc->type == detail::AttributeType::STRING) {
+                item.*desc->idMember = stringPool->intern(attr->Value());
+            } else if (!decodeAttribute(item, *desc, attr->Value())) {
+                diagnose(element->Value(), attr->Name(), attr->Value(), element->GetLineNum());
+            }
         }
-        
-        // 解析基本属性
-        item.packageName = getAttributeValue(element, "packageName");
-        item.className = getAttributeValue(element, "className");
-        item.title = getAttributeValue(element, "title");
-        item.screen = getAttributeIntValue(element, "screen");
-        item.x = getAttributeIntValue(element, "x");
-        item.y = getAttributeIntValue(element, "y");
-        item.spanX = getAttributeIntValue(element, "spanX", 1);
-        item.spanY = getAttributeIntValue(element, "spanY", 1);
-        item.appWidgetID = getAttributeIntValue(element, "appWidgetID");
-        item.options = getAttributeIntValue(element, "options");
-        item.color = getAttributeIntValue(element, "color", -1);
-        item.hidden = getAttributeBoolValue(element, "hidden");
         
         // 解析文件夹内的favorites
         if (item.type == ItemType::FOLDER) {
             const tinyxml2::XMLElement* favorite = element->FirstChildElement("favorite");
             while (favorite) {
-                Item favItem = parseItem(favorite);
-                item.favorites.push_back(favItem);
+                item.favorites.push_back(parseItem(favorite));
                 favorite = favorite->NextSiblingElement("favorite");
             }
         }
@@ -94,213 +334,789 @@ public:
         return item;
     }
 
-    void parseLayoutConfig(const tinyxml2::XMLElement* root) {
-        // 解析基本配置
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("category")) {
-            layoutConfig.category = elem->GetText() ? elem->GetText() : "";
-        }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("FolderGrid")) {
-            layoutConfig.folderGrid = elem->GetText() ? elem->GetText() : "";
-        }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("restore_max_size_grid")) {
-            const char* text = elem->GetText();
-            layoutConfig.restoreMaxSizeGrid = text && (strcmp(text, "true") == 0);
-        }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("zeroPageContents")) {
-            layoutConfig.zeroPageContents = elem->GetText() ? elem->GetText() : "";
-        }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("selectedMinusonePackage")) {
-            layoutConfig.selectedMinusonePackage = elem->GetText() ? elem->GetText() : "";
+    void parseSection(LayoutArea area, const tinyxml2::XMLElement* section) {
+        for (const tinyxml2::XMLElement* item = section->FirstChildElement(); item; item = item->NextSiblingElement()) {
+            ItemRecord parsedItem = parseItem(item);
+            storeItem(area, parsedItem);
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("zeroPage")) {
-            const char* text = elem->GetText();
-            layoutConfig.zeroPage = text && (strcmp(text, "true") == 0);
-        }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("notification_panel_setting")) {
-            const char* text = elem->GetText();
-            layoutConfig.notificationPanelSetting = text && (strcmp(text, "true") == 0);
-        }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("lock_layout_setting")) {
-            const char* text = elem->GetText();
-            layoutConfig.lockLayoutSetting = text && (strcmp(text, "true") == 0);
-        }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("quick_access_finder")) {
-            const char* text = elem->GetText();
-            layoutConfig.quickAccessFinder = text && (strcmp(text, "true") == 0);
+    }
+
+    void resetContent() {
+        // 与空容器交换，确保不再持有任何已分配的内存，之后才能整体释放内存池
+        PagedItems(homeItems.get_allocator()).swap(homeItems);
+        ItemList(hotseatItems.get_allocator()).swap(hotseatItems);
+        PagedItems(homeOnlyItems.get_allocator()).swap(homeOnlyItems);
+        ItemList(appOrderItems.get_allocator()).swap(appOrderItems);
+        ItemList(hotseatHomeOnlyItems.get_allocator()).swap(hotseatHomeOnlyItems);
+        if (arena) arena->release();
+        diagnostics.clear();
+        layoutConfig = LayoutConfig();
+        skeleton.clear();
+        newline = "\n";
+        loadedConfig = LayoutConfig();
+        homeIndex.invalidate();
+        hotseatIndex.invalidate();
+        homeOnlyIndex.invalidate();
+        hotseatHomeOnlyIndex.invalidate();
+        appOrderIndex.invalidate();
+        homeGrid.invalidate();
+        homeOnlyGrid.invalidate();
+        homeFingerprint.invalidate();
+        hotseatFingerprint.invalidate();
+        homeOnlyFingerprint.invalidate();
+        hotseatHomeOnlyFingerprint.invalidate();
+        appOrderFingerprint.invalidate();
+        pendingSections = 0;
+        dirtySections = 0;
+    }
+
+    // ===== 区域操作（按页存储与单列表区域共用） =====
+
+    static ItemList& pageItems(ItemList& items, int) { return items; }
+    static ItemList& pageItems(PagedItems& pages, int page) { return pages[page]; }
+
+    template <typename Area>
+    static ItemIndex& ensureIndex(ItemIndex& index, const Area& area) {
+        if (!index.built()) index.build(area);
+        return index;
+    }
+
+    template <typename Area>
+    std::vector<Item> findItems(Area& area, ItemIndex& index, const std::string& packageName) {
+        std::vector<Item> result;
+        Span<ItemLocation> locations = locateItems(area, index, packageName);
+        result.reserve(locations.size());
+        for (const auto& location : locations) {
+            result.push_back(makeItem(pageItems(area, location.page)[location.index], *stringPool));
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("badge_on_off_setting")) {
-            const char* text = elem->GetText();
-            layoutConfig.badgeOnOffSetting = text ? std::stoi(text) : 0;
+        return result;
+    }
+
+    std::vector<Item> copyItems(const ItemList& items) const {
+        std::vector<Item> result;
+        result.reserve(items.size());
+        for (const auto& item : items) {
+            result.push_back(makeItem(item, *stringPool));
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("only_portrait_mode_setting")) {
-            const char* text = elem->GetText();
-            layoutConfig.onlyPortraitModeSetting = text && (strcmp(text, "true") == 0);
+        return result;
+    }
+
+    template <typename Area>
+    const AreaFingerprint& ensureFingerprint(AreaFingerprint& fingerprint, const Area& area) {
+        if (!fingerprint.built()) fingerprint.build(area, *stringPool);
+        return fingerprint;
+    }
+
+    const AreaFingerprint& ensureFingerprint(LayoutArea area) {
+        ensureSection(area);
+        switch (area) {
+            case LayoutArea::HOME: return ensureFingerprint(homeFingerprint, homeItems);
+            case LayoutArea::HOTSEAT: return ensureFingerprint(hotseatFingerprint, hotseatItems);
+            case LayoutArea::HOME_ONLY: return ensureFingerprint(homeOnlyFingerprint, homeOnlyItems);
+            case LayoutArea::HOTSEAT_HOME_ONLY: return ensureFingerprint(hotseatHomeOnlyFingerprint, hotseatHomeOnlyItems);
+            case LayoutArea::APP_ORDER: break;
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("add_icon_to_home_setting")) {
-            const char* text = elem->GetText();
-            layoutConfig.addIconToHomeSetting = text && (strcmp(text, "true") == 0);
+        return ensureFingerprint(appOrderFingerprint, appOrderItems);
+    }
+
+    // ===== 推迟解析的区域 =====
+
+    static unsigned int sectionBit(LayoutArea area) { return 1u << static_cast<int>(area); }
+
+    // 区域的内容被整体替换后，按需建立的状态全部重建
+    void invalidateArea(LayoutArea area) {
+        switch (area) {
+            case LayoutArea::HOME:
+                homeIndex.invalidate();
+                homeGrid.invalidate();
+                homeFingerprint.invalidate();
+                break;
+            case LayoutArea::HOTSEAT:
+                hotseatIndex.invalidate();
+                hotseatFingerprint.invalidate();
+                break;
+            case LayoutArea::HOME_ONLY:
+                homeOnlyIndex.invalidate();
+                homeOnlyGrid.invalidate();
+                homeOnlyFingerprint.invalidate();
+                break;
+            case LayoutArea::HOTSEAT_HOME_ONLY:
+                hotseatHomeOnlyIndex.invalidate();
+                hotseatHomeOnlyFingerprint.invalidate();
+                break;
+            case LayoutArea::APP_ORDER:
+                appOrderIndex.invalidate();
+                appOrderFingerprint.invalidate();
+                break;
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("suggested_apps")) {
-            const char* text = elem->GetText();
-            layoutConfig.suggestedApps = text && (strcmp(text, "true") == 0);
+    }
+
+    // 访问区域前调用，解析按LoadOptions::sections推迟的区域
+    void ensureSection(LayoutArea area) {
+        if (pendingSections & sectionBit(area)) parsePendingSection(area);
+    }
+
+    // 修改成功后调用，保存时该区域重新序列化；失败的操作不改变模型，区域仍原样输出
+    void markEdited(LayoutArea area) {
+        dirtySections |= sectionBit(area);
+    }
+
+    void ensureAllSections() {
+        for (int area = 0; pendingSections && area < kLayoutAreaCount; ++area) {
+            ensureSection(static_cast<LayoutArea>(area));
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("expand_hotseat_size")) {
-            const char* text = elem->GetText();
-            layoutConfig.expandHotseatSize = text ? std::stoi(text) : 5;
+    }
+
+    void parsePendingSection(LayoutArea area) {
+        pendingSections &= ~sectionBit(area);
+        for (auto& segment : skeleton) {
+            if (segment.kind != SegmentKind::SECTION || segment.area != area) continue;
+            detail::XmlReader reader(segment.source.data(), segment.source.size());
+            detail::XmlToken start;
+            streamReader = &reader;
+            streamLineBase = segment.sourceLine - 1;
+            const bool ok = reader.next(start) &&
+                            readSectionItems(reader, start, segment,
+                                             [this, area](ItemRecord& item) { storeItem(area, item); });
+            streamReader = nullptr;
+            streamLineBase = 0;
+            // 加载已经成功返回，错误只能记录下来；出错前读到的项目保留
+            if (!ok) {
+                fail("Error parsing XML: malformed <" + std::string(sectionTag(area)) + "> starting at line " +
+                     std::to_string(segment.sourceLine) + (reader.failed() ? ": " + reader.errorMessage() : ""));
+            }
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("home_grid_list")) {
-            layoutConfig.homeGridList = elem->GetText() ? elem->GetText() : "";
+    }
+
+    PagedItems* gridItems(LayoutArea area) {
+        if (area == LayoutArea::HOME) return &homeItems;
+        if (area == LayoutArea::HOME_ONLY) return &homeOnlyItems;
+        return nullptr;
+    }
+
+    // 网格区域返回已建立的占用表，其他区域返回nullptr
+    OccupancyGrid* ensureGrid(LayoutArea area) {
+        const PagedItems* pages = gridItems(area);
+        if (!pages) return nullptr;
+        ensureSection(area);
+        OccupancyGrid* grid = area == LayoutArea::HOME ? &homeGrid : &homeOnlyGrid;
+        if (!grid->built()) grid->build(*pages, layoutConfig.rows, layoutConfig.columns);
+        return grid;
+    }
+
+    // 建立全部按需建立的索引、占用表与指纹，之后的只读查询不再修改内部状态
+    void buildLazyState() {
+        ensureAllSections();
+        ensureIndex(homeIndex, homeItems);
+        ensureIndex(hotseatIndex, hotseatItems);
+        ensureIndex(homeOnlyIndex, homeOnlyItems);
+        ensureIndex(hotseatHomeOnlyIndex, hotseatHomeOnlyItems);
+        ensureIndex(appOrderIndex, appOrderItems);
+        ensureGrid(LayoutArea::HOME);
+        ensureGrid(LayoutArea::HOME_ONLY);
+        for (int area = 0; area < kLayoutAreaCount; ++area) {
+            ensureFingerprint(static_cast<LayoutArea>(area));
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("apps_grid_list")) {
-            layoutConfig.appsGridList = elem->GetText() ? elem->GetText() : "";
+    }
+
+    bool findPlacement(LayoutArea area, int spanX, int spanY, PlacementStrategy strategy, Placement& placement) {
+        const OccupancyGrid* grid = ensureGrid(area);
+        if (!grid || spanX < 1 || spanY < 1 || spanX > grid->columns() || spanY > grid->rows()) return false;
+
+        const PagedItems& pages = *gridItems(area);
+        int bestScore = -1;
+        for (const auto& page : pages) {
+            int x = 0;
+            int y = 0;
+            int score = 0;
+            if (strategy == PlacementStrategy::FIRST_FIT) {
+                if (!grid->findFirstFit(page.first, spanX, spanY, x, y)) continue;
+                placement.page = page.first;
+                placement.x = x;
+                placement.y = y;
+                return true;
+            }
+            if (grid->findBestFit(page.first, spanX, spanY, x, y, score) && score > bestScore) {
+                bestScore = score;
+                placement.page = page.first;
+                placement.x = x;
+                placement.y = y;
+            }
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("viewType_appOrder")) {
-            layoutConfig.viewTypeAppOrder = elem->GetText() ? elem->GetText() : "";
+        if (bestScore >= 0) return true;
+
+        // 已有页面都放不下：新页面的左上角
+        placement.page = pages.empty() ? 0 : pages.rbegin()->first + 1;
+        placement.x = 0;
+        placement.y = 0;
+        return true;
+    }
+
+    template <typename Area>
+    void addItem(Area& area, ItemIndex& index, AreaFingerprint& fingerprint, int page, const Item& item,
+                 OccupancyGrid* grid = nullptr) {
+        ItemList& items = pageItems(area, page);
+        items.push_back(makeRecord(item, *stringPool, itemAllocator()));
+        index.inserted(items, page, items.size() - 1);
+        fingerprint.inserted(items, page, items.size() - 1, *stringPool);
+        if (grid) grid->inserted(items, page, items.size() - 1);
+    }
+
+    template <typename Area>
+    bool removeItem(Area& area, ItemIndex& index, AreaFingerprint& fingerprint, int page,
+                    const std::string& packageName, const std::string& className,
+                    OccupancyGrid* grid = nullptr) {
+        // 名字不在池中时不可能有匹配的项目
+        const uint32_t packageId = stringPool->find(packageName);
+        const uint32_t classId = stringPool->find(className);
+        if (packageId == StringPool::npos || classId == StringPool::npos) return false;
+
+        ItemList& items = pageItems(area, page);
+        size_t at = items.size();
+        if (index.built()) {
+            // 同包名的位置很少，在其中比较classId
+            const std::vector<ItemLocation>* positions = index.find(packageId);
+            for (size_t i = 0; positions && i < positions->size() && at == items.size(); ++i) {
+                const ItemLocation& position = (*positions)[i];
+                if (position.page == page && items[position.index].classId == classId) at = position.index;
+            }
+        } else {
+            // 索引尚未建立时直接扫描本页，不为单次删除建立整个索引
+            auto it = std::find_if(items.begin(), items.end(),
+                [&](const ItemRecord& item) {
+                    return item.packageId == packageId && item.classId == classId;
+                });
+            at = it - items.begin();
         }
-        
-        // 解析网格配置
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("Rows")) {
-            const char* text = elem->GetText();
-            layoutConfig.rows = text ? std::stoi(text) : 5;
+        if (at == items.size()) return false;
+
+        index.erasing(items, page, at);
+        fingerprint.erasing(items, page, at, *stringPool);
+        if (grid) grid->erasing(items, page, at);
+        items.erase(items.begin() + at);
+        return true;
+    }
+
+    template <typename Area>
+    Span<ItemLocation> locateItems(Area& area, ItemIndex& index, const std::string& packageName) {
+        const uint32_t packageId = stringPool->find(packageName);
+        if (packageId == StringPool::npos) return Span<ItemLocation>();
+        const std::vector<ItemLocation>* locations = ensureIndex(index, area).find(packageId);
+        return locations ? Span<ItemLocation>(locations->data(), locations->size()) : Span<ItemLocation>();
+    }
+
+    // ===== 字符串驻留 =====
+
+    // 更换字符串池后，把项目中的ID换成新池中的ID
+    static void remapItem(ItemRecord& item, const StringPool& from, StringPool& to) {
+        item.packageId = to.intern(from.lookup(item.packageId));
+        item.classId = to.intern(from.lookup(item.classId));
+        item.titleId = to.intern(from.lookup(item.titleId));
+        for (auto& favorite : item.favorites) {
+            remapItem(favorite, from, to);
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("Columns")) {
-            const char* text = elem->GetText();
-            layoutConfig.columns = text ? std::stoi(text) : 4;
+    }
+
+    static void remapItems(ItemList& items, const StringPool& from, StringPool& to) {
+        for (auto& item : items) {
+            remapItem(item, from, to);
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("PageCount")) {
-            const char* text = elem->GetText();
-            layoutConfig.pageCount = text ? std::stoi(text) : 1;
+    }
+
+    static void remapItems(PagedItems& pages, const StringPool& from, StringPool& to) {
+        for (auto& page : pages) {
+            remapItems(page.second, from, to);
         }
-        if (const tinyxml2::XMLElement* elem = root->FirstChildElement("ScreenIndex")) {
-            const char* text = elem->GetText();
-            layoutConfig.screenIndex = text ? std::stoi(text) : 0;
+    }
+
+    void setStringPool(std::shared_ptr<StringPool> pool) {
+        if (pool == stringPool) return;
+        const std::shared_ptr<StringPool> old = std::move(stringPool);
+        stringPool = std::move(pool);
+        remapItems(homeItems, *old, *stringPool);
+        remapItems(hotseatItems, *old, *stringPool);
+        remapItems(homeOnlyItems, *old, *stringPool);
+        remapItems(appOrderItems, *old, *stringPool);
+        remapItems(hotseatHomeOnlyItems, *old, *stringPool);
+        // ID已变化，索引需要重建
+        homeIndex.invalidate();
+        hotseatIndex.invalidate();
+        homeOnlyIndex.invalidate();
+        hotseatHomeOnlyIndex.invalidate();
+        appOrderIndex.invalidate();
+    }
+
+    ItemsView pageView(LayoutArea area, const PagedItems& pages, int page) const {
+        auto it = pages.find(page);
+        if (it == pages.end()) return ItemsView(area, page, nullptr, 0, stringPool.get());
+        return ItemsView(area, page, it->second.data(), it->second.size(), stringPool.get());
+    }
+
+    ItemsView listView(LayoutArea area, const ItemList& items) const {
+        return ItemsView(area, 0, items.data(), items.size(), stringPool.get());
+    }
+
+    static const ItemRecord* itemAt(const PagedItems& pages, int page, size_t index) {
+        auto it = pages.find(page);
+        return it != pages.end() && index < it->second.size() ? &it->second[index] : nullptr;
+    }
+
+    static const ItemRecord* itemAt(const ItemList& items, int page, size_t index) {
+        return page == 0 && index < items.size() ? &items[index] : nullptr;
+    }
+
+    const ItemRecord* itemAt(const ItemLocation& location) const {
+        switch (location.area) {
+            case LayoutArea::HOME: return itemAt(homeItems, location.page, location.index);
+            case LayoutArea::HOTSEAT: return itemAt(hotseatItems, location.page, location.index);
+            case LayoutArea::HOME_ONLY: return itemAt(homeOnlyItems, location.page, location.index);
+            case LayoutArea::HOTSEAT_HOME_ONLY: return itemAt(hotseatHomeOnlyItems, location.page, location.index);
+            case LayoutArea::APP_ORDER: return itemAt(appOrderItems, location.page, location.index);
         }
+        return nullptr;
     }
 
-    void parseHomeSection(const tinyxml2::XMLElement* node) {
-        // 兼容：node可以是根节点，也可以是<home>节点
-        const tinyxml2::XMLElement* home = nullptr;
-        if (node && std::string(node->Value()) == "home") {
-            home = node;
-        } else if (node) {
-            home = node->FirstChildElement("home");
+    // 调用方保证fromIndex有效；toIndex超出目标列表长度时放到末尾
+    void moveItem(ItemIndex& index, AreaFingerprint& fingerprint, ItemList& from, int fromPage, size_t fromIndex,
+                  ItemList& to, int toPage, size_t toIndex, OccupancyGrid* grid = nullptr) {
+        index.erasing(from, fromPage, fromIndex);
+        fingerprint.erasing(from, fromPage, fromIndex, *stringPool);
+        if (grid) grid->erasing(from, fromPage, fromIndex);
+        ItemRecord item = std::move(from[fromIndex]);
+        from.erase(from.begin() + fromIndex);
+        if (toIndex > to.size()) toIndex = to.size();
+        to.insert(to.begin() + toIndex, std::move(item));
+        index.inserted(to, toPage, toIndex);
+        fingerprint.inserted(to, toPage, toIndex, *stringPool);
+        if (grid) grid->inserted(to, toPage, toIndex);
+    }
+
+    // 加载时把项目放入所属区域（按页存储的区域以screen为页码）
+    void storeItem(LayoutArea area, ItemRecord& item) {
+        switch (area) {
+            case LayoutArea::HOME: homeItems[item.screen].push_back(std::move(item)); break;
+            case LayoutArea::HOTSEAT: hotseatItems.push_back(std::move(item)); break;
+            case LayoutArea::HOME_ONLY: homeOnlyItems[item.screen].push_back(std::move(item)); break;
+            case LayoutArea::HOTSEAT_HOME_ONLY: hotseatHomeOnlyItems.push_back(std::move(item)); break;
+            case LayoutArea::APP_ORDER: appOrderItems.push_back(std::move(item)); break;
         }
-        if (!home) return;
-        const tinyxml2::XMLElement* item = home->FirstChildElement();
-        while (item) {
-            Item parsedItem = parseItem(item);
-            homeItems[parsedItem.screen].push_back(parsedItem);
-            item = item->NextSiblingElement();
+    }
+
+    DocumentSegment sectionSegment(LayoutArea area) const {
+        DocumentSegment segment;
+        segment.kind = SegmentKind::SECTION;
+        segment.area = area;
+        segment.itemSeparator = newline;
+        segment.closeSeparator = newline;
+        segment.childSeparator = newline;
+        segment.childCloseSeparator = newline;
+        return segment;
+    }
+
+    // DOM模式：单次遍历，区域元素经区域表直接分派，配置元素经配置字段表写入，
+    // 含子元素的其他元素（如根节点）视为透明容器，与流式模式一致
+    void loadElements(const tinyxml2::XMLNode* parent) {
+        for (const tinyxml2::XMLElement* elem = parent->FirstChildElement(); elem; elem = elem->NextSiblingElement()) {
+            LayoutArea area;
+            if (findSectionArea(elem->Value(), area)) {
+                parseSection(area, elem);
+            } else if (elem->FirstChildElement()) {
+                loadElements(elem);
+            } else {
+                const int field = findConfigField(elem->Value());
+                const char* text = elem->GetText();
+                if (field >= 0 && !applyConfigField(layoutConfig, field, text ? text : "")) {
+                    diagnose(elem->Value(), "", text, elem->GetLineNum());
+                }
+            }
         }
     }
-    
-    void parseHotseatSection(const tinyxml2::XMLElement* node) {
-        const tinyxml2::XMLElement* hotseat = nullptr;
-        if (node && std::string(node->Value()) == "hotseat") {
-            hotseat = node;
-        } else if (node) {
-            hotseat = node->FirstChildElement("hotseat");
+
+    bool loadDocument(const tinyxml2::XMLDocument& doc) {
+        loadElements(&doc);
+        buildSkeleton(&doc);
+        loadedConfig = layoutConfig;
+        return true;
+    }
+
+    static std::string printNode(const tinyxml2::XMLNode* node) {
+        tinyxml2::XMLPrinter printer(nullptr, true);
+        node->Accept(&printer);
+        return printer.CStr();
+    }
+
+    // 由DOM生成文档骨架（DOM不保留源文件中的空白，元素按紧凑格式记录）
+    void buildSkeleton(const tinyxml2::XMLNode* parent) {
+        for (const tinyxml2::XMLNode* node = parent->FirstChild(); node; node = node->NextSibling()) {
+            const tinyxml2::XMLElement* elem = node->ToElement();
+            LayoutArea area;
+            int field = -1;
+            if (elem && findSectionArea(elem->Value(), area)) {
+                skeleton.push_back(sectionSegment(area));
+            } else if (elem && elem->FirstChildElement()) {
+                std::string openTag = "<" + std::string(elem->Value());
+                for (const tinyxml2::XMLAttribute* attr = elem->FirstAttribute(); attr; attr = attr->Next()) {
+                    openTag += " " + std::string(attr->Name()) + "=\"";
+                    appendEscapedAttribute(attr->Value(), openTag);
+                    openTag += "\"";
+                }
+                raw(openTag + ">" + newline);
+                buildSkeleton(elem);
+                raw("</" + std::string(elem->Value()) + ">");
+            } else if (elem && (field = findConfigField(elem->Value())) >= 0) {
+                DocumentSegment segment;
+                segment.kind = SegmentKind::CONFIG;
+                segment.field = field;
+                segment.text = printNode(node);
+                skeleton.push_back(std::move(segment));
+            } else {
+                raw(printNode(node));
+            }
+            raw(newline);
         }
-        if (!hotseat) return;
-        const tinyxml2::XMLElement* item = hotseat->FirstChildElement();
-        while (item) {
-            Item parsedItem = parseItem(item);
-            hotseatItems.push_back(parsedItem);
-            item = item->NextSiblingElement();
+    }
+
+    // ===== 流式模式：直接由记号构建项目，不生成DOM =====
+
+    // 字符串属性直接从源文本驻留，只有含实体时才先解码
+    uint32_t internText(const detail::XmlAttribute& attr) {
+        if (!attr.hasEntity) return stringPool->intern(attr.value);
+        decoded.clear();
+        detail::appendDecoded(attr.value, decoded);
+        return stringPool->intern(decoded);
+    }
+
+    void assignItemAttribute(ItemRecord& item, std::string_view element, const detail::XmlAttribute& attr) {
+        const detail::AttributeDesc* desc = detail::findItemAttribute(attr.name);
+        if (!desc) return;
+        item.attributeMask |= desc->bit;
+        if (desc->type == detail::AttributeType::STRING) {
+            item.*desc->idMember = internText(attr);
+        } else if (!decodeAttribute(item, *desc, attr.value)) {
+            diagnose(element, attr.name, attr.value, streamLine(attr.value.data()));
         }
     }
-    
-    void parseHomeOnlySection(const tinyxml2::XMLElement* node) {
-        const tinyxml2::XMLElement* homeOnly = nullptr;
-        if (node && std::string(node->Value()) == "homeOnly") {
-            homeOnly = node;
-        } else if (node) {
-            homeOnly = node->FirstChildElement("homeOnly");
+
+    // childFormat非空时，记录第一个文件夹内的空白格式，随后置空
+    bool readItem(detail::XmlReader& reader, const detail::XmlToken& start, ItemRecord& item,
+                         DocumentSegment*& childFormat) {
+        item.type = itemTypeFromTag(start.name);
+        for (const auto& attr : reader.attributes()) {
+            assignItemAttribute(item, start.name, attr);
         }
-        if (!homeOnly) return;
-        const tinyxml2::XMLElement* item = homeOnly->FirstChildElement();
-        while (item) {
-            Item parsedItem = parseItem(item);
-            homeOnlyItems[parsedItem.screen].push_back(parsedItem);
-            item = item->NextSiblingElement();
+        if (start.selfClosing) return true;
+        if (item.type != ItemType::FOLDER) return detail::skipElement(reader);
+
+        // 解析文件夹内的favorites
+        detail::XmlToken token;
+        std::string_view pending;
+        while (reader.next(token)) {
+            if (token.type == detail::XmlTokenType::Text) {
+                pending = token.text;
+                continue;
+            }
+            if (token.type == detail::XmlTokenType::EndElement) {
+                if (childFormat && !item.favorites.empty()) {
+                    childFormat->childCloseSeparator.assign(pending.data(), pending.size());
+                    childFormat = nullptr;
+                }
+                return token.name == start.name;
+            }
+            if (token.type != detail::XmlTokenType::StartElement) continue;
+            if (token.name == "favorite") {
+                if (childFormat && item.favorites.empty()) {
+                    childFormat->childSeparator.assign(pending.data(), pending.size());
+                }
+                // 直接在文件夹的列表中构建，不经过临时对象
+                DocumentSegment* noFormat = nullptr;
+                if (!readItem(reader, token, item.favorites.emplace_back(), noFormat)) return false;
+            } else if (!token.selfClosing && !detail::skipElement(reader)) {
+                return false;
+            }
+            pending = std::string_view();
         }
+        return false;
     }
-    
-    void parseAppOrderSection(const tinyxml2::XMLElement* node) {
-        const tinyxml2::XMLElement* appOrder = nullptr;
-        if (node && std::string(node->Value()) == "appOrder") {
-            appOrder = node;
-        } else if (node) {
-            appOrder = node->FirstChildElement("appOrder");
+
+    template <typename Sink>
+    bool readSectionItems(detail::XmlReader& reader, const detail::XmlToken& start,
+                                 DocumentSegment& format, Sink sink) {
+        if (start.selfClosing) return true;
+        detail::XmlToken token;
+        std::string_view pending;
+        bool first = true;
+        DocumentSegment* childFormat = &format;
+        while (reader.next(token)) {
+            if (token.type == detail::XmlTokenType::Text) {
+                pending = token.text;
+                continue;
+            }
+            if (token.type == detail::XmlTokenType::EndElement) {
+                format.closeSeparator.assign(pending.data(), pending.size());
+                if (first) format.itemSeparator = format.closeSeparator;
+                if (childFormat) {
+                    format.childSeparator = format.itemSeparator;
+                    format.childCloseSeparator = format.closeSeparator;
+                }
+                return token.name == start.name;
+            }
+            if (token.type != detail::XmlTokenType::StartElement) continue;
+            if (first) {
+                format.itemSeparator.assign(pending.data(), pending.size());
+                first = false;
+            }
+            pending = std::string_view();
+            ItemRecord parsedItem(itemAllocator());
+            if (!readItem(reader, token, parsedItem, childFormat)) return false;
+            sink(parsedItem);
         }
-        if (!appOrder) return;
-        const tinyxml2::XMLElement* item = appOrder->FirstChildElement();
-        while (item) {
-            Item parsedItem = parseItem(item);
-            appOrderItems.push_back(parsedItem);
-            item = item->NextSiblingElement();
+        return false;
+    }
+
+    // walkDocument回调
+    bool isSection(std::string_view tag) const {
+        LayoutArea area;
+        return findSectionArea(tag, area);
+    }
+
+    bool readSection(detail::XmlReader& reader, const detail::XmlToken& start) {
+        LayoutArea area;
+        findSectionArea(start.name, area);
+        DocumentSegment segment = sectionSegment(area);
+        segment.selfClosing = start.selfClosing;
+        if (!(loadSections & sectionBit(area)) && !start.selfClosing) {
+            // 只确定区域的范围，不切分属性、不构建Item，原文留到首次访问时解析
+            if (!reader.skipElement(start.name)) return false;
+            segment.source.assign(reader.data() + start.begin, reader.offset() - start.begin);
+            segment.sourceLine = reader.lineAt(start.begin);
+            pendingSections |= sectionBit(area);
+            skeleton.push_back(std::move(segment));
+            return true;
         }
+        const bool ok = readSectionItems(reader, start, segment,
+                                         [this, area](ItemRecord& item) { storeItem(area, item); });
+        segment.source.assign(reader.data() + start.begin, reader.offset() - start.begin);
+        skeleton.push_back(std::move(segment));
+        return ok;
+    }
+
+    bool configValue(std::string_view tag, const std::string& text, std::string_view source) {
+        const int field = findConfigField(tag);
+        if (field < 0) return false;
+        if (!applyConfigField(layoutConfig, field, text)) diagnose(tag, "", text, streamLine(source.data()));
+        DocumentSegment segment;
+        segment.kind = SegmentKind::CONFIG;
+        segment.field = field;
+        segment.text.assign(source.data(), source.size());
+        skeleton.push_back(std::move(segment));
+        return true;
+    }
+
+    void raw(std::string_view source) {
+        if (skeleton.empty() || skeleton.back().kind != SegmentKind::RAW) skeleton.emplace_back();
+        skeleton.back().text.append(source.data(), source.size());
+    }
+
+    bool loadStreaming(const char* data, size_t size, unsigned int sections) {
+        // 沿用源文件的换行风格
+        const void* lf = std::memchr(data, '\n', size);
+        if (lf && lf != data && static_cast<const char*>(lf)[-1] == '\r') newline = "\r\n";
+
+        detail::XmlReader reader(data, size);
+        std::string error;
+        streamReader = &reader;
+        loadSections = sections;
+        const bool ok = detail::walkDocument(reader, *this, error);
+        streamReader = nullptr;
+        loadSections = SECTION_ALL;
+        if (!ok) return fail("Error parsing XML: " + error);
+        loadedConfig = layoutConfig;
+        return true;
     }
 };
 
 // EXMLParser实现
 EXMLParser::EXMLParser() : pImpl(std::make_unique<EXMLParserImpl>()) {}
 
+EXMLParser::EXMLParser(AllocationMode mode) : pImpl(std::make_unique<EXMLParserImpl>(mode)) {}
+
+EXMLParser::EXMLParser(std::pmr::memory_resource* resource)
+    : pImpl(std::make_unique<EXMLParserImpl>(resource ? resource : std::pmr::get_default_resource())) {}
+
 EXMLParser::~EXMLParser() = default;
 
 bool EXMLParser::loadFromFile(const std::string& filePath) {
-    tinyxml2::XMLDocument doc;
-    if (doc.LoadFile(filePath.c_str()) != tinyxml2::XML_SUCCESS) {
-        std::cerr << "Failed to load XML file: " << filePath << std::endl;
-        return false;
+    return loadFromFile(filePath, LoadOptions());
+}
+
+bool EXMLParser::loadFromFile(const std::string& filePath, const LoadOptions& options) {
+    if (options.mode == LoadMode::DOM) {
+        tinyxml2::XMLDocument& doc = reusableDocument();
+        pImpl->resetContent();
+        pImpl->lastError.clear();
+        bool ok = doc.LoadFile(filePath.c_str()) == tinyxml2::XML_SUCCESS
+                      ? pImpl->loadDocument(doc)
+                      : pImpl->fail("Failed to load XML file: " + filePath);
+        doc.Clear();
+        if (!ok) pImpl->resetContent();
+        return ok;
     }
-    
-    // 兼容无根节点的情况：遍历所有顶层元素
-    try {
-        // 清空现有数据
-        pImpl->homeItems.clear();
-        pImpl->hotseatItems.clear();
-        pImpl->homeOnlyItems.clear();
-        pImpl->appOrderItems.clear();
-        pImpl->hotseatHomeOnlyItems.clear();
-
-        // 先尝试用RootElement（有根节点时）
-        const tinyxml2::XMLElement* root = doc.RootElement();
-        if (root && root->FirstChildElement()) {
-            // 如果根节点下有子节点，遍历所有子节点
-            for (const tinyxml2::XMLElement* elem = root->FirstChildElement(); elem; elem = elem->NextSiblingElement()) {
-                std::string tag = elem->Value();
-                if (tag == "home") pImpl->parseHomeSection(root);
-                else if (tag == "hotseat") pImpl->parseHotseatSection(root);
-                else if (tag == "homeOnly") pImpl->parseHomeOnlySection(root);
-                else if (tag == "appOrder") pImpl->parseAppOrderSection(root);
-            }
-            // 配置解析依然用root
-            pImpl->parseLayoutConfig(root);
-        } else {
-            // 无根节点时，遍历所有顶层元素
-            for (const tinyxml2::XMLNode* node = doc.FirstChild(); node; node = node->NextSibling()) {
-                const tinyxml2::XMLElement* elem = node->ToElement();
-                if (!elem) continue;
-                std::string tag = elem->Value();
-                if (tag == "home") pImpl->parseHomeSection(elem);
-                else if (tag == "hotseat") pImpl->parseHotseatSection(elem);
-                else if (tag == "homeOnly") pImpl->parseHomeOnlySection(elem);
-                else if (tag == "appOrder") pImpl->parseAppOrderSection(elem);
-                // 配置项只需解析一次
-                if (tag == "category") pImpl->parseLayoutConfig(elem);
-            }
-        }
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error parsing XML: " << e.what() << std::endl;
+
+    std::string buffer;
+    if (!readFileContents(filePath, buffer)) {
+        pImpl->resetContent();
+        return pImpl->fail("Failed to load XML file: " + filePath);
+    }
+    return loadFromMemory(buffer.data(), buffer.size(), options);
+}
+
+bool EXMLParser::loadFromMemory(const char* data, size_t size, const LoadOptions& options) {
+    pImpl->resetContent();
+    pImpl->lastError.clear();
+    if (options.mode == LoadMode::DOM) {
+        tinyxml2::XMLDocument& doc = reusableDocument();
+        bool ok = doc.Parse(data, size) == tinyxml2::XML_SUCCESS
+                      ? pImpl->loadDocument(doc)
+                      : pImpl->fail(std::string("Failed to parse XML: ") + doc.ErrorStr());
+        doc.Clear();
+        if (!ok) pImpl->resetContent();
+        return ok;
+    }
+
+    if (!pImpl->loadStreaming(data, size, options.sections)) {
+        pImpl->resetContent();
         return false;
     }
+    return true;
+}
+
+const std::string& EXMLParser::getLastError() const {
+    return pImpl->lastError;
+}
+
+const std::vector<ParseDiagnostic>& EXMLParser::getDiagnostics() const {
+    return pImpl->diagnostics;
+}
+
+bool EXMLParser::isSectionLoaded(LayoutArea area) const {
+    return !(pImpl->pendingSections & EXMLParserImpl::sectionBit(area));
+}
+
+bool EXMLParser::isSectionModified(LayoutArea area) const {
+    return (pImpl->dirtySections & EXMLParserImpl::sectionBit(area)) != 0;
 }
 
 bool EXMLParser::saveToFile(const std::string& filePath) {
-    // TODO: 实现XML生成功能
-    return false;
+    std::string output;
+    saveToString(output);
+    return writeFileContents(filePath, output);
+}
+
+bool EXMLParser::saveSnapshot(const std::string& filePath) const {
+    std::string output;
+    saveSnapshotToString(output);
+    return writeFileContents(filePath, output);
+}
+
+void EXMLParser::saveSnapshotToString(std::string& output) const {
+    pImpl->ensureAllSections();
+    output.clear();
+    writeSnapshot(*pImpl, output);
+}
+
+bool EXMLParser::loadSnapshot(const std::string& filePath) {
+    std::string buffer;
+    if (!readFileContents(filePath, buffer)) {
+        pImpl->resetContent();
+        return pImpl->fail("Failed to load snapshot file: " + filePath);
+    }
+    return loadSnapshotFromMemory(buffer.data(), buffer.size());
+}
+
+bool EXMLParser::loadSnapshotFromMemory(const char* data, size_t size) {
+    pImpl->resetContent();
+    pImpl->lastError.clear();
+    std::string error;
+    if (!readSnapshot(data, size, *pImpl, error)) {
+        pImpl->resetContent();
+        return pImpl->fail(error);
+    }
+    return true;
+}
+
+void addItemToArea(EXMLParser& parser, LayoutArea area, int page, const Item& item) {
+    switch (area) {
+        case LayoutArea::HOME: parser.addHomeItem(page, item); break;
+        case LayoutArea::HOTSEAT: parser.addHotseatItem(item); break;
+        case LayoutArea::HOME_ONLY: parser.addHomeOnlyItem(page, item); break;
+        case LayoutArea::HOTSEAT_HOME_ONLY: parser.addHotseatHomeOnlyItem(item); break;
+        case LayoutArea::APP_ORDER: parser.addAppOrderItem(item); break;
+    }
+}
+
+const LayoutModel& layoutOf(const EXMLParser& parser) {
+    parser.pImpl->ensureAllSections();
+    return *parser.pImpl;
+}
+
+void prepareForSharing(EXMLParser& parser) {
+    parser.pImpl->buildLazyState();
+}
+
+LayoutModel& editableModel(EXMLParser& parser, LayoutArea area) {
+    parser.pImpl->ensureSection(area);
+    return *parser.pImpl;
+}
+
+size_t lazyStateMemory(const EXMLParser& parser) {
+    const EXMLParserImpl& impl = *parser.pImpl;
+    size_t bytes = impl.homeGrid.memoryUsage() + impl.homeOnlyGrid.memoryUsage();
+    for (const ItemIndex* index : {&impl.homeIndex, &impl.hotseatIndex, &impl.homeOnlyIndex,
+                                   &impl.hotseatHomeOnlyIndex, &impl.appOrderIndex}) {
+        bytes += index->memoryUsage();
+    }
+    for (const AreaFingerprint* fingerprint : {&impl.homeFingerprint, &impl.hotseatFingerprint,
+                                               &impl.homeOnlyFingerprint, &impl.hotseatHomeOnlyFingerprint,
+                                               &impl.appOrderFingerprint}) {
+        bytes += fingerprint->memoryUsage();
+    }
+    return bytes;
+}
+
+void copyLayout(const EXMLParser& from, EXMLParser& to) {
+    from.pImpl->ensureAllSections();
+    const EXMLParserImpl& source = *from.pImpl;
+    EXMLParserImpl& target = *to.pImpl;
+    target.resetContent();
+    target.lastError.clear();
+    target.layoutConfig = source.layoutConfig;
+    target.loadedConfig = source.loadedConfig;
+    target.skeleton = source.skeleton;
+    target.newline = source.newline;
+    target.dirtySections = source.dirtySections;
+    // 容器赋值时保留目标的分配器，逐项复制
+    target.homeItems = source.homeItems;
+    target.hotseatItems = source.hotseatItems;
+    target.homeOnlyItems = source.homeOnlyItems;
+    target.hotseatHomeOnlyItems = source.hotseatHomeOnlyItems;
+    target.appOrderItems = source.appOrderItems;
+    if (source.stringPool == target.stringPool) return;
+    EXMLParserImpl::remapItems(target.homeItems, *source.stringPool, *target.stringPool);
+    EXMLParserImpl::remapItems(target.hotseatItems, *source.stringPool, *target.stringPool);
+    EXMLParserImpl::remapItems(target.homeOnlyItems, *source.stringPool, *target.stringPool);
+    EXMLParserImpl::remapItems(target.hotseatHomeOnlyItems, *source.stringPool, *target.stringPool);
+    EXMLParserImpl::remapItems(target.appOrderItems, *source.stringPool, *target.stringPool);
+}
+
+void areaEdited(EXMLParser& parser, LayoutArea area) {
+    parser.pImpl->invalidateArea(area);
+    parser.pImpl->dirtySections |= EXMLParserImpl::sectionBit(area);
+}
+
+void EXMLParser::saveToString(std::string& output) const {
+    // 推迟解析的区域未被修改，直接输出原文，无需解析
+    output.clear();
+    writeDocument(*pImpl, output);
 }
 
 const LayoutConfig& EXMLParser::getLayoutConfig() const {
@@ -308,228 +1124,395 @@ const LayoutConfig& EXMLParser::getLayoutConfig() const {
 }
 
 void EXMLParser::setLayoutConfig(const LayoutConfig& config) {
+    // 行列数变化后占用表需要按新尺寸重建
+    if (config.rows != pImpl->layoutConfig.rows || config.columns != pImpl->layoutConfig.columns) {
+        pImpl->homeGrid.invalidate();
+        pImpl->homeOnlyGrid.invalidate();
+    }
     pImpl->layoutConfig = config;
 }
 
 // Home区域操作
 size_t EXMLParser::getHomePageCount() const {
+    pImpl->ensureSection(LayoutArea::HOME);
     return pImpl->homeItems.size();
 }
 
 std::vector<Item> EXMLParser::getHomeItems(int pageIndex) const {
+    pImpl->ensureSection(LayoutArea::HOME);
     auto it = pImpl->homeItems.find(pageIndex);
-    return it != pImpl->homeItems.end() ? it->second : std::vector<Item>();
+    return it != pImpl->homeItems.end() ? pImpl->copyItems(it->second) : std::vector<Item>();
 }
 
 bool EXMLParser::addHomeItem(int pageIndex, const Item& item) {
-    pImpl->homeItems[pageIndex].push_back(item);
+    pImpl->ensureSection(LayoutArea::HOME);
+    pImpl->addItem(pImpl->homeItems, pImpl->homeIndex, pImpl->homeFingerprint, pageIndex, item,
+                   &pImpl->homeGrid);
+    pImpl->markEdited(LayoutArea::HOME);
     return true;
 }
 
+bool EXMLParser::addHomeItem(int pageIndex, Item&& item) {
+    return addHomeItem(pageIndex, item);
+}
+
 bool EXMLParser::removeHomeItem(int pageIndex, const std::string& packageName, const std::string& className) {
-    auto it = pImpl->homeItems.find(pageIndex);
-    if (it == pImpl->homeItems.end()) return false;
-    
-    auto& items = it->second;
-    auto itemIt = std::find_if(items.begin(), items.end(),
-        [&](const Item& item) {
-            return item.packageName == packageName && item.className == className;
-        });
-    
-    if (itemIt != items.end()) {
-        items.erase(itemIt);
-        return true;
-    }
-    return false;
+    pImpl->ensureSection(LayoutArea::HOME);
+    if (pImpl->homeItems.find(pageIndex) == pImpl->homeItems.end()) return false;
+    const bool removed = pImpl->removeItem(pImpl->homeItems, pImpl->homeIndex, pImpl->homeFingerprint, pageIndex,
+                                           packageName, className, &pImpl->homeGrid);
+    if (removed) pImpl->markEdited(LayoutArea::HOME);
+    return removed;
 }
 
 bool EXMLParser::moveHomeItem(int fromPage, int fromIndex, int toPage, int toIndex) {
+    pImpl->ensureSection(LayoutArea::HOME);
     auto fromIt = pImpl->homeItems.find(fromPage);
     auto toIt = pImpl->homeItems.find(toPage);
     
-    if (fromIt == pImpl->homeItems.end() || fromIndex >= fromIt->second.size()) return false;
-    
-    Item item = fromIt->second[fromIndex];
-    fromIt->second.erase(fromIt->second.begin() + fromIndex);
-    
-    if (toIndex > toIt->second.size()) toIndex = toIt->second.size();
-    toIt->second.insert(toIt->second.begin() + toIndex, item);
+    if (fromIt == pImpl->homeItems.end() || toIt == pImpl->homeItems.end()) return false;
+    if (fromIndex < 0 || fromIndex >= static_cast<int>(fromIt->second.size()) || toIndex < 0) return false;
     
+    pImpl->moveItem(pImpl->homeIndex, pImpl->homeFingerprint, fromIt->second, fromPage, fromIndex,
+                             toIt->second, toPage, toIndex, &pImpl->homeGrid);
+    pImpl->markEdited(LayoutArea::HOME);
     return true;
 }
 
 std::vector<Item> EXMLParser::findHomeItems(const std::string& packageName) const {
-    std::vector<Item> result;
-    for (const auto& page : pImpl->homeItems) {
-        for (const auto& item : page.second) {
-            if (item.packageName == packageName) {
-                result.push_back(item);
-            }
-        }
-    }
-    return result;
+    pImpl->ensureSection(LayoutArea::HOME);
+    return pImpl->findItems(pImpl->homeItems, pImpl->homeIndex, packageName);
 }
 
 // Hotseat区域操作
 size_t EXMLParser::getHotseatItemCount() const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
     return pImpl->hotseatItems.size();
 }
 
 std::vector<Item> EXMLParser::getHotseatItems() const {
-    return pImpl->hotseatItems;
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
+    return pImpl->copyItems(pImpl->hotseatItems);
 }
 
 bool EXMLParser::addHotseatItem(const Item& item) {
-    pImpl->hotseatItems.push_back(item);
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
+    pImpl->addItem(pImpl->hotseatItems, pImpl->hotseatIndex, pImpl->hotseatFingerprint, 0, item);
+    pImpl->markEdited(LayoutArea::HOTSEAT);
     return true;
 }
 
+bool EXMLParser::addHotseatItem(Item&& item) {
+    return addHotseatItem(item);
+}
+
 bool EXMLParser::removeHotseatItem(const std::string& packageName, const std::string& className) {
-    auto it = std::find_if(pImpl->hotseatItems.begin(), pImpl->hotseatItems.end(),
-        [&](const Item& item) {
-            return item.packageName == packageName && item.className == className;
-        });
-    
-    if (it != pImpl->hotseatItems.end()) {
-        pImpl->hotseatItems.erase(it);
-        return true;
-    }
-    return false;
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
+    const bool removed = pImpl->removeItem(pImpl->hotseatItems, pImpl->hotseatIndex, pImpl->hotseatFingerprint, 0,
+                                           packageName, className);
+    if (removed) pImpl->markEdited(LayoutArea::HOTSEAT);
+    return removed;
 }
 
 bool EXMLParser::moveHotseatItem(int fromIndex, int toIndex) {
-    if (fromIndex >= pImpl->hotseatItems.size() || toIndex > pImpl->hotseatItems.size()) return false;
-    
-    Item item = pImpl->hotseatItems[fromIndex];
-    pImpl->hotseatItems.erase(pImpl->hotseatItems.begin() + fromIndex);
-    pImpl->hotseatItems.insert(pImpl->hotseatItems.begin() + toIndex, item);
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
+    auto& items = pImpl->hotseatItems;
+    if (fromIndex < 0 || fromIndex >= static_cast<int>(items.size()) ||
+        toIndex < 0 || toIndex > static_cast<int>(items.size())) return false;
     
+    pImpl->moveItem(pImpl->hotseatIndex, pImpl->hotseatFingerprint, items, 0, fromIndex, items, 0, toIndex);
+    pImpl->markEdited(LayoutArea::HOTSEAT);
     return true;
 }
 
 std::vector<Item> EXMLParser::findHotseatItems(const std::string& packageName) const {
-    std::vector<Item> result;
-    for (const auto& item : pImpl->hotseatItems) {
-        if (item.packageName == packageName) {
-            result.push_back(item);
-        }
-    }
-    return result;
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
+    return pImpl->findItems(pImpl->hotseatItems, pImpl->hotseatIndex, packageName);
 }
 
 // HomeOnly区域操作
 size_t EXMLParser::getHomeOnlyPageCount() const {
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
     return pImpl->homeOnlyItems.size();
 }
 
 std::vector<Item> EXMLParser::getHomeOnlyItems(int pageIndex) const {
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
     auto it = pImpl->homeOnlyItems.find(pageIndex);
-    return it != pImpl->homeOnlyItems.end() ? it->second : std::vector<Item>();
+    return it != pImpl->homeOnlyItems.end() ? pImpl->copyItems(it->second) : std::vector<Item>();
 }
 
 bool EXMLParser::addHomeOnlyItem(int pageIndex, const Item& item) {
-    pImpl->homeOnlyItems[pageIndex].push_back(item);
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
+    pImpl->addItem(pImpl->homeOnlyItems, pImpl->homeOnlyIndex, pImpl->homeOnlyFingerprint, pageIndex, item,
+                   &pImpl->homeOnlyGrid);
+    pImpl->markEdited(LayoutArea::HOME_ONLY);
     return true;
 }
 
+bool EXMLParser::addHomeOnlyItem(int pageIndex, Item&& item) {
+    return addHomeOnlyItem(pageIndex, item);
+}
+
 bool EXMLParser::removeHomeOnlyItem(int pageIndex, const std::string& packageName, const std::string& className) {
-    auto it = pImpl->homeOnlyItems.find(pageIndex);
-    if (it == pImpl->homeOnlyItems.end()) return false;
-    
-    auto& items = it->second;
-    auto itemIt = std::find_if(items.begin(), items.end(),
-        [&](const Item& item) {
-            return item.packageName == packageName && item.className == className;
-        });
-    
-    if (itemIt != items.end()) {
-        items.erase(itemIt);
-        return true;
-    }
-    return false;
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
+    if (pImpl->homeOnlyItems.find(pageIndex) == pImpl->homeOnlyItems.end()) return false;
+    const bool removed = pImpl->removeItem(pImpl->homeOnlyItems, pImpl->homeOnlyIndex, pImpl->homeOnlyFingerprint,
+                                           pageIndex, packageName, className, &pImpl->homeOnlyGrid);
+    if (removed) pImpl->markEdited(LayoutArea::HOME_ONLY);
+    return removed;
 }
 
 bool EXMLParser::moveHomeOnlyItem(int fromPage, int fromIndex, int toPage, int toIndex) {
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
     auto fromIt = pImpl->homeOnlyItems.find(fromPage);
     auto toIt = pImpl->homeOnlyItems.find(toPage);
     
-    if (fromIt == pImpl->homeOnlyItems.end() || fromIndex >= fromIt->second.size()) return false;
-    
-    Item item = fromIt->second[fromIndex];
-    fromIt->second.erase(fromIt->second.begin() + fromIndex);
-    
-    if (toIndex > toIt->second.size()) toIndex = toIt->second.size();
-    toIt->second.insert(toIt->second.begin() + toIndex, item);
+    if (fromIt == pImpl->homeOnlyItems.end() || toIt == pImpl->homeOnlyItems.end()) return false;
+    if (fromIndex < 0 || fromIndex >= static_cast<int>(fromIt->second.size()) || toIndex < 0) return false;
     
+    pImpl->moveItem(pImpl->homeOnlyIndex, pImpl->homeOnlyFingerprint, fromIt->second, fromPage, fromIndex,
+                             toIt->second, toPage, toIndex, &pImpl->homeOnlyGrid);
+    pImpl->markEdited(LayoutArea::HOME_ONLY);
     return true;
 }
 
 std::vector<Item> EXMLParser::findHomeOnlyItems(const std::string& packageName) const {
-    std::vector<Item> result;
-    for (const auto& page : pImpl->homeOnlyItems) {
-        for (const auto& item : page.second) {
-            if (item.packageName == packageName) {
-                result.push_back(item);
-            }
-        }
-    }
-    return result;
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
+    return pImpl->findItems(pImpl->homeOnlyItems, pImpl->homeOnlyIndex, packageName);
+}
+
+// HotseatHomeOnly区域操作
+size_t EXMLParser::getHotseatHomeOnlyItemCount() const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    return pImpl->hotseatHomeOnlyItems.size();
+}
+
+std::vector<Item> EXMLParser::getHotseatHomeOnlyItems() const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    return pImpl->copyItems(pImpl->hotseatHomeOnlyItems);
+}
+
+bool EXMLParser::addHotseatHomeOnlyItem(const Item& item) {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    pImpl->addItem(pImpl->hotseatHomeOnlyItems, pImpl->hotseatHomeOnlyIndex, pImpl->hotseatHomeOnlyFingerprint,
+                   0, item);
+    pImpl->markEdited(LayoutArea::HOTSEAT_HOME_ONLY);
+    return true;
+}
+
+bool EXMLParser::addHotseatHomeOnlyItem(Item&& item) {
+    return addHotseatHomeOnlyItem(item);
+}
+
+bool EXMLParser::removeHotseatHomeOnlyItem(const std::string& packageName, const std::string& className) {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    const bool removed = pImpl->removeItem(pImpl->hotseatHomeOnlyItems, pImpl->hotseatHomeOnlyIndex,
+                                           pImpl->hotseatHomeOnlyFingerprint, 0, packageName, className);
+    if (removed) pImpl->markEdited(LayoutArea::HOTSEAT_HOME_ONLY);
+    return removed;
+}
+
+bool EXMLParser::moveHotseatHomeOnlyItem(int fromIndex, int toIndex) {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    auto& items = pImpl->hotseatHomeOnlyItems;
+    if (fromIndex < 0 || fromIndex >= static_cast<int>(items.size()) ||
+        toIndex < 0 || toIndex > static_cast<int>(items.size())) return false;
+    
+    pImpl->moveItem(pImpl->hotseatHomeOnlyIndex, pImpl->hotseatHomeOnlyFingerprint,
+                             items, 0, fromIndex, items, 0, toIndex);
+    pImpl->markEdited(LayoutArea::HOTSEAT_HOME_ONLY);
+    return true;
+}
+
+std::vector<Item> EXMLParser::findHotseatHomeOnlyItems(const std::string& packageName) const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    return pImpl->findItems(pImpl->hotseatHomeOnlyItems, pImpl->hotseatHomeOnlyIndex, packageName);
 }
 
 // AppOrder区域操作
 size_t EXMLParser::getAppOrderItemCount() const {
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
     return pImpl->appOrderItems.size();
 }
 
 std::vector<Item> EXMLParser::getAppOrderItems() const {
-    return pImpl->appOrderItems;
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
+    return pImpl->copyItems(pImpl->appOrderItems);
 }
 
 bool EXMLParser::addAppOrderItem(const Item& item) {
-    pImpl->appOrderItems.push_back(item);
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
+    pImpl->addItem(pImpl->appOrderItems, pImpl->appOrderIndex, pImpl->appOrderFingerprint, 0, item);
+    pImpl->markEdited(LayoutArea::APP_ORDER);
     return true;
 }
 
+bool EXMLParser::addAppOrderItem(Item&& item) {
+    return addAppOrderItem(item);
+}
+
 bool EXMLParser::removeAppOrderItem(const std::string& packageName, const std::string& className) {
-    auto it = std::find_if(pImpl->appOrderItems.begin(), pImpl->appOrderItems.end(),
-        [&](const Item& item) {
-            return item.packageName == packageName && item.className == className;
-        });
-    
-    if (it != pImpl->appOrderItems.end()) {
-        pImpl->appOrderItems.erase(it);
-        return true;
-    }
-    return false;
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
+    const bool removed = pImpl->removeItem(pImpl->appOrderItems, pImpl->appOrderIndex, pImpl->appOrderFingerprint, 0,
+                                           packageName, className);
+    if (removed) pImpl->markEdited(LayoutArea::APP_ORDER);
+    return removed;
 }
 
 bool EXMLParser::moveAppOrderItem(int fromIndex, int toIndex) {
-    if (fromIndex >= pImpl->appOrderItems.size() || toIndex > pImpl->appOrderItems.size()) return false;
-    
-    Item item = pImpl->appOrderItems[fromIndex];
-    pImpl->appOrderItems.erase(pImpl->appOrderItems.begin() + fromIndex);
-    pImpl->appOrderItems.insert(pImpl->appOrderItems.begin() + toIndex, item);
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
+    auto& items = pImpl->appOrderItems;
+    if (fromIndex < 0 || fromIndex >= static_cast<int>(items.size()) ||
+        toIndex < 0 || toIndex > static_cast<int>(items.size())) return false;
     
+    pImpl->moveItem(pImpl->appOrderIndex, pImpl->appOrderFingerprint, items, 0, fromIndex, items, 0, toIndex);
+    pImpl->markEdited(LayoutArea::APP_ORDER);
     return true;
 }
 
 std::vector<Item> EXMLParser::findAppOrderItems(const std::string& packageName) const {
-    std::vector<Item> result;
-    for (const auto& item : pImpl->appOrderItems) {
-        if (item.packageName == packageName) {
-            result.push_back(item);
-        }
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
+    return pImpl->findItems(pImpl->appOrderItems, pImpl->appOrderIndex, packageName);
+}
+
+// 只读视图与位置查找
+ItemsView EXMLParser::viewHomeItems(int pageIndex) const {
+    pImpl->ensureSection(LayoutArea::HOME);
+    return pImpl->pageView(LayoutArea::HOME, pImpl->homeItems, pageIndex);
+}
+
+ItemsView EXMLParser::viewHotseatItems() const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
+    return pImpl->listView(LayoutArea::HOTSEAT, pImpl->hotseatItems);
+}
+
+ItemsView EXMLParser::viewHomeOnlyItems(int pageIndex) const {
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
+    return pImpl->pageView(LayoutArea::HOME_ONLY, pImpl->homeOnlyItems, pageIndex);
+}
+
+ItemsView EXMLParser::viewHotseatHomeOnlyItems() const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    return pImpl->listView(LayoutArea::HOTSEAT_HOME_ONLY, pImpl->hotseatHomeOnlyItems);
+}
+
+ItemsView EXMLParser::viewAppOrderItems() const {
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
+    return pImpl->listView(LayoutArea::APP_ORDER, pImpl->appOrderItems);
+}
+
+Span<ItemLocation> EXMLParser::locateHomeItems(const std::string& packageName) const {
+    pImpl->ensureSection(LayoutArea::HOME);
+    return pImpl->locateItems(pImpl->homeItems, pImpl->homeIndex, packageName);
+}
+
+Span<ItemLocation> EXMLParser::locateHotseatItems(const std::string& packageName) const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT);
+    return pImpl->locateItems(pImpl->hotseatItems, pImpl->hotseatIndex, packageName);
+}
+
+Span<ItemLocation> EXMLParser::locateHomeOnlyItems(const std::string& packageName) const {
+    pImpl->ensureSection(LayoutArea::HOME_ONLY);
+    return pImpl->locateItems(pImpl->homeOnlyItems, pImpl->homeOnlyIndex, packageName);
+}
+
+Span<ItemLocation> EXMLParser::locateHotseatHomeOnlyItems(const std::string& packageName) const {
+    pImpl->ensureSection(LayoutArea::HOTSEAT_HOME_ONLY);
+    return pImpl->locateItems(pImpl->hotseatHomeOnlyItems, pImpl->hotseatHomeOnlyIndex, packageName);
+}
+
+Span<ItemLocation> EXMLParser::locateAppOrderItems(const std::string& packageName) const {
+    pImpl->ensureSection(LayoutArea::APP_ORDER);
+    return pImpl->locateItems(pImpl->appOrderItems, pImpl->appOrderIndex, packageName);
+}
+
+ItemRef EXMLParser::getItem(const ItemLocation& location) const {
+    pImpl->ensureSection(location.area);
+    const ItemRecord* item = pImpl->itemAt(location);
+    return item ? ItemRef(item, pImpl->stringPool.get()) : ItemRef();
+}
+
+bool EXMLParser::isCellFree(LayoutArea area, int pageIndex, int x, int y) const {
+    const OccupancyGrid* grid = pImpl->ensureGrid(area);
+    return grid && grid->isCellFree(pageIndex, x, y);
+}
+
+bool EXMLParser::canPlace(LayoutArea area, int pageIndex, const Item& item) const {
+    const OccupancyGrid* grid = pImpl->ensureGrid(area);
+    return grid && grid->isFree(pageIndex, item.x, item.y, item.spanX, item.spanY);
+}
+
+bool EXMLParser::occupiedBy(LayoutArea area, int pageIndex, int x, int y, ItemLocation& location) const {
+    const OccupancyGrid* grid = pImpl->ensureGrid(area);
+    const int index = grid ? grid->occupant(pageIndex, x, y) : -1;
+    if (index < 0) return false;
+    location = ItemLocation{area, pageIndex, static_cast<size_t>(index)};
+    return true;
+}
+
+bool EXMLParser::findPlacement(LayoutArea area, int spanX, int spanY, Placement& placement,
+                               PlacementStrategy strategy) const {
+    return pImpl->findPlacement(area, spanX, spanY, strategy, placement);
+}
+
+bool EXMLParser::placeItem(LayoutArea area, const Item& item, PlacementStrategy strategy, ItemLocation* location) {
+    Placement placement;
+    if (!pImpl->findPlacement(area, item.spanX, item.spanY, strategy, placement)) return false;
+
+    Item placed = item;
+    placed.screen = placement.page;
+    placed.x = placement.x;
+    placed.y = placement.y;
+    PagedItems& pages = *pImpl->gridItems(area);
+    OccupancyGrid* grid = area == LayoutArea::HOME ? &pImpl->homeGrid : &pImpl->homeOnlyGrid;
+    ItemIndex& index = area == LayoutArea::HOME ? pImpl->homeIndex : pImpl->homeOnlyIndex;
+    AreaFingerprint& fingerprint = area == LayoutArea::HOME ? pImpl->homeFingerprint : pImpl->homeOnlyFingerprint;
+    pImpl->addItem(pages, index, fingerprint, placement.page, placed, grid);
+    pImpl->markEdited(area);
+    if (placement.page >= pImpl->layoutConfig.pageCount) pImpl->layoutConfig.pageCount = placement.page + 1;
+    if (location) *location = ItemLocation{area, placement.page, pages[placement.page].size() - 1};
+    return true;
+}
+
+Fingerprint EXMLParser::getConfigFingerprint() const {
+    return configFingerprint(pImpl->layoutConfig);
+}
+
+Fingerprint EXMLParser::getAreaFingerprint(LayoutArea area) const {
+    return pImpl->ensureFingerprint(area).area();
+}
+
+Fingerprint EXMLParser::getPageFingerprint(LayoutArea area, int pageIndex) const {
+    return pImpl->ensureFingerprint(area).page(pageIndex);
+}
+
+Fingerprint EXMLParser::getItemFingerprint(const ItemLocation& location) const {
+    pImpl->ensureSection(location.area);
+    const ItemRecord* item = pImpl->itemAt(location);
+    return item ? itemFingerprint(*item, *pImpl->stringPool) : Fingerprint();
+}
+
+Fingerprint EXMLParser::getLayoutFingerprint() const {
+    FingerprintHasher hasher;
+    hasher.add(getConfigFingerprint());
+    for (int area = 0; area < kLayoutAreaCount; ++area) {
+        hasher.add(getAreaFingerprint(static_cast<LayoutArea>(area)));
     }
-    return result;
+    return hasher.finish();
+}
+
+std::shared_ptr<StringPool> EXMLParser::getStringPool() const {
+    return pImpl->stringPool;
+}
+
+void EXMLParser::setStringPool(std::shared_ptr<StringPool> pool) {
+    // 推迟的区域尚无项目，解析时直接驻留到新的池中
+    pImpl->setStringPool(pool ? std::move(pool) : std::make_shared<StringPool>(false));
 }
 
 void EXMLParser::clear() {
-    pImpl->homeItems.clear();
-    pImpl->hotseatItems.clear();
-    pImpl->homeOnlyItems.clear();
-    pImpl->appOrderItems.clear();
-    pImpl->hotseatHomeOnlyItems.clear();
-    pImpl->layoutConfig = LayoutConfig();
+    pImpl->resetContent();
 }
 
 } // namespace exml
@@ -0,0 +1,318 @@
+#include "exml_reader.h"
+#include <cstring>
+#include <cstdint>
+
+namespace exml {
+namespace detail {
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool isNameEnd(char c) {
+    return isSpace(c) || c == '/' || c == '>' || c == '=';
+}
+
+// 在 [from, size) 中查找子串，返回其起始偏移；找不到返回size
+size_t findSequence(const char* data, size_t size, size_t from, const char* needle) {
+    const size_t len = std::strlen(needle);
+    while (from + len <= size) {
+        const void* hit = std::memchr(data + from, needle[0], size - from);
+        if (!hit) break;
+        size_t at = static_cast<const char*>(hit) - data;
+        if (at + len > size) break;
+        if (std::memcmp(data + at, needle, len) == 0) return at;
+        from = at + 1;
+    }
+    return size;
+}
+
+void appendUtf8(uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x110000) {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+XmlReader::XmlReader(const char* data, size_t size)
+    : data_(data), size_(size), pos_(0) {
+    // 跳过UTF-8 BOM
+    if (size_ >= 3 && static_cast<unsigned char>(data_[0]) == 0xEF &&
+        static_cast<unsigned char>(data_[1]) == 0xBB && static_cast<unsigned char>(data_[2]) == 0xBF) {
+        pos_ = 3;
+    }
+}
+
+bool XmlReader::fail(const char* message, size_t at) {
+    error_ = std::string(message) + " at line " + std::to_string(lineAt(at));
+    pos_ = size_;
+    return false;
+}
+
+int XmlReader::lineAt(size_t offset) const {
+    if (offset > size_) offset = size_;
+    int line = 1;
+    const char* p = data_;
+    const char* end = data_ + offset;
+    while (p < end) {
+        const void* nl = std::memchr(p, '\n', end - p);
+        if (!nl) break;
+        ++line;
+        p = static_cast<const char*>(nl) + 1;
+    }
+    return line;
+}
+
+bool XmlReader::next(XmlToken& token) {
+    attributes_.clear();
+    token.selfClosing = false;
+    token.cdata = false;
+    token.name = std::string_view();
+    token.text = std::string_view();
+
+    if (pos_ >= size_) {
+        token.type = failed() ? XmlTokenType::Error : XmlTokenType::End;
+        token.begin = token.end = size_;
+        return false;
+    }
+
+    token.begin = pos_;
+    if (data_[pos_] != '<') {
+        const void* lt = std::memchr(data_ + pos_, '<', size_ - pos_);
+        size_t stop = lt ? static_cast<size_t>(static_cast<const char*>(lt) - data_) : size_;
+        token.type = XmlTokenType::Text;
+        token.text = std::string_view(data_ + pos_, stop - pos_);
+        token.end = pos_ = stop;
+        return true;
+    }
+
+    const size_t remaining = size_ - pos_;
+    const char* p = data_ + pos_;
+    if (remaining >= 2 && p[1] == '?') {
+        return readMarkup(token, "?>", 2);
+    }
+    if (remaining >= 4 && std::memcmp(p, "<!--", 4) == 0) {
+        return readMarkup(token, "-->", 3);
+    }
+    if (remaining >= 9 && std::memcmp(p, "<![CDATA[", 9) == 0) {
+        size_t close = findSequence(data_, size_, pos_ + 9, "]]>");
+        if (close == size_) return fail("Unterminated CDATA section", pos_);
+        token.type = XmlTokenType::Text;
+        token.cdata = true;
+        token.text = std::string_view(data_ + pos_ + 9, close - pos_ - 9);
+        token.end = pos_ = close + 3;
+        return true;
+    }
+    if (remaining >= 2 && p[1] == '!') {
+        // DOCTYPE等：允许内部子集中的方括号
+        int bracket = 0;
+        for (size_t i = pos_ + 2; i < size_; ++i) {
+            char c = data_[i];
+            if (c == '[') ++bracket;
+            else if (c == ']') --bracket;
+            else if (c == '>' && bracket <= 0) {
+                token.type = XmlTokenType::Other;
+                token.text = std::string_view(data_ + pos_, i + 1 - pos_);
+                token.end = pos_ = i + 1;
+                return true;
+            }
+        }
+        return fail("Unterminated declaration", pos_);
+    }
+    if (remaining >= 2 && p[1] == '/') {
+        return readEndElement(token);
+    }
+    return readStartElement(token);
+}
+
+bool XmlReader::readMarkup(XmlToken& token, const char* terminator, size_t skip) {
+    size_t close = findSequence(data_, size_, pos_ + 2, terminator);
+    if (close == size_) return fail("Unterminated markup", pos_);
+    token.type = XmlTokenType::Other;
+    token.text = std::string_view(data_ + pos_, close + skip - pos_);
+    token.end = pos_ = close + skip;
+    return true;
+}
+
+bool XmlReader::readEndElement(XmlToken& token) {
+    const size_t start = pos_;
+    size_t i = pos_ + 2;
+    size_t nameBegin = i;
+    while (i < size_ && !isNameEnd(data_[i])) ++i;
+    if (i == nameBegin) return fail("Empty end tag name", start);
+    token.name = std::string_view(data_ + nameBegin, i - nameBegin);
+    while (i < size_ && isSpace(data_[i])) ++i;
+    if (i >= size_ || data_[i] != '>') return fail("Malformed end tag", start);
+    token.type = XmlTokenType::EndElement;
+    token.end = pos_ = i + 1;
+    return true;
+}
+
+bool XmlReader::readStartElement(XmlToken& token) {
+    const size_t start = pos_;
+    size_t i = pos_ + 1;
+    size_t nameBegin = i;
+    while (i < size_ && !isNameEnd(data_[i])) ++i;
+    if (i == nameBegin) return fail("Empty element name", start);
+    token.name = std::string_view(data_ + nameBegin, i - nameBegin);
+
+    for (;;) {
+        while (i < size_ && isSpace(data_[i])) ++i;
+        if (i >= size_) return fail("Unterminated start tag", start);
+        char c = data_[i];
+        if (c == '>') {
+            ++i;
+            break;
+        }
+        if (c == '/') {
+            if (i + 1 >= size_ || data_[i + 1] != '>') return fail("Malformed empty element", start);
+            token.selfClosing = true;
+            i += 2;
+            break;
+        }
+
+        size_t attrBegin = i;
+        while (i < size_ && !isNameEnd(data_[i])) ++i;
+        if (i == attrBegin) return fail("Malformed attribute", i);
+        std::string_view attrName(data_ + attrBegin, i - attrBegin);
+        while (i < size_ && isSpace(data_[i])) ++i;
+        if (i >= size_ || data_[i] != '=') return fail("Attribute without value", attrBegin);
+        ++i;
+        while (i < size_ && isSpace(data_[i])) ++i;
+        if (i >= size_ || (data_[i] != '"' && data_[i] != '\'')) return fail("Attribute value not quoted", attrBegin);
+        const char quote = data_[i++];
+        const void* close = std::memchr(data_ + i, quote, size_ - i);
+        if (!close) return fail("Unterminated attribute value", attrBegin);
+        size_t valueEnd = static_cast<const char*>(close) - data_;
+        std::string_view value(data_ + i, valueEnd - i);
+        attributes_.push_back({attrName, value, std::memchr(value.data(), '&', value.size()) != nullptr});
+        i = valueEnd + 1;
+    }
+
+    token.type = XmlTokenType::StartElement;
+    token.end = pos_ = i;
+    return true;
+}
+
+bool XmlReader::skipElement(std::string_view name) {
+    const size_t start = pos_;
+    int depth = 1;
+    while (pos_ < size_) {
+        const void* lt = std::memchr(data_ + pos_, '<', size_ - pos_);
+        if (!lt) break;
+        const size_t at = static_cast<const char*>(lt) - data_;
+        const size_t remaining = size_ - at;
+        const char* p = data_ + at;
+        const char* terminator = nullptr;
+        size_t skip = 0;
+        if (remaining >= 4 && std::memcmp(p, "<!--", 4) == 0) {
+            terminator = "-->";
+            skip = 4;
+        } else if (remaining >= 9 && std::memcmp(p, "<![CDATA[", 9) == 0) {
+            terminator = "]]>";
+            skip = 9;
+        } else if (remaining >= 2 && p[1] == '?') {
+            terminator = "?>";
+            skip = 2;
+        } else if (remaining >= 2 && p[1] == '!') {
+            terminator = ">";
+            skip = 2;
+        }
+        if (terminator) {
+            const size_t close = findSequence(data_, size_, at + skip, terminator);
+            if (close == size_) return fail("Unterminated markup", at);
+            pos_ = close + std::strlen(terminator);
+            continue;
+        }
+
+        if (remaining >= 2 && p[1] == '/') {
+            if (--depth > 0) {
+                pos_ = at + 2;
+                continue;
+            }
+            pos_ = at;
+            XmlToken token;
+            if (!readEndElement(token)) return false;
+            return token.name == name || fail("Mismatched end tag", at);
+        }
+
+        // 起始标签：找到引号以外的 '>'
+        size_t i = at + 1;
+        char quote = 0;
+        for (; i < size_; ++i) {
+            const char c = data_[i];
+            if (quote) {
+                if (c == quote) quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '>') {
+                break;
+            }
+        }
+        if (i >= size_) return fail("Unterminated start tag", at);
+        if (data_[i - 1] != '/') ++depth;
+        pos_ = i + 1;
+    }
+    return fail("Unterminated element", start);
+}
+
+void appendDecoded(std::string_view raw, std::string& out) {
+    size_t i = 0;
+    while (i < raw.size()) {
+        size_t amp = raw.find('&', i);
+        if (amp == std::string_view::npos) {
+            out.append(raw.data() + i, raw.size() - i);
+            return;
+        }
+        out.append(raw.data() + i, amp - i);
+        size_t semi = raw.find(';', amp);
+        if (semi == std::string_view::npos) {
+            out.append(raw.data() + amp, raw.size() - amp);
+            return;
+        }
+        std::string_view entity = raw.substr(amp + 1, semi - amp - 1);
+        if (entity == "amp") out += '&';
+        else if (entity == "lt") out += '<';
+        else if (entity == "gt") out += '>';
+        else if (entity == "quot") out += '"';
+        else if (entity == "apos") out += '\'';
+        else if (entity.size() > 1 && entity[0] == '#') {
+            uint32_t cp = 0;
+            bool hex = entity[1] == 'x' || entity[1] == 'X';
+            for (size_t k = hex ? 2 : 1; k < entity.size(); ++k) {
+                char c = entity[k];
+                uint32_t digit;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (hex && c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (hex && c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                else { cp = 0x110000; break; }
+                cp = cp * (hex ? 16 : 10) + digit;
+                if (cp >= 0x110000) break;
+            }
+            if (cp < 0x110000) appendUtf8(cp, out);
+            else out.append(raw.data() + amp, semi + 1 - amp);
+        } else {
+            // 未知实体原样保留
+            out.append(raw.data() + amp, semi + 1 - amp);
+        }
+        i = semi + 1;
+    }
+}
+
+} // namespace detail
+} // namespace exml
@@ -0,0 +1,115 @@
+#ifndef EXML_READER_H
+#define EXML_READER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace exml {
+namespace detail {
+
+/**
+ * @brief 元素属性（值为输入缓冲区内的原始视图，未解码实体）
+ */
+struct XmlAttribute {
+    std::string_view name;
+    std::string_view value;
+    bool hasEntity;              // 值中包含 '&'，需要解码
+};
+
+/**
+ * @brief 读取器产生的记号类型
+ */
+enum class XmlTokenType {
+    StartElement,   // <tag ...> 或 <tag ... />
+    EndElement,     // </tag>
+    Text,           // 字符数据（含CDATA）
+    Other,          // 声明、注释、DOCTYPE等
+    End,            // 输入结束
+    Error           // 格式错误
+};
+
+/**
+ * @brief 单个记号
+ */
+struct XmlToken {
+    XmlTokenType type = XmlTokenType::End;
+    std::string_view name;       // 元素名（StartElement/EndElement）
+    std::string_view text;       // 文本内容（Text）
+    bool selfClosing = false;    // 是否为 <tag/> 形式
+    bool cdata = false;          // 文本是否来自CDATA（无需解码）
+    size_t begin = 0;            // 记号在输入中的起始偏移
+    size_t end = 0;              // 记号在输入中的结束偏移（不含）
+};
+
+/**
+ * @brief 轻量级拉取式XML读取器
+ *
+ * 直接在输入缓冲区上切分记号，不构建DOM，也不复制字符串；
+ * 属性列表在每次 next() 时复用，热路径上不产生堆分配。
+ * 输入缓冲区不要求以 '\0' 结尾，但必须在读取器使用期间保持有效。
+ */
+class XmlReader {
+public:
+    XmlReader(const char* data, size_t size);
+
+    /**
+     * @brief 读取下一个记号
+     * @return 读到有效记号返回true；到达结尾或出错返回false
+     */
+    bool next(XmlToken& token);
+
+    /**
+     * @brief 当前StartElement记号的属性列表
+     */
+    const std::vector<XmlAttribute>& attributes() const { return attributes_; }
+
+    bool failed() const { return !error_.empty(); }
+    const std::string& errorMessage() const { return error_; }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t offset() const { return pos_; }
+
+    /**
+     * @brief 跳过当前元素（起始标签已读取）的内容与结束标签
+     *
+     * 只识别标签边界、引号、注释与CDATA，不切分属性、不解码文本，比逐个读取记号快得多；
+     * 子树内的格式错误（如属性缺少等号）不会被发现。
+     * @param name 当前元素名，用于核对结束标签
+     */
+    bool skipElement(std::string_view name);
+
+    /**
+     * @brief 将读取位置移动到指定偏移（需位于记号边界）
+     */
+    void seek(size_t offset) { pos_ = offset < size_ ? offset : size_; }
+
+    /**
+     * @brief 计算偏移量所在的行号（从1开始），仅在报告错误时使用
+     */
+    int lineAt(size_t offset) const;
+
+private:
+    bool fail(const char* message, size_t at);
+    bool readMarkup(XmlToken& token, const char* terminator, size_t skip);
+    bool readEndElement(XmlToken& token);
+    bool readStartElement(XmlToken& token);
+
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+    std::vector<XmlAttribute> attributes_;
+    std::string error_;
+};
+
+/**
+ * @brief 解码XML预定义实体与字符引用，结果追加到out
+ */
+void appendDecoded(std::string_view raw, std::string& out);
+
+} // namespace detail
+} // namespace exml
+
+#endif // EXML_READER_H
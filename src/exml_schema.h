@@ -0,0 +1,116 @@
+#ifndef EXML_SCHEMA_H
+#define EXML_SCHEMA_H
+
+#include "exml_model.h"
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace exml {
+namespace detail {
+
+enum class AttributeType {
+    STRING,
+    INT,
+    BOOL    // 读取true/false/1/0，按1/0写出
+};
+
+/**
+ * @brief 项目属性描述：属性名、值类型，以及在Item与ItemRecord中对应的成员
+ *
+ * 字符串属性在ItemRecord中为字符串池ID。默认值取自Item的构造函数
+ * （与ItemRecord的成员初始值相同），不在表中重复。
+ */
+struct AttributeDesc {
+    std::string_view name;
+    ItemAttribute bit;
+    AttributeType type;
+    std::string Item::* stringMember;
+    int Item::* intMember;
+    bool Item::* boolMember;
+    uint32_t ItemRecord::* idMember;
+    int ItemRecord::* recordIntMember;
+    bool ItemRecord::* recordBoolMember;
+};
+
+constexpr AttributeDesc stringAttribute(std::string_view name, ItemAttribute bit, std::string Item::* member,
+                                        uint32_t ItemRecord::* idMember) {
+    return {name, bit, AttributeType::STRING, member, nullptr, nullptr, idMember, nullptr, nullptr};
+}
+
+constexpr AttributeDesc intAttribute(std::string_view name, ItemAttribute bit, int Item::* member,
+                                     int ItemRecord::* recordMember) {
+    return {name, bit, AttributeType::INT, nullptr, member, nullptr, nullptr, recordMember, nullptr};
+}
+
+constexpr AttributeDesc boolAttribute(std::string_view name, ItemAttribute bit, bool Item::* member,
+                                      bool ItemRecord::* recordMember) {
+    return {name, bit, AttributeType::BOOL, nullptr, nullptr, member, nullptr, nullptr, recordMember};
+}
+
+// 按三星备份文件中的属性顺序排列，写出时沿用此顺序
+constexpr AttributeDesc kItemAttributes[] = {
+    intAttribute("screen", ATTR_SCREEN, &Item::screen, &ItemRecord::screen),
+    stringAttribute("packageName", ATTR_PACKAGE_NAME, &Item::packageName, &ItemRecord::packageId),
+    stringAttribute("className", ATTR_CLASS_NAME, &Item::className, &ItemRecord::classId),
+    stringAttribute("title", ATTR_TITLE, &Item::title, &ItemRecord::titleId),
+    intAttribute("options", ATTR_OPTIONS, &Item::options, &ItemRecord::options),
+    intAttribute("color", ATTR_COLOR, &Item::color, &ItemRecord::color),
+    intAttribute("x", ATTR_X, &Item::x, &ItemRecord::x),
+    intAttribute("y", ATTR_Y, &Item::y, &ItemRecord::y),
+    intAttribute("spanX", ATTR_SPAN_X, &Item::spanX, &ItemRecord::spanX),
+    intAttribute("spanY", ATTR_SPAN_Y, &Item::spanY, &ItemRecord::spanY),
+    intAttribute("appWidgetID", ATTR_APP_WIDGET_ID, &Item::appWidgetID, &ItemRecord::appWidgetID),
+    boolAttribute("hidden", ATTR_HIDDEN, &Item::hidden, &ItemRecord::hidden),
+};
+
+constexpr size_t kItemAttributeCount = sizeof(kItemAttributes) / sizeof(kItemAttributes[0]);
+
+// FNV-1a，编译期与运行期共用
+constexpr uint32_t attributeHash(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+// 开放寻址的哈希槽，槽中存放属性序号，-1为空
+constexpr size_t kAttributeSlotCount = 32;
+using AttributeSlots = std::array<int8_t, kAttributeSlotCount>;
+
+constexpr AttributeSlots buildAttributeSlots() {
+    AttributeSlots slots{};
+    for (auto& slot : slots) slot = -1;
+    for (size_t i = 0; i < kItemAttributeCount; ++i) {
+        size_t at = attributeHash(kItemAttributes[i].name) % kAttributeSlotCount;
+        while (slots[at] >= 0) at = (at + 1) % kAttributeSlotCount;
+        slots[at] = static_cast<int8_t>(i);
+    }
+    return slots;
+}
+
+constexpr AttributeSlots kAttributeSlots = buildAttributeSlots();
+
+static_assert(kItemAttributeCount < kAttributeSlotCount, "attribute hash table needs an empty slot");
+
+/**
+ * @brief 按属性名查找描述，每个属性只计算一次哈希，未知属性返回nullptr
+ */
+constexpr const AttributeDesc* findItemAttribute(std::string_view name) {
+    for (size_t at = attributeHash(name) % kAttributeSlotCount; kAttributeSlots[at] >= 0;
+         at = (at + 1) % kAttributeSlotCount) {
+        const AttributeDesc& desc = kItemAttributes[kAttributeSlots[at]];
+        if (desc.name == name) return &desc;
+    }
+    return nullptr;
+}
+
+static_assert(findItemAttribute("hidden") && findItemAttribute("hidden")->bit == ATTR_HIDDEN,
+              "attribute lookup must resolve every schema entry");
+static_assert(!findItemAttribute("unknown"), "unknown attributes must not resolve");
+
+} // namespace detail
+} // namespace exml
+
+#endif // EXML_SCHEMA_H
@@ -0,0 +1,395 @@
+#include "exml_internal.h"
+#include "exml_model.h"
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+namespace exml {
+
+// 快照格式（整数均为小端序，所有位置都是相对偏移，与加载地址无关）：
+//
+//   文件头   magic "EXMLSNAP"、u32 版本、u32 字符串数、u32 正文字节数
+//   字符串表 u32[字符串数 + 1] 的起始偏移，随后是全部字符串的字节（0号为空字符串）
+//   正文     配置与加载时配置（各为 u32 字段数 + 每字段 (元素名, 值) 两个字符串号）、
+//            换行风格、文档骨架、按LayoutArea顺序的五个区域
+//
+// 每个项目为定长记录，文件夹内的项目紧跟在文件夹记录之后。
+// 配置字段（含骨架中的配置元素）按元素名而不是序号保存，配置字段表增减字段后旧快照仍可读取。
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'X', 'M', 'L', 'S', 'N', 'A', 'P'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = sizeof(kMagic) + 3 * sizeof(uint32_t);
+
+void appendU32(std::string& out, uint32_t value) {
+    char bytes[4];
+    for (int i = 0; i < 4; ++i) bytes[i] = static_cast<char>(value >> (8 * i));
+    out.append(bytes, sizeof(bytes));
+}
+
+class SnapshotWriter {
+public:
+    SnapshotWriter(std::string& body, const StringPool& pool) : body_(body), pool_(pool) {
+        strings_.emplace_back();
+        ids_.emplace(std::string_view(), 0);
+    }
+
+    void u8(uint8_t value) { body_ += static_cast<char>(value); }
+
+    void u32(uint32_t value) { appendU32(body_, value); }
+
+    void i32(int value) { u32(static_cast<uint32_t>(value)); }
+
+    // 字符串写为字符串表中的序号，相同内容只保存一份
+    void string(std::string_view value) { u32(tableId(value)); }
+
+    // 项目中的字符串池ID，每个ID只查找一次字符串表
+    void pooledString(uint32_t id) {
+        if (id >= pooled_.size()) pooled_.resize(id + 1, StringPool::npos);
+        if (pooled_[id] == StringPool::npos) pooled_[id] = tableId(pool_.lookup(id));
+        u32(pooled_[id]);
+    }
+
+    void config(const LayoutConfig& config) {
+        std::string value;
+        u32(static_cast<uint32_t>(configFieldCount()));
+        for (int field = 0; field < configFieldCount(); ++field) {
+            value.clear();
+            appendConfigValue(config, field, value);
+            string(configFieldTag(field));
+            string(value);
+        }
+    }
+
+    void item(const ItemRecord& item, int page) {
+        u8(static_cast<uint8_t>(item.type));
+        u8(item.hidden ? 1 : 0);
+        u8(0);
+        u8(0);
+        i32(page);
+        i32(item.screen);
+        i32(item.x);
+        i32(item.y);
+        i32(item.spanX);
+        i32(item.spanY);
+        i32(item.appWidgetID);
+        i32(item.options);
+        i32(item.color);
+        u32(item.attributeMask);
+        pooledString(item.packageId);
+        pooledString(item.classId);
+        pooledString(item.titleId);
+        u32(static_cast<uint32_t>(item.favorites.size()));
+        for (const auto& child : item.favorites) {
+            this->item(child, page);
+        }
+    }
+
+    void area(const PagedItems& pages) {
+        uint32_t count = 0;
+        for (const auto& page : pages) count += static_cast<uint32_t>(page.second.size());
+        u32(count);
+        for (const auto& page : pages) {
+            for (const auto& entry : page.second) item(entry, page.first);
+        }
+    }
+
+    void area(const ItemList& items) {
+        u32(static_cast<uint32_t>(items.size()));
+        for (const auto& entry : items) item(entry, 0);
+    }
+
+    // 文件头与字符串表
+    void header(std::string& out) const {
+        out.append(kMagic, sizeof(kMagic));
+        appendU32(out, kVersion);
+        appendU32(out, static_cast<uint32_t>(strings_.size()));
+        appendU32(out, static_cast<uint32_t>(body_.size()));
+        uint32_t offset = 0;
+        for (const auto& value : strings_) {
+            appendU32(out, offset);
+            offset += static_cast<uint32_t>(value.size());
+        }
+        appendU32(out, offset);
+        for (const auto& value : strings_) out += value;
+    }
+
+private:
+    uint32_t tableId(std::string_view value) {
+        auto it = ids_.find(value);
+        if (it == ids_.end()) {
+            strings_.emplace_back(value);
+            it = ids_.emplace(strings_.back(), static_cast<uint32_t>(strings_.size() - 1)).first;
+        }
+        return it->second;
+    }
+
+    std::string& body_;
+    const StringPool& pool_;
+    std::deque<std::string> strings_;                       // deque扩容时不移动已有元素
+    std::unordered_map<std::string_view, uint32_t> ids_;    // 键引用strings_中的内容
+    std::vector<uint32_t> pooled_;                          // 字符串池ID -> 字符串表序号，npos为尚未写入
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size, StringPool& pool)
+        : data_(data), size_(size), at_(0), ok_(true), pool_(pool) {}
+
+    bool ok() const { return ok_; }
+    size_t position() const { return at_; }
+
+    const char* bytes(size_t count) {
+        if (!ok_ || count > size_ - at_) {
+            ok_ = false;
+            return nullptr;
+        }
+        const char* result = data_ + at_;
+        at_ += count;
+        return result;
+    }
+
+    uint8_t u8() {
+        const char* value = bytes(1);
+        return value ? static_cast<uint8_t>(*value) : 0;
+    }
+
+    uint32_t u32() {
+        const char* value = bytes(4);
+        if (!value) return 0;
+        uint32_t result = 0;
+        for (int i = 0; i < 4; ++i) result |= static_cast<uint32_t>(static_cast<uint8_t>(value[i])) << (8 * i);
+        return result;
+    }
+
+    int i32() { return static_cast<int>(u32()); }
+
+    bool strings(uint32_t count) {
+        const size_t tableSize = (static_cast<size_t>(count) + 1) * sizeof(uint32_t);
+        if (count == 0 || tableSize > size_ - at_) return ok_ = false;
+        std::vector<uint32_t> offsets(count + 1);
+        for (auto& offset : offsets) offset = u32();
+        const char* base = data_ + at_;
+        const uint32_t total = offsets.back();
+        if (!bytes(total)) return false;
+        strings_.resize(count);
+        poolIds_.assign(count, StringPool::npos);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > total) return ok_ = false;
+            strings_[i] = std::string_view(base + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+        return ok_;
+    }
+
+    std::string_view string() {
+        const uint32_t id = stringId();
+        return ok_ ? strings_[id] : std::string_view();
+    }
+
+    // 读取字符串并返回其在解析器字符串池中的ID，每个不同的字符串只驻留一次
+    uint32_t pooledString() {
+        const uint32_t id = stringId();
+        if (!ok_) return 0;
+        if (poolIds_[id] == StringPool::npos) poolIds_[id] = pool_.intern(strings_[id]);
+        return poolIds_[id];
+    }
+
+    void config(LayoutConfig& config) {
+        const uint32_t count = u32();
+        for (uint32_t i = 0; i < count && ok_; ++i) {
+            const std::string_view tag = string();
+            const std::string_view value = string();
+            const int field = findConfigField(tag);
+            if (field >= 0) applyConfigField(config, field, std::string(value));
+        }
+    }
+
+    // 文件夹内的应用不能再含子项（XML加载同样不产生嵌套），避免恶意数据造成无限递归
+    void item(ItemRecord& item, int& page, bool nested = false) {
+        const uint8_t type = u8();
+        if (type > static_cast<uint8_t>(ItemType::APPWIDGET)) ok_ = false;
+        item.type = static_cast<ItemType>(type);
+        item.hidden = u8() != 0;
+        u8();
+        u8();
+        page = i32();
+        item.screen = i32();
+        item.x = i32();
+        item.y = i32();
+        item.spanX = i32();
+        item.spanY = i32();
+        item.appWidgetID = i32();
+        item.options = i32();
+        item.color = i32();
+        item.attributeMask = u32();
+        item.packageId = pooledString();
+        item.classId = pooledString();
+        item.titleId = pooledString();
+        const uint32_t children = u32();
+        // 每条记录至少60字节，数量与剩余长度不符时视为损坏，避免按错误的数量分配
+        if (!ok_ || (nested && children != 0) || children > (size_ - at_) / kItemRecordSize) {
+            ok_ = false;
+            return;
+        }
+        item.favorites.resize(children);
+        int childPage = 0;
+        for (auto& child : item.favorites) {
+            this->item(child, childPage, true);
+            if (!ok_) return;
+        }
+    }
+
+    void area(PagedItems& pages) {
+        const uint32_t count = u32();
+        if (count > (size_ - at_) / kItemRecordSize) ok_ = false;
+        for (uint32_t i = 0; i < count && ok_; ++i) {
+            ItemRecord entry(pages.get_allocator());
+            int page = 0;
+            item(entry, page);
+            if (ok_) pages[page].push_back(std::move(entry));
+        }
+    }
+
+    void area(ItemList& items) {
+        const uint32_t count = u32();
+        if (count > (size_ - at_) / kItemRecordSize) ok_ = false;
+        if (ok_) items.reserve(count);
+        for (uint32_t i = 0; i < count && ok_; ++i) {
+            ItemRecord entry(items.get_allocator());
+            int page = 0;
+            item(entry, page);
+            if (ok_) items.push_back(std::move(entry));
+        }
+    }
+
+private:
+    static constexpr size_t kItemRecordSize = 60;
+
+    uint32_t stringId() {
+        const uint32_t id = u32();
+        if (id >= strings_.size()) ok_ = false;
+        return id;
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t at_;
+    bool ok_;
+    StringPool& pool_;
+    std::vector<std::string_view> strings_;
+    std::vector<uint32_t> poolIds_;
+};
+
+// skeletonOnly为true时配置写为加载时的配置，五个区域写为空
+void writeModel(const LayoutModel& model, bool skeletonOnly, std::string& out) {
+    std::string body;
+    SnapshotWriter writer(body, *model.stringPool);
+    writer.config(skeletonOnly ? model.loadedConfig : model.layoutConfig);
+    writer.config(model.loadedConfig);
+    writer.string(model.newline);
+
+    writer.u32(static_cast<uint32_t>(model.skeleton.size()));
+    for (const auto& segment : model.skeleton) {
+        writer.u8(static_cast<uint8_t>(segment.kind));
+        writer.u8(static_cast<uint8_t>(segment.area));
+        writer.u8(segment.selfClosing ? 1 : 0);
+        writer.u8(0);
+        writer.string(segment.kind == SegmentKind::CONFIG ? configFieldTag(segment.field) : "");
+        writer.string(segment.text);
+        writer.string(segment.itemSeparator);
+        writer.string(segment.closeSeparator);
+        writer.string(segment.childSeparator);
+        writer.string(segment.childCloseSeparator);
+    }
+
+    if (skeletonOnly) {
+        for (int area = 0; area < kLayoutAreaCount; ++area) writer.u32(0);
+    } else {
+        writer.area(model.homeItems);
+        writer.area(model.hotseatItems);
+        writer.area(model.homeOnlyItems);
+        writer.area(model.hotseatHomeOnlyItems);
+        writer.area(model.appOrderItems);
+    }
+
+    out.reserve(out.size() + kHeaderSize + body.size() + body.size() / 2);
+    writer.header(out);
+    out += body;
+}
+
+} // namespace
+
+void writeSnapshot(const LayoutModel& model, std::string& out) {
+    writeModel(model, false, out);
+}
+
+void writeSkeletonSnapshot(const LayoutModel& model, std::string& out) {
+    writeModel(model, true, out);
+}
+
+bool readSnapshot(const char* data, size_t size, LayoutModel& model, std::string& error) {
+    SnapshotReader reader(data, size, *model.stringPool);
+    const char* magic = reader.bytes(sizeof(kMagic));
+    if (!magic || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        error = "Not an EXML snapshot";
+        return false;
+    }
+    const uint32_t version = reader.u32();
+    if (version != kVersion) {
+        error = "Unsupported snapshot version: " + std::to_string(version);
+        return false;
+    }
+    const uint32_t stringCount = reader.u32();
+    const uint32_t bodySize = reader.u32();
+    if (!reader.strings(stringCount) || bodySize != size - reader.position()) {
+        error = "Corrupted snapshot";
+        return false;
+    }
+
+    reader.config(model.layoutConfig);
+    reader.config(model.loadedConfig);
+    model.newline = reader.string();
+
+    const uint32_t segments = reader.u32();
+    for (uint32_t i = 0; i < segments && reader.ok(); ++i) {
+        DocumentSegment segment;
+        const uint8_t kind = reader.u8();
+        const uint8_t area = reader.u8();
+        if (kind > static_cast<uint8_t>(SegmentKind::SECTION) || area >= kLayoutAreaCount) break;
+        segment.kind = static_cast<SegmentKind>(kind);
+        segment.area = static_cast<LayoutArea>(area);
+        segment.selfClosing = reader.u8() != 0;
+        reader.u8();
+        const std::string_view fieldTag = reader.string();
+        segment.text = reader.string();
+        segment.itemSeparator = reader.string();
+        segment.closeSeparator = reader.string();
+        segment.childSeparator = reader.string();
+        segment.childCloseSeparator = reader.string();
+        if (segment.kind == SegmentKind::CONFIG) {
+            // 已不存在的配置字段原样输出
+            segment.field = findConfigField(fieldTag);
+            if (segment.field < 0) segment.kind = SegmentKind::RAW;
+        }
+        model.skeleton.push_back(std::move(segment));
+    }
+    if (model.skeleton.size() != segments) {
+        error = "Corrupted snapshot";
+        return false;
+    }
+
+    reader.area(model.homeItems);
+    reader.area(model.hotseatItems);
+    reader.area(model.homeOnlyItems);
+    reader.area(model.hotseatHomeOnlyItems);
+    reader.area(model.appOrderItems);
+    if (!reader.ok() || reader.position() != size) {
+        error = "Corrupted snapshot";
+        return false;
+    }
+    return true;
+}
+
+} // namespace exml
@@ -0,0 +1,280 @@
+#include "exml_store.h"
+#include "exml_fingerprint.h"
+#include "exml_internal.h"
+#include "exml_model.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace exml {
+
+ChunkRef::ChunkRef() : area(LayoutArea::HOME), page(0) {}
+
+namespace {
+
+// 按先序（文件夹在前、其中的项目随后）收集各项目的attributeMask
+template <typename ItemT>
+void collectMasks(const ItemT& item, std::vector<unsigned int>& out) {
+    out.push_back(item.attributeMask);
+    for (const auto& child : item.favorites) collectMasks(child, out);
+}
+
+void applyMasks(Item& item, const unsigned int*& next) {
+    item.attributeMask = *next++;
+    for (auto& child : item.favorites) applyMasks(child, next);
+}
+
+} // namespace
+
+class LayoutStoreImpl {
+public:
+    // 块的内容与引用它的布局（指向layouts中的键，按存入顺序；
+    // 同一布局每引用一次记录一次，存入时连续加入，因此重复的记录总是相邻）
+    struct Chunk {
+        std::vector<Item> items;
+        std::vector<Fingerprint> itemFingerprints;   // 与items一一对应
+        std::vector<const std::string*> layouts;
+    };
+
+    struct ConfigChunk {
+        LayoutConfig config;
+        std::vector<const std::string*> layouts;
+    };
+
+    // 文档骨架：writeSkeletonSnapshot()的输出
+    struct SkeletonChunk {
+        std::string snapshot;
+        std::vector<const std::string*> layouts;
+    };
+
+    // 布局中的项目与块中保存的版本的差别，没有差别时均为空：
+    // 块指纹与页内顺序、属性是否显式写出无关，恢复时据此还原原文
+    struct Variant {
+        std::vector<uint32_t> order;        // 布局中第i个项目为块中的第order[i]个
+        std::vector<unsigned int> masks;    // 布局中各项目按先序的attributeMask
+    };
+
+    // 布局只记录所引用的块
+    struct Recipe {
+        Fingerprint config;
+        Fingerprint skeleton;
+        std::vector<ChunkRef> chunks;
+        std::vector<Variant> variants;      // 与chunks一一对应
+    };
+
+    std::unordered_map<Fingerprint, Chunk, FingerprintHash> chunks;
+    std::unordered_map<Fingerprint, ConfigChunk, FingerprintHash> configs;
+    std::unordered_map<Fingerprint, SkeletonChunk, FingerprintHash> skeletons;
+    std::unordered_map<std::string, Recipe> layouts;
+    size_t storedItems = 0;
+
+    // 释放一次引用，返回是否已无引用
+    static bool release(std::vector<const std::string*>& owners, const std::string* name) {
+        auto it = std::find(owners.begin(), owners.end(), name);
+        if (it != owners.end()) owners.erase(it);
+        return owners.empty();
+    }
+
+    void addChunk(Recipe& recipe, const std::string* name, LayoutArea area, int page, const Fingerprint& fingerprint,
+                  const ItemList& items, const StringPool& pool) {
+        std::vector<Fingerprint> itemFingerprints;
+        itemFingerprints.reserve(items.size());
+        for (const auto& item : items) itemFingerprints.push_back(itemFingerprint(item, pool));
+
+        auto inserted = chunks.try_emplace(fingerprint);
+        Chunk& chunk = inserted.first->second;
+        if (inserted.second) {
+            chunk.items.reserve(items.size());
+            for (const auto& item : items) chunk.items.push_back(makeItem(item, pool));
+            chunk.itemFingerprints = itemFingerprints;
+            storedItems += items.size();
+        }
+        chunk.layouts.push_back(name);
+
+        ChunkRef ref;
+        ref.area = area;
+        ref.page = page;
+        ref.chunk = fingerprint;
+        recipe.chunks.push_back(ref);
+        recipe.variants.push_back(variantOf(chunk, items, itemFingerprints));
+    }
+
+    static Variant variantOf(const Chunk& chunk, const ItemList& items, const std::vector<Fingerprint>& fingerprints) {
+        Variant variant;
+        if (fingerprints != chunk.itemFingerprints) {
+            // 同一页的项目数不多，逐个匹配块中尚未使用的相同项目
+            std::vector<bool> used(chunk.items.size(), false);
+            variant.order.reserve(items.size());
+            for (size_t i = 0; i < fingerprints.size(); ++i) {
+                size_t match = 0;
+                while (match < used.size() && (used[match] || chunk.itemFingerprints[match] != fingerprints[i])) {
+                    ++match;
+                }
+                if (match == used.size()) match = i;   // 仅在指纹碰撞时发生
+                used[match] = true;
+                variant.order.push_back(static_cast<uint32_t>(match));
+            }
+        }
+
+        std::vector<unsigned int> stored;
+        std::vector<unsigned int> actual;
+        for (size_t i = 0; i < items.size(); ++i) {
+            collectMasks(chunk.items[variant.order.empty() ? i : variant.order[i]], stored);
+            collectMasks(items[i], actual);
+        }
+        if (actual != stored) variant.masks = std::move(actual);
+        return variant;
+    }
+
+    void addSkeleton(Recipe& recipe, const std::string* name, const LayoutModel& model) {
+        std::string snapshot;
+        writeSkeletonSnapshot(model, snapshot);
+        FingerprintHasher hasher;
+        hasher.add(std::string_view(snapshot));
+        recipe.skeleton = hasher.finish();
+        auto inserted = skeletons.try_emplace(recipe.skeleton);
+        if (inserted.second) inserted.first->second.snapshot = std::move(snapshot);
+        inserted.first->second.layouts.push_back(name);
+    }
+
+    void addArea(Recipe& recipe, const std::string* name, const EXMLParser& layout, LayoutArea area,
+                 const PagedItems& pages, const StringPool& pool) {
+        for (const auto& page : pages) {
+            if (page.second.empty()) continue;
+            addChunk(recipe, name, area, page.first, layout.getPageFingerprint(area, page.first), page.second, pool);
+        }
+    }
+
+    void addArea(Recipe& recipe, const std::string* name, const EXMLParser& layout, LayoutArea area,
+                 const ItemList& items, const StringPool& pool) {
+        if (items.empty()) return;
+        addChunk(recipe, name, area, 0, layout.getAreaFingerprint(area), items, pool);
+    }
+
+    bool remove(const std::string& name) {
+        auto it = layouts.find(name);
+        if (it == layouts.end()) return false;
+        const std::string* key = &it->first;
+        for (const auto& ref : it->second.chunks) {
+            auto chunk = chunks.find(ref.chunk);
+            if (chunk == chunks.end() || !release(chunk->second.layouts, key)) continue;
+            storedItems -= chunk->second.items.size();
+            chunks.erase(chunk);
+        }
+        auto config = configs.find(it->second.config);
+        if (config != configs.end() && release(config->second.layouts, key)) configs.erase(config);
+        auto skeleton = skeletons.find(it->second.skeleton);
+        if (skeleton != skeletons.end() && release(skeleton->second.layouts, key)) skeletons.erase(skeleton);
+        layouts.erase(it);
+        return true;
+    }
+};
+
+LayoutStore::LayoutStore() : pImpl(std::make_unique<LayoutStoreImpl>()) {}
+
+LayoutStore::~LayoutStore() = default;
+
+void LayoutStore::put(const std::string& name, const EXMLParser& layout) {
+    pImpl->remove(name);
+    auto inserted = pImpl->layouts.try_emplace(name).first;
+    const std::string* key = &inserted->first;
+    LayoutStoreImpl::Recipe& recipe = inserted->second;
+    const LayoutModel& model = layoutOf(layout);
+
+    recipe.config = layout.getConfigFingerprint();
+    auto config = pImpl->configs.try_emplace(recipe.config);
+    if (config.second) config.first->second.config = model.layoutConfig;
+    config.first->second.layouts.push_back(key);
+    pImpl->addSkeleton(recipe, key, model);
+
+    const StringPool& pool = *model.stringPool;
+    pImpl->addArea(recipe, key, layout, LayoutArea::HOME, model.homeItems, pool);
+    pImpl->addArea(recipe, key, layout, LayoutArea::HOTSEAT, model.hotseatItems, pool);
+    pImpl->addArea(recipe, key, layout, LayoutArea::HOME_ONLY, model.homeOnlyItems, pool);
+    pImpl->addArea(recipe, key, layout, LayoutArea::HOTSEAT_HOME_ONLY, model.hotseatHomeOnlyItems, pool);
+    pImpl->addArea(recipe, key, layout, LayoutArea::APP_ORDER, model.appOrderItems, pool);
+}
+
+bool LayoutStore::restore(const std::string& name, EXMLParser& out) const {
+    auto it = pImpl->layouts.find(name);
+    if (it == pImpl->layouts.end()) return false;
+    const LayoutStoreImpl::Recipe& recipe = it->second;
+
+    // 先还原文档骨架，再按原顺序添加项目，区域按骨架中的空白重新序列化
+    const std::string& skeleton = pImpl->skeletons.at(recipe.skeleton).snapshot;
+    if (!out.loadSnapshotFromMemory(skeleton.data(), skeleton.size())) return false;
+    out.setLayoutConfig(pImpl->configs.at(recipe.config).config);
+    for (size_t i = 0; i < recipe.chunks.size(); ++i) {
+        const ChunkRef& ref = recipe.chunks[i];
+        const LayoutStoreImpl::Variant& variant = recipe.variants[i];
+        const std::vector<Item>& items = pImpl->chunks.at(ref.chunk).items;
+        const unsigned int* mask = variant.masks.data();
+        for (size_t j = 0; j < items.size(); ++j) {
+            const Item& stored = items[variant.order.empty() ? j : variant.order[j]];
+            if (variant.masks.empty()) {
+                addItemToArea(out, ref.area, ref.page, stored);
+                continue;
+            }
+            Item item = stored;
+            applyMasks(item, mask);
+            addItemToArea(out, ref.area, ref.page, item);
+        }
+    }
+    return true;
+}
+
+bool LayoutStore::remove(const std::string& name) {
+    return pImpl->remove(name);
+}
+
+bool LayoutStore::contains(const std::string& name) const {
+    return pImpl->layouts.count(name) != 0;
+}
+
+std::vector<ChunkRef> LayoutStore::getChunks(const std::string& name) const {
+    auto it = pImpl->layouts.find(name);
+    return it != pImpl->layouts.end() ? it->second.chunks : std::vector<ChunkRef>();
+}
+
+std::vector<std::string> LayoutStore::findLayouts(const Fingerprint& chunk) const {
+    const std::vector<const std::string*>* owners = nullptr;
+    auto it = pImpl->chunks.find(chunk);
+    auto config = pImpl->configs.find(chunk);
+    auto skeleton = pImpl->skeletons.find(chunk);
+    if (it != pImpl->chunks.end()) {
+        owners = &it->second.layouts;
+    } else if (config != pImpl->configs.end()) {
+        owners = &config->second.layouts;
+    } else if (skeleton != pImpl->skeletons.end()) {
+        owners = &skeleton->second.layouts;
+    }
+
+    std::vector<std::string> names;
+    if (!owners) return names;
+    names.reserve(owners->size());
+    for (size_t i = 0; i < owners->size(); ++i) {
+        if (i == 0 || (*owners)[i] != (*owners)[i - 1]) names.push_back(*(*owners)[i]);
+    }
+    return names;
+}
+
+size_t LayoutStore::getLayoutCount() const {
+    return pImpl->layouts.size();
+}
+
+size_t LayoutStore::getChunkCount() const {
+    return pImpl->chunks.size() + pImpl->configs.size() + pImpl->skeletons.size();
+}
+
+size_t LayoutStore::getStoredItemCount() const {
+    return pImpl->storedItems;
+}
+
+void LayoutStore::clear() {
+    pImpl->chunks.clear();
+    pImpl->configs.clear();
+    pImpl->skeletons.clear();
+    pImpl->layouts.clear();
+    pImpl->storedItems = 0;
+}
+
+} // namespace exml
@@ -0,0 +1,89 @@
+#include "exml_parser.h"
+#include "exml_internal.h"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace exml {
+
+class StringPoolImpl {
+public:
+    explicit StringPoolImpl(bool concurrent) : concurrent(concurrent) {}
+
+    const bool concurrent;                                  // 为false时不加锁
+    mutable std::shared_mutex mutex;
+    std::deque<std::string> strings;                        // deque扩容时不移动已有元素
+    std::unordered_map<std::string_view, uint32_t> ids;     // 键引用strings中的内容
+};
+
+namespace {
+
+// 按需加锁：独占的池不需要同步
+class ReadLock {
+public:
+    explicit ReadLock(const StringPoolImpl& pool) : lock_(pool.mutex, std::defer_lock) {
+        if (pool.concurrent) lock_.lock();
+    }
+
+private:
+    std::shared_lock<std::shared_mutex> lock_;
+};
+
+class WriteLock {
+public:
+    explicit WriteLock(StringPoolImpl& pool) : lock_(pool.mutex, std::defer_lock) {
+        if (pool.concurrent) lock_.lock();
+    }
+
+private:
+    std::unique_lock<std::shared_mutex> lock_;
+};
+
+} // namespace
+
+StringPool::StringPool(bool concurrent) : pImpl(std::make_unique<StringPoolImpl>(concurrent)) {
+    intern(std::string_view());
+}
+
+StringPool::~StringPool() = default;
+
+uint32_t StringPool::intern(std::string_view value) {
+    {
+        ReadLock lock(*pImpl);
+        auto it = pImpl->ids.find(value);
+        if (it != pImpl->ids.end()) return it->second;
+    }
+    WriteLock lock(*pImpl);
+    auto it = pImpl->ids.find(value);
+    if (it != pImpl->ids.end()) return it->second;
+    const uint32_t id = static_cast<uint32_t>(pImpl->strings.size());
+    pImpl->strings.emplace_back(value);
+    pImpl->ids.emplace(pImpl->strings.back(), id);
+    return id;
+}
+
+uint32_t StringPool::find(std::string_view value) const {
+    ReadLock lock(*pImpl);
+    auto it = pImpl->ids.find(value);
+    return it != pImpl->ids.end() ? it->second : npos;
+}
+
+std::string_view StringPool::lookup(uint32_t id) const {
+    ReadLock lock(*pImpl);
+    return id < pImpl->strings.size() ? std::string_view(pImpl->strings[id]) : std::string_view();
+}
+
+size_t StringPool::size() const {
+    ReadLock lock(*pImpl);
+    return pImpl->strings.size();
+}
+
+size_t StringPool::memoryUsage() const {
+    ReadLock lock(*pImpl);
+    size_t bytes = sizeof(StringPool) + sizeof(StringPoolImpl) + hashMapMemory(pImpl->ids);
+    for (const auto& value : pImpl->strings) bytes += sizeof(std::string) + stringMemory(value);
+    return bytes;
+}
+
+} // namespace exml
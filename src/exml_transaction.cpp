@@ -0,0 +1,238 @@
+#include "exml_transaction.h"
+#include "exml_internal.h"
+#include "exml_model.h"
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace exml {
+
+namespace {
+
+enum class OperationKind {
+    ADD,
+    REMOVE,
+    MOVE
+};
+
+struct Operation {
+    OperationKind kind;
+    LayoutArea area;
+    int page;           // ADD、REMOVE的页码，MOVE的源页码
+    int toPage;
+    int index;
+    int toIndex;
+    Item item;          // ADD
+    std::optional<ItemRecord> record;  // ADD：模拟时由item转换，使用目标区域的分配器
+    std::string packageName;
+    std::string className;
+};
+
+bool isPaged(LayoutArea area) {
+    return area == LayoutArea::HOME || area == LayoutArea::HOME_ONLY;
+}
+
+PagedItems& pagedItems(LayoutModel& model, LayoutArea area) {
+    return area == LayoutArea::HOME ? model.homeItems : model.homeOnlyItems;
+}
+
+ItemList& listItems(LayoutModel& model, LayoutArea area) {
+    switch (area) {
+        case LayoutArea::HOTSEAT: return model.hotseatItems;
+        case LayoutArea::HOTSEAT_HOME_ONLY: return model.hotseatHomeOnlyItems;
+        default: return model.appOrderItems;
+    }
+}
+
+} // namespace
+
+class LayoutTransactionImpl {
+public:
+    // 区域在模拟过程中的状态：每页按顺序记录项目的地址（原有项目或操作中新增的项目），
+    // 操作只移动指针，不复制项目
+    struct WorkingArea {
+        bool touched = false;
+        std::map<int, std::vector<ItemRecord*>> pages;
+    };
+
+    explicit LayoutTransactionImpl(EXMLParser& parser) : parser(parser) {}
+
+    EXMLParser& parser;
+    std::vector<Operation> operations;
+    std::string error;
+
+    Operation& record(OperationKind kind, LayoutArea area) {
+        operations.emplace_back();
+        Operation& operation = operations.back();
+        operation.kind = kind;
+        operation.area = area;
+        operation.page = 0;
+        operation.toPage = 0;
+        operation.index = 0;
+        operation.toIndex = 0;
+        return operation;
+    }
+
+    WorkingArea& working(WorkingArea* areas, LayoutArea area) {
+        WorkingArea& state = areas[static_cast<int>(area)];
+        if (state.touched) return state;
+        state.touched = true;
+        LayoutModel& model = editableModel(parser, area);
+        if (isPaged(area)) {
+            for (auto& page : pagedItems(model, area)) {
+                std::vector<ItemRecord*>& refs = state.pages[page.first];
+                refs.reserve(page.second.size());
+                for (auto& item : page.second) refs.push_back(&item);
+            }
+        } else {
+            std::vector<ItemRecord*>& refs = state.pages[0];
+            ItemList& items = listItems(model, area);
+            refs.reserve(items.size());
+            for (auto& item : items) refs.push_back(&item);
+        }
+        return state;
+    }
+
+    bool fail(size_t operation, const std::string& message) {
+        error = "Operation " + std::to_string(operation) + ": " + message;
+        return false;
+    }
+
+    // 按单项操作的语义依次执行，任一操作无效时返回false
+    // （新增项目在此驻留字符串，提交失败时池中多出的名字不影响任何项目）
+    bool simulate(WorkingArea* areas) {
+        StringPool& pool = *parser.getStringPool();
+        for (size_t i = 0; i < operations.size(); ++i) {
+            Operation& operation = operations[i];
+            WorkingArea& state = working(areas, operation.area);
+            const bool paged = isPaged(operation.area);
+            const int page = paged ? operation.page : 0;
+
+            if (operation.kind == OperationKind::ADD) {
+                operation.record.emplace(
+                    makeRecord(operation.item, pool, editableModel(parser, operation.area).itemAllocator()));
+                state.pages[page].push_back(&*operation.record);
+                continue;
+            }
+
+            auto from = state.pages.find(page);
+            if (from == state.pages.end()) return fail(i, "page " + std::to_string(page) + " does not exist");
+            std::vector<ItemRecord*>& items = from->second;
+
+            if (operation.kind == OperationKind::REMOVE) {
+                // 名字不在池中时不可能有匹配的项目
+                const uint32_t packageId = pool.find(operation.packageName);
+                const uint32_t classId = pool.find(operation.className);
+                auto it = std::find_if(items.begin(), items.end(), [&](const ItemRecord* item) {
+                    return packageId != StringPool::npos && classId != StringPool::npos &&
+                           item->packageId == packageId && item->classId == classId;
+                });
+                if (it == items.end()) {
+                    return fail(i, "no item " + operation.packageName + "/" + operation.className + " to remove");
+                }
+                items.erase(it);
+                continue;
+            }
+
+            auto to = state.pages.find(paged ? operation.toPage : 0);
+            if (to == state.pages.end()) {
+                return fail(i, "page " + std::to_string(operation.toPage) + " does not exist");
+            }
+            const int size = static_cast<int>(items.size());
+            // 单列表区域的目标位置按移动前的长度校验，按页区域超出长度时放到末尾
+            if (operation.index < 0 || operation.index >= size || operation.toIndex < 0 ||
+                (!paged && operation.toIndex > size)) {
+                return fail(i, "move index out of range");
+            }
+            ItemRecord* item = items[operation.index];
+            items.erase(items.begin() + operation.index);
+            std::vector<ItemRecord*>& target = to->second;
+            const size_t at = std::min(static_cast<size_t>(operation.toIndex), target.size());
+            target.insert(target.begin() + at, item);
+        }
+        return true;
+    }
+
+    // 先为所有受影响区域分配新容器，再移入项目并整体替换，替换过程不会中途失败
+    void apply(WorkingArea* areas) {
+        for (int i = 0; i < kLayoutAreaCount; ++i) {
+            WorkingArea& state = areas[i];
+            if (!state.touched) continue;
+            const LayoutArea area = static_cast<LayoutArea>(i);
+            LayoutModel& model = editableModel(parser, area);
+            if (isPaged(area)) {
+                PagedItems& current = pagedItems(model, area);
+                PagedItems rebuilt(current.get_allocator());
+                for (const auto& page : state.pages) rebuilt[page.first].reserve(page.second.size());
+                for (const auto& page : state.pages) {
+                    ItemList& items = rebuilt[page.first];
+                    for (ItemRecord* item : page.second) items.push_back(std::move(*item));
+                }
+                current.swap(rebuilt);
+            } else {
+                ItemList& current = listItems(model, area);
+                ItemList rebuilt(current.get_allocator());
+                rebuilt.reserve(state.pages[0].size());
+                for (ItemRecord* item : state.pages[0]) rebuilt.push_back(std::move(*item));
+                current.swap(rebuilt);
+            }
+            areaEdited(parser, area);
+        }
+    }
+};
+
+LayoutTransaction::LayoutTransaction(EXMLParser& parser) : pImpl(std::make_unique<LayoutTransactionImpl>(parser)) {}
+
+LayoutTransaction::~LayoutTransaction() = default;
+
+void LayoutTransaction::addItem(LayoutArea area, int pageIndex, const Item& item) {
+    Operation& operation = pImpl->record(OperationKind::ADD, area);
+    operation.page = pageIndex;
+    operation.item = item;
+}
+
+void LayoutTransaction::addItem(LayoutArea area, int pageIndex, Item&& item) {
+    Operation& operation = pImpl->record(OperationKind::ADD, area);
+    operation.page = pageIndex;
+    operation.item = std::move(item);
+}
+
+void LayoutTransaction::removeItem(LayoutArea area, int pageIndex, const std::string& packageName,
+                                   const std::string& className) {
+    Operation& operation = pImpl->record(OperationKind::REMOVE, area);
+    operation.page = pageIndex;
+    operation.packageName = packageName;
+    operation.className = className;
+}
+
+void LayoutTransaction::moveItem(LayoutArea area, int fromPage, int fromIndex, int toPage, int toIndex) {
+    Operation& operation = pImpl->record(OperationKind::MOVE, area);
+    operation.page = fromPage;
+    operation.index = fromIndex;
+    operation.toPage = toPage;
+    operation.toIndex = toIndex;
+}
+
+size_t LayoutTransaction::size() const {
+    return pImpl->operations.size();
+}
+
+bool LayoutTransaction::commit() {
+    pImpl->error.clear();
+    LayoutTransactionImpl::WorkingArea areas[kLayoutAreaCount];
+    const bool ok = pImpl->simulate(areas);
+    if (ok) pImpl->apply(areas);
+    pImpl->operations.clear();
+    return ok;
+}
+
+void LayoutTransaction::rollback() {
+    pImpl->operations.clear();
+}
+
+const std::string& LayoutTransaction::getError() const {
+    return pImpl->error;
+}
+
+} // namespace exml
@@ -0,0 +1,128 @@
+#ifndef EXML_WALKER_H
+#define EXML_WALKER_H
+
+#include "exml_reader.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace exml {
+namespace detail {
+
+/**
+ * @brief 跳过当前元素（起始标签已读取）的整个子树
+ */
+inline bool skipElement(XmlReader& reader) {
+    XmlToken token;
+    int depth = 1;
+    while (reader.next(token)) {
+        if (token.type == XmlTokenType::StartElement && !token.selfClosing) ++depth;
+        else if (token.type == XmlTokenType::EndElement && --depth == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 遍历文档的顶层结构
+ *
+ * 区域元素（home、hotseat等）交给 handler.readSection() 消费；
+ * 只含文本的元素视为配置项，交给 handler.configValue()；
+ * 含子元素的未知元素（如根节点）视为透明容器，其子元素按顶层处理。
+ *
+ * 其余字节（声明、空白、未识别元素、容器标签）按原样交给 handler.raw()，
+ * 以便保存时还原文档结构。
+ *
+ * Handler需要提供：
+ *   bool isSection(std::string_view tag);
+ *   bool readSection(XmlReader& reader, const XmlToken& start);
+ *   bool configValue(std::string_view tag, const std::string& text, std::string_view source);
+ *   void raw(std::string_view source);
+ */
+template <typename Handler>
+bool walkDocument(XmlReader& reader, Handler& handler, std::string& error) {
+    XmlToken token;
+    std::vector<std::string_view> openElements;   // 未识别的容器元素（如根节点）
+    std::string text;
+
+    auto source = [&reader](size_t begin, size_t end) {
+        return std::string_view(reader.data() + begin, end - begin);
+    };
+
+    while (reader.next(token)) {
+        if (token.type == XmlTokenType::EndElement) {
+            if (openElements.empty() || openElements.back() != token.name) {
+                error = "unexpected </" + std::string(token.name) + "> at line " +
+                        std::to_string(reader.lineAt(token.begin));
+                return false;
+            }
+            openElements.pop_back();
+            handler.raw(source(token.begin, token.end));
+            continue;
+        }
+        if (token.type != XmlTokenType::StartElement) {
+            handler.raw(source(token.begin, token.end));
+            continue;
+        }
+
+        bool ok = true;
+        const std::string_view tag = token.name;
+        if (handler.isSection(tag)) {
+            ok = handler.readSection(reader, token);
+        } else if (token.selfClosing) {
+            text.clear();
+            if (!handler.configValue(tag, text, source(token.begin, token.end))) {
+                handler.raw(source(token.begin, token.end));
+            }
+            continue;
+        } else {
+            // 配置项或容器：读取到第一个子元素即视为容器
+            const size_t bodyStart = reader.offset();
+            XmlToken inner;
+            bool isContainer = false;
+            text.clear();
+            while (reader.next(inner)) {
+                if (inner.type == XmlTokenType::Text) {
+                    if (inner.cdata) text.append(inner.text.data(), inner.text.size());
+                    else appendDecoded(inner.text, text);
+                    continue;
+                }
+                if (inner.type == XmlTokenType::Other) continue;
+                isContainer = inner.type == XmlTokenType::StartElement;
+                break;
+            }
+            if (isContainer) {
+                // 回退到容器内容起点，把子元素当作顶层元素处理
+                reader.seek(bodyStart);
+                openElements.push_back(tag);
+                handler.raw(source(token.begin, bodyStart));
+                continue;
+            }
+            ok = inner.type == XmlTokenType::EndElement && inner.name == tag;
+            if (ok && !handler.configValue(tag, text, source(token.begin, inner.end))) {
+                handler.raw(source(token.begin, inner.end));
+            }
+        }
+
+        if (!ok) {
+            error = reader.failed() ? reader.errorMessage()
+                                    : "malformed <" + std::string(tag) + "> at line " +
+                                          std::to_string(reader.lineAt(token.begin));
+            return false;
+        }
+    }
+
+    if (reader.failed()) {
+        error = reader.errorMessage();
+        return false;
+    }
+    if (!openElements.empty()) {
+        error = "unclosed <" + std::string(openElements.back()) + ">";
+        return false;
+    }
+    return true;
+}
+
+} // namespace detail
+} // namespace exml
+
+#endif // EXML_WALKER_H
@@ -0,0 +1,346 @@
+#include "exml_internal.h"
+#include "exml_model.h"
+#include "exml_schema.h"
+#include <charconv>
+#include <cstring>
+
+namespace exml {
+
+namespace {
+
+// 项目所处的上下文，决定新建项目（attributeMask为0）默认输出哪些属性
+enum class ItemContext {
+    GRID,           // home / homeOnly：带坐标
+    LIST,           // hotseat：仅有序号
+    APP_ORDER,      // appOrder：带hidden
+    FOLDER_CHILD    // 文件夹内
+};
+
+ItemContext sectionContext(LayoutArea area) {
+    switch (area) {
+        case LayoutArea::HOME:
+        case LayoutArea::HOME_ONLY: return ItemContext::GRID;
+        case LayoutArea::APP_ORDER: return ItemContext::APP_ORDER;
+        default: return ItemContext::LIST;
+    }
+}
+
+const char* itemTag(ItemType type) {
+    switch (type) {
+        case ItemType::FOLDER: return "folder";
+        case ItemType::APPWIDGET: return "appwidget";
+        default: return "favorite";
+    }
+}
+
+unsigned int defaultAttributeMask(ItemType type, ItemContext context) {
+    unsigned int mask = ATTR_SCREEN;
+    if (type == ItemType::FOLDER) {
+        mask |= ATTR_TITLE | ATTR_OPTIONS | ATTR_COLOR;
+    } else {
+        mask |= ATTR_PACKAGE_NAME | ATTR_CLASS_NAME;
+    }
+    if (context == ItemContext::GRID) {
+        mask |= ATTR_X | ATTR_Y;
+        if (type == ItemType::APPWIDGET) mask |= ATTR_SPAN_X | ATTR_SPAN_Y | ATTR_APP_WIDGET_ID;
+    } else if (context == ItemContext::APP_ORDER && type == ItemType::FAVORITE) {
+        mask |= ATTR_HIDDEN;
+    }
+    return mask;
+}
+
+inline void appendInt(int value, std::string& out) {
+    char buffer[16];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr - buffer);
+}
+
+// 按属性表写出一个属性；未在mask中的属性仅在值不同于默认值时写出（字符串ID 0为空字符串）
+inline void appendAttribute(const ItemRecord& item, const ItemRecord& defaults, const StringPool& pool,
+                            const detail::AttributeDesc& desc, unsigned int mask, std::string& out) {
+    const bool wanted = (mask & desc.bit) != 0;
+    switch (desc.type) {
+        case detail::AttributeType::STRING:
+            if (!wanted && item.*desc.idMember == 0) return;
+            break;
+        case detail::AttributeType::INT:
+            if (!wanted && item.*desc.recordIntMember == defaults.*desc.recordIntMember) return;
+            break;
+        case detail::AttributeType::BOOL:
+            if (!wanted && item.*desc.recordBoolMember == defaults.*desc.recordBoolMember) return;
+            break;
+    }
+    out += ' ';
+    out.append(desc.name.data(), desc.name.size());
+    out += "=\"";
+    switch (desc.type) {
+        case detail::AttributeType::STRING: appendEscapedAttribute(pool.lookup(item.*desc.idMember), out); break;
+        case detail::AttributeType::INT: appendInt(item.*desc.recordIntMember, out); break;
+        case detail::AttributeType::BOOL: out += item.*desc.recordBoolMember ? '1' : '0'; break;
+    }
+    out += '"';
+}
+
+struct SectionFormat {
+    const std::string* itemSeparator;
+    const std::string* closeSeparator;
+    const std::string* childSeparator;
+    const std::string* childCloseSeparator;
+    const StringPool* pool;
+};
+
+void writeItem(const ItemRecord& item, ItemContext context, const SectionFormat& format, std::string& out) {
+    static const ItemRecord defaults;
+    const unsigned int mask = item.attributeMask ? item.attributeMask : defaultAttributeMask(item.type, context);
+
+    const char* tag = itemTag(item.type);
+    out += '<';
+    out += tag;
+    // 属性顺序与三星备份文件一致（即属性表的顺序）
+    for (const auto& desc : detail::kItemAttributes) {
+        appendAttribute(item, defaults, *format.pool, desc, mask, out);
+    }
+
+    if (item.type != ItemType::FOLDER || item.favorites.empty()) {
+        out += " />";
+        return;
+    }
+    out += '>';
+    for (const auto& child : item.favorites) {
+        out += *format.childSeparator;
+        writeItem(child, ItemContext::FOLDER_CHILD, format, out);
+    }
+    out += *format.childCloseSeparator;
+    out += "</";
+    out += tag;
+    out += '>';
+}
+
+void writeItems(const ItemList& items, ItemContext context, const SectionFormat& format, std::string& out) {
+    for (const auto& item : items) {
+        out += *format.itemSeparator;
+        writeItem(item, context, format, out);
+    }
+}
+
+bool areaEmpty(const LayoutModel& model, LayoutArea area) {
+    switch (area) {
+        case LayoutArea::HOME: return model.homeItems.empty();
+        case LayoutArea::HOTSEAT: return model.hotseatItems.empty();
+        case LayoutArea::HOME_ONLY: return model.homeOnlyItems.empty();
+        case LayoutArea::HOTSEAT_HOME_ONLY: return model.hotseatHomeOnlyItems.empty();
+        case LayoutArea::APP_ORDER: return model.appOrderItems.empty();
+    }
+    return true;
+}
+
+void writeSection(const LayoutModel& model, const DocumentSegment& segment, std::string& out) {
+    const char* tag = sectionTag(segment.area);
+    const ItemContext context = sectionContext(segment.area);
+    SectionFormat format = {&segment.itemSeparator, &segment.closeSeparator,
+                            &segment.childSeparator, &segment.childCloseSeparator, model.stringPool.get()};
+
+    if (segment.selfClosing && areaEmpty(model, segment.area)) {
+        out += '<';
+        out += tag;
+        out += " />";
+        return;
+    }
+
+    out += '<';
+    out += tag;
+    out += '>';
+    switch (segment.area) {
+        case LayoutArea::HOME:
+            for (const auto& page : model.homeItems) writeItems(page.second, context, format, out);
+            break;
+        case LayoutArea::HOTSEAT:
+            writeItems(model.hotseatItems, context, format, out);
+            break;
+        case LayoutArea::HOME_ONLY:
+            for (const auto& page : model.homeOnlyItems) writeItems(page.second, context, format, out);
+            break;
+        case LayoutArea::HOTSEAT_HOME_ONLY:
+            writeItems(model.hotseatHomeOnlyItems, context, format, out);
+            break;
+        case LayoutArea::APP_ORDER:
+            writeItems(model.appOrderItems, context, format, out);
+            break;
+    }
+    out += segment.closeSeparator;
+    out += "</";
+    out += tag;
+    out += '>';
+}
+
+template <typename Items>
+size_t estimateItems(const Items& items, const StringPool& pool) {
+    // 每个项目的固定开销（标签、数值属性）约200字节，再加上字符串长度
+    size_t size = 0;
+    for (const auto& item : items) {
+        size += 200 + pool.lookup(item.packageId).size() + pool.lookup(item.classId).size() +
+                pool.lookup(item.titleId).size();
+        size += estimateItems(item.favorites, pool);
+    }
+    return size;
+}
+
+size_t estimateItems(const PagedItems& pages, const StringPool& pool) {
+    size_t size = 0;
+    for (const auto& page : pages) size += estimateItems(page.second, pool);
+    return size;
+}
+
+// 估算输出大小，保证序列化过程中只分配一次
+size_t estimateSize(const LayoutModel& model, const std::vector<DocumentSegment>& skeleton) {
+    const StringPool& pool = *model.stringPool;
+    size_t size = 0;
+    for (const auto& segment : skeleton) size += segment.text.size() + segment.source.size() + 64;
+    return size + estimateItems(model.homeItems, pool) + estimateItems(model.hotseatItems, pool) +
+           estimateItems(model.homeOnlyItems, pool) + estimateItems(model.hotseatHomeOnlyItems, pool) +
+           estimateItems(model.appOrderItems, pool);
+}
+
+DocumentSegment sectionSegment(LayoutArea area, const std::string& newline) {
+    DocumentSegment segment;
+    segment.kind = SegmentKind::SECTION;
+    segment.area = area;
+    segment.itemSeparator = newline;
+    segment.closeSeparator = newline;
+    segment.childSeparator = newline;
+    segment.childCloseSeparator = newline;
+    return segment;
+}
+
+DocumentSegment rawSegment(std::string text) {
+    DocumentSegment segment;
+    segment.text = std::move(text);
+    return segment;
+}
+
+// 没有源文件结构时（新建的解析器）使用的默认文档结构
+std::vector<DocumentSegment> defaultSkeleton(const std::string& newline) {
+    std::vector<DocumentSegment> skeleton;
+    const std::string blank = newline + newline;
+    skeleton.push_back(rawSegment("<?xml version='1.0' encoding='UTF-8' standalone='yes' ?>" + newline));
+    const int viewTypeField = findConfigField("viewType_appOrder");
+    for (int field = 0; field < configFieldCount(); ++field) {
+        if (field == viewTypeField) continue;
+        DocumentSegment config;
+        config.kind = SegmentKind::CONFIG;
+        config.field = field;
+        skeleton.push_back(config);
+        skeleton.push_back(rawSegment(blank));
+    }
+    skeleton.push_back(sectionSegment(LayoutArea::HOME, newline));
+    skeleton.push_back(rawSegment(blank));
+    skeleton.push_back(sectionSegment(LayoutArea::HOTSEAT, newline));
+    skeleton.push_back(rawSegment(blank));
+    skeleton.push_back(sectionSegment(LayoutArea::HOME_ONLY, newline));
+    skeleton.push_back(rawSegment(blank));
+    skeleton.push_back(sectionSegment(LayoutArea::HOTSEAT_HOME_ONLY, newline));
+    skeleton.push_back(rawSegment(blank));
+    DocumentSegment viewType;
+    viewType.kind = SegmentKind::CONFIG;
+    viewType.field = viewTypeField;
+    skeleton.push_back(viewType);
+    skeleton.push_back(rawSegment(blank));
+    skeleton.push_back(sectionSegment(LayoutArea::APP_ORDER, newline));
+    return skeleton;
+}
+
+template <bool Attribute>
+void appendEscaped(std::string_view value, std::string& out) {
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const char* replacement = nullptr;
+        switch (value[i]) {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            case '"': if (Attribute) replacement = "&quot;"; break;
+            default: break;
+        }
+        if (!replacement) continue;
+        out.append(value.data() + start, i - start);
+        out += replacement;
+        start = i + 1;
+    }
+    out.append(value.data() + start, value.size() - start);
+}
+
+} // namespace
+
+void appendEscapedText(std::string_view text, std::string& out) {
+    appendEscaped<false>(text, out);
+}
+
+void appendEscapedAttribute(std::string_view value, std::string& out) {
+    appendEscaped<true>(value, out);
+}
+
+void writeDocument(const LayoutModel& model, std::string& out) {
+    std::vector<DocumentSegment> fallback;
+    if (model.skeleton.empty()) fallback = defaultSkeleton(model.newline);
+    const std::vector<DocumentSegment>& skeleton = model.skeleton.empty() ? fallback : model.skeleton;
+
+    out.reserve(out.size() + estimateSize(model, skeleton));
+
+    // 源文件中没有、但已被修改的配置项，放在第一个区域之前输出
+    std::vector<bool> present(configFieldCount(), false);
+    for (const auto& segment : skeleton) {
+        if (segment.kind == SegmentKind::CONFIG) present[segment.field] = true;
+    }
+
+    bool written[kLayoutAreaCount] = {};
+    bool missingWritten = false;
+    for (const auto& segment : skeleton) {
+        switch (segment.kind) {
+            case SegmentKind::RAW:
+                out += segment.text;
+                break;
+            case SegmentKind::CONFIG:
+                if (!segment.text.empty() && configFieldEquals(model.layoutConfig, model.loadedConfig, segment.field)) {
+                    out += segment.text;
+                } else {
+                    appendConfigElement(model.layoutConfig, segment.field, out);
+                }
+                break;
+            case SegmentKind::SECTION: {
+                if (!missingWritten) {
+                    missingWritten = true;
+                    for (int field = 0; field < configFieldCount(); ++field) {
+                        if (present[field] || configFieldEquals(model.layoutConfig, model.loadedConfig, field)) continue;
+                        appendConfigElement(model.layoutConfig, field, out);
+                        out += model.newline;
+                    }
+                }
+                // 未修改的区域输出源文件原文（重复出现时每处各自输出）；
+                // 修改过的区域重新序列化，重复出现时只在第一次出现处输出
+                bool& done = written[static_cast<int>(segment.area)];
+                const bool dirty = (model.dirtySections & (1u << static_cast<int>(segment.area))) != 0;
+                if (!dirty && !segment.source.empty()) out += segment.source;
+                else if (!done) writeSection(model, segment, out);
+                done = true;
+                break;
+            }
+        }
+    }
+
+    // 源文件中没有对应元素、但已添加了内容的区域，追加到文档末尾
+    if (!missingWritten) {
+        for (int field = 0; field < configFieldCount(); ++field) {
+            if (present[field] || configFieldEquals(model.layoutConfig, model.loadedConfig, field)) continue;
+            out += model.newline;
+            appendConfigElement(model.layoutConfig, field, out);
+        }
+    }
+    for (int i = 0; i < kLayoutAreaCount; ++i) {
+        const LayoutArea area = static_cast<LayoutArea>(i);
+        if (written[static_cast<int>(area)] || areaEmpty(model, area)) continue;
+        out += model.newline;
+        writeSection(model, sectionSegment(area, model.newline), out);
+    }
+}
+
+} // namespace exml
@@ -1,6 +1,120 @@
 #include "exml_parser.h"
+#include "exml_mapped.h"
+#include "exml_diff.h"
+#include "exml_merge.h"
+#include "exml_store.h"
+#include "exml_cache.h"
+#include "exml_transaction.h"
+#include "exml_columnar.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory_resource>
+#include <new>
+#include <sstream>
 #include <iomanip>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+    #include <malloc.h>
+#endif
+
+// 替换全局operator new/delete的全部形式（普通、数组、nothrow、按大小、按对齐），
+// 在计数开启时统计堆分配次数（动态库内的分配同样经过这里）；分配与释放成对使用malloc/free
+std::atomic<bool> countAllocations{false};
+std::atomic<size_t> allocationCount{0};
+
+void* countedAllocate(std::size_t size) noexcept {
+    if (countAllocations.load(std::memory_order_relaxed)) allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void* countedAllocate(std::size_t size, std::align_val_t alignment) noexcept {
+    if (countAllocations.load(std::memory_order_relaxed)) allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc要求大小为对齐的整数倍
+    return std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align);
+#endif
+}
+
+void countedFree(void* p) noexcept {
+    std::free(p);
+}
+
+void countedFree(void* p, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* p = countedAllocate(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* p = countedAllocate(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, alignment);
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
+void operator delete[](void* p, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept { countedFree(p, alignment); }
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept { countedFree(p, alignment); }
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    countedFree(p, alignment);
+}
+
+template <typename Action>
+size_t countHeapAllocations(Action action) {
+    allocationCount = 0;
+    countAllocations = true;
+    action();
+    countAllocations = false;
+    return allocationCount;
+}
 
 void printItem(const exml::Item& item, const std::string& prefix = "") {
     std::cout << prefix << "Type: ";
@@ -152,6 +266,1604 @@ void testSearchFunctionality(const exml::EXMLParser& parser) {
     std::cout << std::endl;
 }
 
+bool sameItem(const exml::Item& a, const exml::Item& b) {
+    if (a.type != b.type || a.packageName != b.packageName || a.className != b.className ||
+        a.title != b.title || a.screen != b.screen || a.x != b.x || a.y != b.y ||
+        a.spanX != b.spanX || a.spanY != b.spanY || a.appWidgetID != b.appWidgetID ||
+        a.options != b.options || a.color != b.color || a.hidden != b.hidden ||
+        a.favorites.size() != b.favorites.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.favorites.size(); ++i) {
+        if (!sameItem(a.favorites[i], b.favorites[i])) return false;
+    }
+    return true;
+}
+
+bool sameItems(const std::vector<exml::Item>& a, const std::vector<exml::Item>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!sameItem(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+bool testStreamingLoad() {
+    std::cout << "=== Streaming Load Test ===" << std::endl;
+    exml::EXMLParser streaming;
+    exml::EXMLParser dom;
+    exml::LoadOptions domOptions;
+    domOptions.mode = exml::LoadMode::DOM;
+    if (!streaming.loadFromFile("samples/template.exml") ||
+        !dom.loadFromFile("samples/template.exml", domOptions)) {
+        std::cout << "FAILED: cannot load template in both modes" << std::endl;
+        return false;
+    }
+
+    bool ok = streaming.getHomePageCount() == dom.getHomePageCount() &&
+              streaming.getHomeOnlyPageCount() == dom.getHomeOnlyPageCount() &&
+              sameItems(streaming.getHotseatItems(), dom.getHotseatItems()) &&
+              sameItems(streaming.getHotseatHomeOnlyItems(), dom.getHotseatHomeOnlyItems()) &&
+              sameItems(streaming.getAppOrderItems(), dom.getAppOrderItems());
+    for (int page = 0; ok && page < 8; ++page) {
+        ok = sameItems(streaming.getHomeItems(page), dom.getHomeItems(page)) &&
+             sameItems(streaming.getHomeOnlyItems(page), dom.getHomeOnlyItems(page));
+    }
+    ok = ok && streaming.getLayoutConfig().rows == 5 && streaming.getLayoutConfig().pageCount == 2 &&
+         streaming.getLayoutConfig().viewTypeAppOrder == "CUSTOM" &&
+         dom.getLayoutConfig().folderGrid == streaming.getLayoutConfig().folderGrid &&
+         streaming.getHotseatHomeOnlyItemCount() == 5 &&
+         streaming.getHotseatHomeOnlyItems()[0].packageName == "com.samsung.android.dialer";
+
+    // 有根节点与格式错误的输入
+    const std::string rooted = "<backup><Rows>6</Rows><hotseat><favorite packageName=\"a&amp;b\" /></hotseat></backup>";
+    exml::EXMLParser rootedParser;
+    ok = ok && rootedParser.loadFromMemory(rooted.data(), rooted.size()) &&
+         rootedParser.getLayoutConfig().rows == 6 && rootedParser.getHotseatItemCount() == 1 &&
+         rootedParser.getHotseatItems()[0].packageName == "a&b";
+    // 同一区域重复出现时逐个追加，有根节点的DOM加载也不重复解析
+    const std::string repeated = "<backup><home><favorite screen=\"0\" /></home><home><favorite screen=\"1\" /></home>"
+                                 "<hotseat_homeOnly><favorite packageName=\"p\" /></hotseat_homeOnly></backup>";
+    exml::EXMLParser repeatedStreaming;
+    exml::EXMLParser repeatedDom;
+    ok = ok && repeatedStreaming.loadFromMemory(repeated.data(), repeated.size()) &&
+         repeatedDom.loadFromMemory(repeated.data(), repeated.size(), domOptions) &&
+         repeatedStreaming.getHomePageCount() == 2 && repeatedDom.getHomePageCount() == 2 &&
+         repeatedDom.getHomeItems(0).size() == 1 && repeatedDom.getHomeItems(1).size() == 1 &&
+         repeatedDom.getHotseatHomeOnlyItemCount() == 1 && repeatedStreaming.getHotseatHomeOnlyItemCount() == 1;
+    const std::string truncated = "<home><favorite screen=\"0\" /></home><hotseat>";
+    exml::EXMLParser truncatedParser;
+    ok = ok && !truncatedParser.loadFromMemory(truncated.data(), truncated.size());
+
+    std::cout << (ok ? "Streaming load matches DOM load" : "FAILED: streaming load differs from DOM load") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool sameView(const exml::MappedLayout& layout, const exml::ItemView& view, const exml::Item& item) {
+    if (view.type != item.type || view.packageName != item.packageName || view.className != item.className ||
+        view.title != item.title || view.screen != item.screen || view.x != item.x || view.y != item.y ||
+        view.spanX != item.spanX || view.spanY != item.spanY || view.appWidgetID != item.appWidgetID ||
+        view.hidden != item.hidden) {
+        return false;
+    }
+    auto children = layout.getFolderItems(view);
+    if (children.size() != item.favorites.size()) return false;
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (!sameView(layout, children[i], item.favorites[i])) return false;
+    }
+    return true;
+}
+
+bool sameViews(const exml::MappedLayout& layout, exml::Span<exml::ItemView> views, const std::vector<exml::Item>& items) {
+    if (views.size() != items.size()) return false;
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (!sameView(layout, views[i], items[i])) return false;
+    }
+    return true;
+}
+
+bool testMappedLayout(const exml::EXMLParser& parser) {
+    std::cout << "=== Mapped Layout Test ===" << std::endl;
+    exml::MappedLayout layout;
+    if (!layout.open("samples/template.exml")) {
+        std::cout << "FAILED: cannot map template.exml" << std::endl;
+        return false;
+    }
+
+    bool ok = layout.getHomePageCount() == parser.getHomePageCount() &&
+              layout.getHomeOnlyPageCount() == parser.getHomeOnlyPageCount() &&
+              sameViews(layout, layout.getHotseatItems(), parser.getHotseatItems()) &&
+              sameViews(layout, layout.getHotseatHomeOnlyItems(), parser.getHotseatHomeOnlyItems()) &&
+              sameViews(layout, layout.getAppOrderItems(), parser.getAppOrderItems()) &&
+              layout.getLayoutConfig().folderGrid == parser.getLayoutConfig().folderGrid;
+    for (int page = 0; ok && page < 8; ++page) {
+        ok = sameViews(layout, layout.getHomeItems(page), parser.getHomeItems(page)) &&
+             sameViews(layout, layout.getHomeOnlyItems(page), parser.getHomeOnlyItems(page));
+    }
+
+    size_t appCount = 0;
+    for (const auto& view : layout.getAppOrderItems()) {
+        appCount += view.type == exml::ItemType::FOLDER ? layout.getFolderItems(view).size() : 1;
+    }
+    std::cout << "AppOrder apps (including folders): " << appCount << std::endl;
+
+    layout.close();
+    ok = ok && !layout.isOpen() && layout.getHotseatItems().empty();
+    std::cout << (ok ? "Mapped views match parsed items" : "FAILED: mapped views differ from parsed items") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+bool testSaveRoundTrip(exml::EXMLParser& parser) {
+    std::cout << "=== Save Functionality Test ===" << std::endl;
+    const std::string original = readFile("samples/template.exml");
+    const std::string outputPath = (std::filesystem::temp_directory_path() / "exml_output.exml").string();
+
+    // 未修改的文档逐字节复原
+    std::string saved;
+    parser.saveToString(saved);
+    bool ok = saved == original;
+    std::cout << "Unmodified round trip: " << (ok ? "byte-exact" : "DIFFERS") << std::endl;
+
+    exml::EXMLParser dom;
+    exml::LoadOptions domOptions;
+    domOptions.mode = exml::LoadMode::DOM;
+    std::string domSaved;
+    if (dom.loadFromFile("samples/template.exml", domOptions)) dom.saveToString(domSaved);
+    exml::EXMLParser domReloaded;
+    ok = ok && domReloaded.loadFromMemory(domSaved.data(), domSaved.size()) &&
+         sameItems(domReloaded.getHotseatItems(), dom.getHotseatItems()) &&
+         sameItems(domReloaded.getAppOrderItems(), dom.getAppOrderItems()) &&
+         sameItems(domReloaded.getHotseatHomeOnlyItems(), dom.getHotseatHomeOnlyItems()) &&
+         domReloaded.getLayoutConfig().folderGrid == dom.getLayoutConfig().folderGrid;
+
+    // 修改后保存到文件并重新加载
+    exml::Item added;
+    added.packageName = "com.example.<test>";
+    added.className = "com.example.Main";
+    added.x = 3;
+    added.y = 4;
+    exml::LayoutConfig config = parser.getLayoutConfig();
+    config.rows = 6;
+    exml::EXMLParser modified;
+    ok = ok && modified.loadFromFile("samples/template.exml") && modified.addHotseatItem(added);
+    modified.setLayoutConfig(config);
+    ok = ok && modified.saveToFile(outputPath);
+
+    exml::EXMLParser reloaded;
+    ok = ok && reloaded.loadFromFile(outputPath) &&
+         reloaded.getHotseatItemCount() == parser.getHotseatItemCount() + 1 &&
+         reloaded.getHotseatItems().back().packageName == added.packageName &&
+         reloaded.getLayoutConfig().rows == 6 &&
+         reloaded.getLayoutConfig().columns == parser.getLayoutConfig().columns &&
+         sameItems(reloaded.getAppOrderItems(), parser.getAppOrderItems()) &&
+         reloaded.getHomePageCount() == parser.getHomePageCount();
+    std::filesystem::remove(outputPath);
+
+    // 空解析器按默认格式输出
+    exml::EXMLParser empty;
+    empty.addHomeItem(0, added);
+    std::string fresh;
+    empty.saveToString(fresh);
+    exml::EXMLParser freshParser;
+    ok = ok && freshParser.loadFromMemory(fresh.data(), fresh.size()) &&
+         freshParser.getHomeItems(0).size() == 1 && freshParser.getHomeItems(0)[0].packageName == added.packageName;
+
+    std::cout << (ok ? "Save round trip passed" : "FAILED: save round trip") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testParseMany(const exml::EXMLParser& parser) {
+    std::cout << "=== Batch Load Test ===" << std::endl;
+    const std::string brokenPath = (std::filesystem::temp_directory_path() / "exml_broken.exml").string();
+    {
+        std::ofstream broken(brokenPath, std::ios::binary);
+        broken << "<home><favorite screen=\"0\" /></home><hotseat>";
+    }
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < 16; ++i) paths.push_back("samples/template.exml");
+    paths.push_back("samples/missing.exml");
+    paths.push_back(brokenPath);
+
+    exml::BatchOptions options;
+    options.threadCount = 4;
+    std::vector<exml::ParseResult> results = exml::parseMany(paths, options);
+    std::filesystem::remove(brokenPath);
+
+    bool ok = results.size() == paths.size();
+    for (size_t i = 0; ok && i < 16; ++i) {
+        ok = results[i].success && results[i].path == paths[i] && results[i].parser &&
+             results[i].parser->getHomePageCount() == parser.getHomePageCount() &&
+             sameItems(results[i].parser->getAppOrderItems(), parser.getAppOrderItems());
+    }
+    ok = ok && !results[16].success && !results[16].parser && !results[16].error.empty() &&
+         !results[17].success && results[17].error.find("hotseat") != std::string::npos;
+
+    std::cout << "Loaded " << std::count_if(results.begin(), results.end(),
+                                            [](const exml::ParseResult& r) { return r.success; })
+              << " of " << results.size() << " files" << std::endl;
+    std::cout << (ok ? "Batch load passed" : "FAILED: batch load") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+std::vector<exml::Item> scanItems(const std::vector<exml::Item>& items, const std::string& packageName) {
+    std::vector<exml::Item> result;
+    for (const auto& item : items) {
+        if (item.packageName == packageName) result.push_back(item);
+    }
+    return result;
+}
+
+// 增删移动后，索引查找结果应与线性扫描一致
+bool testPackageIndex() {
+    std::cout << "=== Package Index Test ===" << std::endl;
+    exml::EXMLParser parser;
+    if (!parser.loadFromFile("samples/template.exml")) return false;
+
+    std::vector<std::string> packages;
+    for (const auto& item : parser.getAppOrderItems()) packages.push_back(item.packageName);
+    packages.push_back("com.example.missing");
+
+    auto consistent = [&]() {
+        for (const auto& package : packages) {
+            std::vector<exml::Item> home;
+            for (size_t page = 0; page < parser.getHomePageCount(); ++page) {
+                auto found = scanItems(parser.getHomeItems(static_cast<int>(page)), package);
+                home.insert(home.end(), found.begin(), found.end());
+            }
+            if (!sameItems(parser.findHomeItems(package), home) ||
+                !sameItems(parser.findHotseatItems(package), scanItems(parser.getHotseatItems(), package)) ||
+                !sameItems(parser.findAppOrderItems(package), scanItems(parser.getAppOrderItems(), package))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bool ok = consistent();
+    unsigned int seed = 7;
+    for (int step = 0; ok && step < 200; ++step) {
+        seed = seed * 1103515245u + 12345u;
+        const std::string& package = packages[(seed >> 8) % packages.size()];
+        exml::Item item;
+        item.packageName = package;
+        item.className = package + ".Main";
+        switch ((seed >> 4) % 6) {
+            case 0: parser.addHomeItem((seed >> 12) % 2, item); break;
+            case 1: parser.addAppOrderItem(item); break;
+            case 2: parser.removeAppOrderItem(package, parser.findAppOrderItems(package).empty()
+                                                       ? item.className
+                                                       : parser.findAppOrderItems(package)[0].className); break;
+            case 3: parser.moveAppOrderItem((seed >> 12) % parser.getAppOrderItemCount(), (seed >> 16) % 10); break;
+            case 4: parser.moveHomeItem(0, 0, 1, (seed >> 12) % 5); break;
+            case 5: parser.moveHotseatItem((seed >> 12) % parser.getHotseatItemCount(), 0); break;
+        }
+        ok = consistent();
+    }
+    ok = ok && !parser.moveHomeItem(0, 0, 99, 0) && !parser.moveHotseatItem(-1, 0);
+
+    std::cout << (ok ? "Indexed lookups match linear scans" : "FAILED: indexed lookups differ from linear scans") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool sameItems(const exml::ItemsView& view, const std::vector<exml::Item>& items) {
+    std::vector<exml::Item> copied;
+    for (const exml::ItemRef item : view) copied.push_back(item.toItem());
+    return sameItems(copied, items);
+}
+
+bool testItemViews(const exml::EXMLParser& parser) {
+    std::cout << "=== Item View Test ===" << std::endl;
+    bool ok = sameItems(parser.viewHotseatItems(), parser.getHotseatItems()) &&
+              sameItems(parser.viewAppOrderItems(), parser.getAppOrderItems()) &&
+              parser.viewHomeItems(99).empty();
+    for (int page = 0; ok && page < 8; ++page) {
+        exml::ItemsView view = parser.viewHomeItems(page);
+        ok = sameItems(view, parser.getHomeItems(page)) &&
+             sameItems(parser.viewHomeOnlyItems(page), parser.getHomeOnlyItems(page)) &&
+             view.area() == exml::LayoutArea::HOME && view.page() == page;
+        for (size_t i = 0; ok && i < view.size(); ++i) {
+            ok = parser.getItem(view.locationOf(i)) == view[i];
+        }
+    }
+
+    // 位置查找与按值查找一致
+    for (const exml::ItemRef item : parser.viewAppOrderItems()) {
+        if (!ok) break;
+        const std::string packageName(item.packageName());
+        std::vector<exml::Item> located;
+        for (const auto& location : parser.locateHomeItems(packageName)) {
+            located.push_back(parser.getItem(location).toItem());
+        }
+        ok = sameItems(located, parser.findHomeItems(packageName)) &&
+             parser.locateAppOrderItems(packageName).size() == parser.findAppOrderItems(packageName).size();
+    }
+    ok = ok && parser.locateHotseatItems("com.example.missing").empty() &&
+         !parser.getItem(exml::ItemLocation{exml::LayoutArea::HOTSEAT, 0, 1000});
+
+    std::cout << (ok ? "Views and locations match copied results" : "FAILED: views differ from copied results") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testStringPool(const exml::EXMLParser& parser) {
+    std::cout << "=== String Pool Test ===" << std::endl;
+    auto pool = parser.getStringPool();
+    bool ok = pool && pool->lookup(0).empty() && pool->find("com.example.missing") == exml::StringPool::npos;
+
+    // 同名字符串在各区域共用同一个ID
+    size_t names = 0;
+    for (const exml::ItemRef item : parser.viewAppOrderItems()) {
+        ok = ok && pool->lookup(item.packageId()) == item.packageName() &&
+             pool->lookup(item.classId()) == item.className();
+        for (const auto& location : parser.locateHomeItems(std::string(item.packageName()))) {
+            ok = ok && parser.getItem(location).packageId() == item.packageId();
+        }
+        names += 2;
+    }
+    std::cout << "Distinct names: " << pool->size() << " (appOrder references " << names << ")" << std::endl;
+
+    // 批量加载共享同一个池
+    exml::BatchOptions options;
+    options.threadCount = 2;
+    options.stringPool = std::make_shared<exml::StringPool>();
+    auto results = exml::parseMany({"samples/template.exml", "samples/template.exml"}, options);
+    ok = ok && results.size() == 2 && results[0].success && results[1].success &&
+         results[0].parser->getStringPool() == options.stringPool &&
+         results[0].parser->viewHotseatItems()[0].packageId() ==
+             results[1].parser->viewHotseatItems()[0].packageId() &&
+         options.stringPool->size() == pool->size();
+
+    // 更换字符串池后删除仍然有效
+    exml::EXMLParser moved;
+    ok = ok && moved.loadFromFile("samples/template.exml");
+    exml::Item first = moved.getHotseatItems()[0];
+    moved.setStringPool(options.stringPool);
+    ok = ok && moved.findHotseatItems(first.packageName).size() == 1 &&
+         moved.removeHotseatItem(first.packageName, first.className) &&
+         moved.findHotseatItems(first.packageName).empty();
+
+    std::cout << (ok ? "String pool passed" : "FAILED: string pool") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+// 统计分配次数的内存资源
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t outstanding = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        ++outstanding;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        --outstanding;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+bool sameLayout(const exml::EXMLParser& a, const exml::EXMLParser& b) {
+    bool ok = a.getHomePageCount() == b.getHomePageCount() &&
+              sameItems(a.getHotseatItems(), b.getHotseatItems()) &&
+              sameItems(a.getAppOrderItems(), b.getAppOrderItems());
+    for (int page = 0; ok && page < 8; ++page) {
+        ok = sameItems(a.getHomeItems(page), b.getHomeItems(page)) &&
+             sameItems(a.getHomeOnlyItems(page), b.getHomeOnlyItems(page));
+    }
+    return ok;
+}
+
+bool testMemoryResource(const exml::EXMLParser& parser) {
+    std::cout << "=== Memory Resource Test ===" << std::endl;
+    CountingResource counting;
+    bool ok = true;
+    {
+        exml::EXMLParser custom(&counting);
+        ok = custom.loadFromFile("samples/template.exml") && sameLayout(custom, parser) && counting.allocations > 0;
+        custom.clear();
+        ok = ok && counting.outstanding == 0;
+        // 文件夹内的项目与区域容器使用同一内存资源：快捷栏列表与文件夹列表各一块
+        exml::Item folder;
+        folder.type = exml::ItemType::FOLDER;
+        folder.favorites.resize(3);
+        ok = ok && custom.addHotseatItem(folder) && counting.outstanding == 2;
+        ok = ok && custom.loadFromFile("samples/template.exml") && custom.removeAppOrderItem(
+                       parser.getAppOrderItems()[0].packageName, parser.getAppOrderItems()[0].className);
+    }
+    ok = ok && counting.outstanding == 0;
+
+    exml::EXMLParser arena(exml::AllocationMode::ARENA);
+    for (int round = 0; ok && round < 3; ++round) {
+        ok = arena.loadFromFile("samples/template.exml") && sameLayout(arena, parser);
+    }
+    arena.clear();
+    ok = ok && arena.getAppOrderItemCount() == 0 && arena.addHotseatItem(parser.getHotseatItems()[0]) &&
+         arena.getHotseatItemCount() == 1;
+
+    exml::BatchOptions options;
+    options.allocation = exml::AllocationMode::ARENA;
+    auto results = exml::parseMany({"samples/template.exml"}, options);
+    ok = ok && results.size() == 1 && results[0].success && sameLayout(*results[0].parser, parser);
+
+    std::cout << "Allocations through custom resource: " << counting.allocations << std::endl;
+    std::cout << (ok ? "Memory resource passed" : "FAILED: memory resource") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testDiagnostics() {
+    std::cout << "=== Numeric Diagnostics Test ===" << std::endl;
+    const std::string document =
+        "<Rows>abc</Rows>\n"
+        "<Columns> 6 </Columns>\n"
+        "<home>\n"
+        "<favorite screen=\"0\" x=\"?\" y=\"+2\" packageName=\"a\" />\n"
+        "<favorite screen=\"0\" spanX=\"99999999999\" hidden=\"maybe\" packageName=\"b\" />\n"
+        "</home>\n";
+
+    bool ok = true;
+    for (exml::LoadMode mode : {exml::LoadMode::STREAMING, exml::LoadMode::DOM}) {
+        exml::LoadOptions options;
+        options.mode = mode;
+        exml::EXMLParser parser;
+        // 格式错误的字段保留默认值，不影响整个文件的加载
+        ok = ok && parser.loadFromMemory(document.data(), document.size(), options);
+        const auto& diagnostics = parser.getDiagnostics();
+        const auto items = parser.getHomeItems(0);
+        ok = ok && items.size() == 2 && parser.getLayoutConfig().rows == 5 && parser.getLayoutConfig().columns == 6 &&
+             items[0].x == 0 && items[0].y == 2 && items[1].spanX == 1 && !items[1].hidden &&
+             diagnostics.size() == 4;
+        ok = ok && diagnostics[0].element == "Rows" && diagnostics[0].attribute.empty() &&
+             diagnostics[0].value == "abc" && diagnostics[0].line == 1 &&
+             diagnostics[1].element == "favorite" && diagnostics[1].attribute == "x" && diagnostics[1].line == 4 &&
+             diagnostics[2].attribute == "spanX" && diagnostics[2].line == 5 &&
+             diagnostics[3].attribute == "hidden" && diagnostics[3].value == "maybe";
+    }
+
+    exml::EXMLParser clean;
+    ok = ok && clean.loadFromFile("samples/template.exml") && clean.getDiagnostics().empty();
+
+    std::cout << (ok ? "Malformed fields reported without aborting the load" : "FAILED: numeric diagnostics") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testAttributeSchema() {
+    std::cout << "=== Attribute Schema Test ===" << std::endl;
+    // 每个属性都不取默认值，保存后在两种模式下重新加载应完全一致
+    exml::Item widget;
+    widget.type = exml::ItemType::APPWIDGET;
+    widget.packageName = "com.example.widget";
+    widget.className = "com.example.widget.Provider";
+    widget.title = "Clock & Weather";
+    widget.screen = 2;
+    widget.x = 1;
+    widget.y = 3;
+    widget.spanX = 4;
+    widget.spanY = 2;
+    widget.appWidgetID = 77;
+    widget.options = 5;
+    widget.color = 0x1234;
+    widget.hidden = true;
+
+    exml::EXMLParser source;
+    source.addAppOrderItem(widget);
+    std::string saved;
+    source.saveToString(saved);
+    bool ok = true;
+
+    for (exml::LoadMode mode : {exml::LoadMode::STREAMING, exml::LoadMode::DOM}) {
+        exml::LoadOptions options;
+        options.mode = mode;
+        exml::EXMLParser reloaded;
+        ok = ok && reloaded.loadFromMemory(saved.data(), saved.size(), options) &&
+             sameItems(reloaded.getAppOrderItems(), source.getAppOrderItems());
+        std::string resaved;
+        reloaded.saveToString(resaved);
+        // DOM模式不保留空白，只有流式模式逐字节一致
+        ok = ok && (mode == exml::LoadMode::DOM || resaved == saved);
+    }
+
+    // 未知属性被忽略，已知属性顺序无关
+    const std::string reordered = "<hotseat><favorite hidden=\"1\" unknown=\"?\" x=\"2\" screen=\"1\" /></hotseat>";
+    exml::EXMLParser parser;
+    ok = ok && parser.loadFromMemory(reordered.data(), reordered.size()) && parser.getDiagnostics().empty() &&
+         parser.getHotseatItems()[0].hidden && parser.getHotseatItems()[0].x == 2 &&
+         parser.getHotseatItems()[0].screen == 1 &&
+         parser.getHotseatItems()[0].attributeMask == (exml::ATTR_HIDDEN | exml::ATTR_X | exml::ATTR_SCREEN);
+
+    std::cout << (ok ? "Attribute schema round trip passed" : "FAILED: attribute schema") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+// 暴力扫描：页面中第一个覆盖(x, y)的项目序号，没有时为-1
+int scanOccupant(const std::vector<exml::Item>& items, int x, int y) {
+    for (size_t i = 0; i < items.size(); ++i) {
+        const exml::Item& item = items[i];
+        if (x >= item.x && x < item.x + std::max(item.spanX, 1) && y >= item.y && y < item.y + std::max(item.spanY, 1)) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool testOccupancyGrid() {
+    std::cout << "=== Occupancy Grid Test ===" << std::endl;
+    exml::EXMLParser parser;
+    if (!parser.loadFromFile("samples/template.exml")) return false;
+    const int rows = parser.getLayoutConfig().rows;
+    const int columns = parser.getLayoutConfig().columns;
+
+    auto consistent = [&]() {
+        for (int page = 0; page < 2; ++page) {
+            const auto items = parser.getHomeItems(page);
+            for (int y = -1; y <= rows; ++y) {
+                for (int x = -1; x <= columns; ++x) {
+                    const bool inGrid = x >= 0 && y >= 0 && x < columns && y < rows;
+                    const int expected = inGrid ? scanOccupant(items, x, y) : -1;
+                    exml::ItemLocation location{};
+                    const bool occupied = parser.occupiedBy(exml::LayoutArea::HOME, page, x, y, location);
+                    if (parser.isCellFree(exml::LayoutArea::HOME, page, x, y) != (inGrid && expected < 0) ||
+                        occupied != (expected >= 0) ||
+                        (occupied && static_cast<int>(location.index) != expected)) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+
+    bool ok = consistent();
+    unsigned int seed = 11;
+    int added = 0;
+    for (int step = 0; ok && step < 300; ++step) {
+        seed = seed * 1103515245u + 12345u;
+        const int page = (seed >> 20) % 2;
+        exml::Item item;
+        item.packageName = "com.example.grid" + std::to_string(added);
+        item.className = item.packageName + ".Main";
+        item.x = (seed >> 8) % columns;
+        item.y = (seed >> 12) % rows;
+        item.spanX = 1 + (seed >> 16) % 2;
+        item.spanY = 1 + (seed >> 18) % 2;
+
+        // canPlace与暴力检查一致
+        bool free = item.x + item.spanX <= columns && item.y + item.spanY <= rows;
+        const auto items = parser.getHomeItems(page);
+        for (int y = item.y; free && y < item.y + item.spanY; ++y) {
+            for (int x = item.x; free && x < item.x + item.spanX; ++x) free = scanOccupant(items, x, y) < 0;
+        }
+        ok = parser.canPlace(exml::LayoutArea::HOME, page, item) == free;
+
+        switch ((seed >> 4) % 4) {
+            case 0:
+            case 1: parser.addHomeItem(page, item); ++added; break;
+            case 2:
+                if (!items.empty()) {
+                    const exml::Item& victim = items[(seed >> 8) % items.size()];
+                    parser.removeHomeItem(page, victim.packageName, victim.className);
+                }
+                break;
+            case 3: parser.moveHomeItem(page, 0, 1 - page, (seed >> 8) % 4); break;
+        }
+        ok = ok && consistent();
+    }
+
+    // 行列数变化后按新尺寸重建；非网格区域没有单元格
+    exml::LayoutConfig config = parser.getLayoutConfig();
+    config.columns = columns + 1;
+    parser.setLayoutConfig(config);
+    ok = ok && parser.isCellFree(exml::LayoutArea::HOME, 5, columns, 0) &&
+         !parser.isCellFree(exml::LayoutArea::HOTSEAT, 0, 0, 0);
+
+    std::cout << (ok ? "Occupancy grid matches brute-force scans" : "FAILED: occupancy grid") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testAutoPlacement() {
+    std::cout << "=== Auto Placement Test ===" << std::endl;
+    exml::EXMLParser parser;
+    if (!parser.loadFromFile("samples/template.exml")) return false;
+    const int rows = parser.getLayoutConfig().rows;
+    const int columns = parser.getLayoutConfig().columns;
+
+    // 反复放置直到新建页面，每次放置前位置必须空闲，放置后不与任何项目重叠
+    bool ok = true;
+    const size_t initialPages = parser.getHomePageCount();
+    for (int i = 0; ok && parser.getHomePageCount() == initialPages; ++i) {
+        exml::Item item;
+        item.packageName = "com.example.place" + std::to_string(i);
+        item.className = item.packageName + ".Main";
+        item.spanX = i % 3 == 0 ? 2 : 1;
+        item.spanY = i % 3 == 0 ? 2 : 1;
+        exml::Placement placement;
+        exml::ItemLocation location{};
+        ok = parser.findPlacement(exml::LayoutArea::HOME, item.spanX, item.spanY, placement);
+        item.x = placement.x;
+        item.y = placement.y;
+        ok = ok && parser.canPlace(exml::LayoutArea::HOME, placement.page, item) &&
+             parser.placeItem(exml::LayoutArea::HOME, item, exml::PlacementStrategy::FIRST_FIT, &location);
+        const exml::ItemRef placed = parser.getItem(location);
+        ok = ok && placed && placed.packageName() == item.packageName && placed.screen() == placement.page &&
+             placed.x() == placement.x && placed.y() == placement.y;
+        for (int y = placement.y; ok && y < placement.y + item.spanY; ++y) {
+            for (int x = placement.x; ok && x < placement.x + item.spanX; ++x) {
+                ok = scanOccupant(parser.getHomeItems(placement.page), x, y) == static_cast<int>(location.index);
+            }
+        }
+    }
+    ok = ok && parser.getHomePageCount() == initialPages + 1 &&
+         parser.getLayoutConfig().pageCount == static_cast<int>(initialPages) + 1;
+
+    // 最贴合：1×1放进被占满单元格包围的空洞，而不是空旷的角落
+    exml::EXMLParser grid;
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < columns; ++x) {
+            if ((x == 1 && y == 1) || y >= 3) continue;
+            exml::Item filler;
+            filler.x = x;
+            filler.y = y;
+            grid.addHomeItem(0, filler);
+        }
+    }
+    exml::Placement first;
+    exml::Placement best;
+    ok = ok && grid.findPlacement(exml::LayoutArea::HOME, 1, 1, first) &&
+         grid.findPlacement(exml::LayoutArea::HOME, 1, 1, best, exml::PlacementStrategy::BEST_FIT) &&
+         first.page == 0 && first.x == 1 && first.y == 1 && best.x == 1 && best.y == 1;
+    ok = ok && grid.findPlacement(exml::LayoutArea::HOME, 2, 2, best, exml::PlacementStrategy::BEST_FIT) &&
+         best.page == 0 && best.y == 3 && (best.x == 0 || best.x == columns - 2);
+
+    // 超出网格尺寸或非网格区域无法放置
+    exml::Placement none;
+    ok = ok && !grid.findPlacement(exml::LayoutArea::HOME, columns + 1, 1, none) &&
+         !grid.findPlacement(exml::LayoutArea::APP_ORDER, 1, 1, none);
+
+    std::cout << (ok ? "Auto placement fills free slots without collisions" : "FAILED: auto placement") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+size_t countEdits(const exml::LayoutDiff& changes, exml::EditKind kind, exml::LayoutArea area) {
+    size_t count = 0;
+    for (const auto& edit : changes.items) {
+        const exml::ItemPath& path = kind == exml::EditKind::REMOVED ? edit.from : edit.to;
+        if (edit.kind == kind && path.location.area == area) ++count;
+    }
+    return count;
+}
+
+bool testLayoutDiff() {
+    std::cout << "=== Layout Diff Test ===" << std::endl;
+    exml::EXMLParser before;
+    exml::EXMLParser after;
+    if (!before.loadFromFile("samples/template.exml") || !after.loadFromFile("samples/template.exml")) return false;
+    bool ok = exml::diff(before, after).empty();
+
+    exml::LayoutConfig config = after.getLayoutConfig();
+    config.rows = 6;
+    after.setLayoutConfig(config);
+
+    exml::Item added;
+    added.packageName = "com.example.added";
+    added.className = "com.example.added.Main";
+    after.addHotseatItem(added);
+
+    exml::Item removed;
+    for (const auto& item : after.getAppOrderItems()) {
+        if (item.type != exml::ItemType::FOLDER) {
+            removed = item;
+            break;
+        }
+    }
+    after.removeAppOrderItem(removed.packageName, removed.className);
+
+    const exml::Item moved = after.getHomeItems(0)[0];
+    after.moveHomeItem(0, 0, 1, 0);
+
+    // 文件夹改名并多一个应用：删除后把修改过的副本放回同一页
+    exml::Item folder;
+    for (const auto& item : after.getHomeItems(0)) {
+        if (item.type == exml::ItemType::FOLDER) folder = item;
+    }
+    folder.title = "Renamed";
+    folder.favorites.push_back(added);
+    after.removeHomeItem(0, "", "");
+    after.addHomeItem(0, folder);
+
+    const exml::LayoutDiff changes = exml::diff(before, after);
+    ok = ok && changes.config.size() == 1 && changes.config[0].tag == "Rows" &&
+         changes.config[0].oldValue == "5" && changes.config[0].newValue == "6";
+    ok = ok && changes.items.size() == 5 &&
+         countEdits(changes, exml::EditKind::ADDED, exml::LayoutArea::HOTSEAT) == 1 &&
+         countEdits(changes, exml::EditKind::REMOVED, exml::LayoutArea::APP_ORDER) == 1 &&
+         countEdits(changes, exml::EditKind::MOVED, exml::LayoutArea::HOME) == 1 &&
+         countEdits(changes, exml::EditKind::MODIFIED, exml::LayoutArea::HOME) == 1 &&
+         countEdits(changes, exml::EditKind::ADDED, exml::LayoutArea::HOME) == 1;
+    for (const auto& edit : changes.items) {
+        if (edit.kind == exml::EditKind::MOVED) {
+            ok = ok && edit.from.location.page == 0 && edit.to.location.page == 1 &&
+                 after.getItem(edit.to.location).packageName() == moved.packageName;
+        } else if (edit.kind == exml::EditKind::MODIFIED) {
+            ok = ok && edit.changedAttributes == exml::ATTR_TITLE;
+        } else if (edit.kind == exml::EditKind::ADDED && edit.to.location.area == exml::LayoutArea::HOME) {
+            ok = ok && edit.to.child == static_cast<int>(folder.favorites.size()) - 1;
+        } else if (edit.kind == exml::EditKind::REMOVED) {
+            ok = ok && before.getItem(edit.from.location).packageName() == removed.packageName;
+        }
+    }
+
+    const std::string script = exml::formatDiff(changes, before, after);
+    std::cout << script;
+    ok = ok && script.find("~ Rows: 5 -> 6") != std::string::npos &&
+         script.find("+ hotseat[0:") != std::string::npos && script.find("{title}") != std::string::npos;
+
+    // 有序列表中只改变顺序也是移动，只报告被移动的项目
+    exml::EXMLParser reordered;
+    ok = ok && reordered.loadFromFile("samples/template.exml") && reordered.moveAppOrderItem(1, 6);
+    const exml::LayoutDiff reorder = exml::diff(before, reordered);
+    ok = ok && reorder.items.size() == 1 && reorder.items[0].kind == exml::EditKind::MOVED &&
+         reorder.items[0].from.location.area == exml::LayoutArea::APP_ORDER &&
+         reorder.items[0].from.location.index == 1 && reorder.items[0].to.location.index == 6 &&
+         reorder.items[0].changedAttributes == 0;
+    ok = ok && reordered.moveAppOrderItem(6, 1) && reordered.moveHotseatItem(0, 2) &&
+         countEdits(exml::diff(before, reordered), exml::EditKind::MOVED, exml::LayoutArea::HOTSEAT) == 1;
+
+    std::cout << (ok ? "Diff reports every change" : "FAILED: layout diff") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+const exml::Item* findByPackage(const std::vector<exml::Item>& items, const std::string& packageName) {
+    for (const auto& item : items) {
+        if (item.packageName == packageName) return &item;
+    }
+    return nullptr;
+}
+
+size_t countConflicts(const std::vector<exml::MergeConflict>& conflicts, exml::ConflictKind kind) {
+    return static_cast<size_t>(std::count_if(conflicts.begin(), conflicts.end(),
+                                             [kind](const exml::MergeConflict& c) { return c.kind == kind; }));
+}
+
+// 按位置替换第0页的文件夹：删除接口按名字匹配第一个项目，先把文件夹移到页首，
+// 保证删除的就是它而不是其他名字同为空的项目
+bool renameFolder(exml::EXMLParser& parser, const std::string& title) {
+    const std::vector<exml::Item> page = parser.getHomeItems(0);
+    int index = -1;
+    for (size_t i = 0; i < page.size(); ++i) {
+        if (page[i].type == exml::ItemType::FOLDER) index = static_cast<int>(i);
+    }
+    if (index < 0 || !parser.moveHomeItem(0, index, 0, 0)) return false;
+    exml::Item folder = page[index];
+    const exml::ItemRef first = parser.getItem(exml::ItemLocation{exml::LayoutArea::HOME, 0, 0});
+    if (!first || first.type() != exml::ItemType::FOLDER || first.title() != folder.title ||
+        !parser.removeHomeItem(0, folder.packageName, folder.className)) {
+        return false;
+    }
+    folder.title = title;
+    return parser.addHomeItem(0, std::move(folder));
+}
+
+// 一方删除、另一方未修改或修改了同一项目
+bool testMergeDeletions() {
+    exml::EXMLParser base;
+    exml::EXMLParser deleted;
+    exml::EXMLParser unchanged;
+    exml::EXMLParser modified;
+    if (!base.loadFromFile("samples/template.exml") || !deleted.loadFromFile("samples/template.exml") ||
+        !unchanged.loadFromFile("samples/template.exml") || !modified.loadFromFile("samples/template.exml")) {
+        return false;
+    }
+    const exml::Item target = base.getAppOrderItems()[2];
+    deleted.removeAppOrderItem(target.packageName, target.className);
+    exml::Item renamed = target;
+    renamed.title = "Renamed";
+    modified.removeAppOrderItem(target.packageName, target.className);
+    modified.addAppOrderItem(renamed);
+
+    exml::EXMLParser result;
+    std::vector<exml::MergeConflict> conflicts;
+    exml::MergeOptions oursFirst;
+    oursFirst.preferred = exml::MergeSide::OURS;
+
+    // 删除与未修改：无论哪一方删除，结果中都不再有该项目，且不是冲突
+    bool ok = exml::merge(base, deleted, unchanged, result, conflicts) && conflicts.empty() &&
+              !findByPackage(result.getAppOrderItems(), target.packageName);
+    ok = ok && exml::merge(base, unchanged, deleted, result, conflicts) && conflicts.empty() &&
+         !findByPackage(result.getAppOrderItems(), target.packageName);
+
+    // 删除与修改：报告ITEM冲突，按优先一方保留修改后的项目或删除
+    ok = ok && exml::merge(base, modified, deleted, result, conflicts) && conflicts.size() == 1 &&
+         conflicts[0].kind == exml::ConflictKind::ITEM && conflicts[0].ours.page == -1;
+    std::vector<exml::Item> appOrder = result.getAppOrderItems();
+    const exml::Item* kept = findByPackage(appOrder, target.packageName);
+    ok = ok && kept && kept->title == "Renamed";
+    ok = ok && exml::merge(base, modified, deleted, result, conflicts, oursFirst) && conflicts.size() == 1 &&
+         !findByPackage(result.getAppOrderItems(), target.packageName);
+    ok = ok && exml::merge(base, deleted, modified, result, conflicts) && conflicts.size() == 1 &&
+         conflicts[0].theirs.page == -1 && !findByPackage(result.getAppOrderItems(), target.packageName);
+    ok = ok && exml::merge(base, deleted, modified, result, conflicts, oursFirst) && conflicts.size() == 1;
+    appOrder = result.getAppOrderItems();
+    kept = findByPackage(appOrder, target.packageName);
+    return ok && kept && kept->title == "Renamed";
+}
+
+// 让位的一方不能与双方都未移动的项目重叠
+bool testMergeBaseOccupancy() {
+    exml::EXMLParser base;
+    exml::EXMLParser theirs;
+    exml::EXMLParser ours;
+    if (!base.loadFromFile("samples/template.exml") || !theirs.loadFromFile("samples/template.exml") ||
+        !ours.loadFromFile("samples/template.exml")) {
+        return false;
+    }
+    // ours把一个应用移到另一个双方都未改动的应用所在的单元格
+    const std::vector<exml::Item> page = base.getHomeItems(1);
+    exml::Item mover = page[1];
+    const exml::Item& holder = page[2];
+    ours.removeHomeItem(1, mover.packageName, mover.className);
+    mover.x = holder.x;
+    mover.y = holder.y;
+    ours.addHomeItem(1, mover);
+
+    exml::EXMLParser result;
+    std::vector<exml::MergeConflict> conflicts;
+    bool ok = exml::merge(base, theirs, ours, result, conflicts) && conflicts.size() == 1 &&
+              conflicts[0].kind == exml::ConflictKind::CELL && conflicts[0].relocated.page >= 0;
+    const std::vector<exml::Item> merged = result.getHomeItems(1);
+    const exml::Item* stayed = findByPackage(merged, holder.packageName);
+    const exml::ItemRef placed = result.getItem(conflicts.empty() ? exml::ItemLocation{} : conflicts[0].relocated);
+    return ok && stayed && stayed->x == holder.x && stayed->y == holder.y && placed &&
+           placed.packageName() == mover.packageName &&
+           !(conflicts[0].relocated.page == 1 && placed.x() == holder.x && placed.y() == holder.y);
+}
+
+bool testThreeWayMerge() {
+    std::cout << "=== Three-Way Merge Test ===" << std::endl;
+    exml::EXMLParser base;
+    exml::EXMLParser theirs;
+    exml::EXMLParser ours;
+    if (!base.loadFromFile("samples/template.exml") || !theirs.loadFromFile("samples/template.exml") ||
+        !ours.loadFromFile("samples/template.exml")) {
+        return false;
+    }
+
+    // 无修改时合并结果与输入逐字节相同（含未识别的顶层元素与空白）
+    exml::EXMLParser result;
+    std::vector<exml::MergeConflict> conflicts;
+    bool ok = exml::merge(base, theirs, ours, result, conflicts) && conflicts.empty() &&
+              exml::diff(base, result).empty();
+    std::string merged;
+    result.saveToString(merged);
+    ok = ok && merged == readFile("samples/template.exml");
+    ok = ok && !exml::merge(base, theirs, ours, ours, conflicts);
+
+    // 双方在同一空位添加不同的应用
+    exml::Placement cell;
+    ok = ok && base.findPlacement(exml::LayoutArea::HOME, 1, 1, cell, exml::PlacementStrategy::FIRST_FIT);
+    exml::Item managed;
+    managed.packageName = "com.corp.portal";
+    managed.className = "com.corp.portal.Main";
+    managed.screen = cell.page;
+    managed.x = cell.x;
+    managed.y = cell.y;
+    exml::Item personal = managed;
+    personal.packageName = "com.example.game";
+    personal.className = "com.example.game.Main";
+    theirs.addHomeItem(cell.page, managed);
+    ours.addHomeItem(cell.page, personal);
+
+    // 双方占用同一快捷栏位置
+    exml::Item dock;
+    dock.screen = 5;
+    dock.packageName = "com.corp.mail";
+    theirs.addHotseatItem(dock);
+    dock.packageName = "com.example.music";
+    ours.addHotseatItem(dock);
+
+    // 双方修改同一文件夹
+    ok = ok && renameFolder(theirs, "Managed") && renameFolder(ours, "Mine");
+
+    // 互不冲突的修改
+    const exml::Item removed = theirs.getAppOrderItems()[1];
+    theirs.removeAppOrderItem(removed.packageName, removed.className);
+    exml::LayoutConfig config = theirs.getLayoutConfig();
+    config.screenIndex = 1;
+    theirs.setLayoutConfig(config);
+    // ours把一个项目移到第二页的空位
+    exml::Item moved = ours.getHomeItems(0)[0];
+    ours.removeHomeItem(0, moved.packageName, moved.className);
+    moved.screen = 1;
+    for (moved.y = 0; !ours.canPlace(exml::LayoutArea::HOME, 1, moved); ++moved.y) {
+        for (moved.x = 0; moved.x < ours.getLayoutConfig().columns; ++moved.x) {
+            if (ours.canPlace(exml::LayoutArea::HOME, 1, moved)) break;
+        }
+        if (moved.x < ours.getLayoutConfig().columns) break;
+    }
+    ours.addHomeItem(1, moved);
+
+    ok = ok && exml::merge(base, theirs, ours, result, conflicts);
+    ok = ok && conflicts.size() == 3 && countConflicts(conflicts, exml::ConflictKind::CELL) == 1 &&
+         countConflicts(conflicts, exml::ConflictKind::HOTSEAT_SLOT) == 1 &&
+         countConflicts(conflicts, exml::ConflictKind::FOLDER) == 1;
+    for (const auto& conflict : conflicts) {
+        if (conflict.kind == exml::ConflictKind::CELL) {
+            // theirs优先：managed保留原位，personal移到空位
+            const std::vector<exml::Item> page = result.getHomeItems(cell.page);
+            const exml::Item* kept = findByPackage(page, "com.corp.portal");
+            const exml::ItemRef placed = result.getItem(conflict.relocated);
+            ok = ok && kept && kept->x == cell.x && kept->y == cell.y && placed &&
+                 placed.packageName() == "com.example.game" && !(placed.x() == cell.x && placed.y() == cell.y &&
+                                                                 conflict.relocated.page == cell.page);
+        } else if (conflict.kind == exml::ConflictKind::HOTSEAT_SLOT) {
+            const exml::ItemRef placed = result.getItem(conflict.relocated);
+            ok = ok && placed && placed.packageName() == "com.example.music" && placed.screen() == 6;
+        }
+    }
+
+    bool folderKept = false;
+    for (const auto& item : result.getHomeItems(0)) {
+        if (item.type == exml::ItemType::FOLDER) folderKept = item.title == "Managed";
+    }
+    const std::vector<exml::Item> appOrder = result.getAppOrderItems();
+    const std::vector<exml::Item> firstPage = result.getHomeItems(0);
+    const std::vector<exml::Item> secondPage = result.getHomeItems(1);
+    ok = ok && folderKept && result.getLayoutConfig().screenIndex == 1 &&
+         !findByPackage(appOrder, removed.packageName) && findByPackage(secondPage, moved.packageName) &&
+         !findByPackage(firstPage, moved.packageName);
+    // 有修改时同样保留ours中未识别的顶层元素
+    merged.clear();
+    result.saveToString(merged);
+    ok = ok && merged.find("<minusOnePageChangedApp") != std::string::npos &&
+         merged.find("<Rows_homeOnly") != std::string::npos;
+
+    // ours优先时由theirs的项目让位
+    exml::MergeOptions options;
+    options.preferred = exml::MergeSide::OURS;
+    ok = ok && exml::merge(base, theirs, ours, result, conflicts, options) && conflicts.size() == 3;
+    const std::vector<exml::Item> cellPage = result.getHomeItems(cell.page);
+    const exml::Item* mine = findByPackage(cellPage, "com.example.game");
+    ok = ok && mine && mine->x == cell.x && mine->y == cell.y;
+
+    ok = ok && testMergeDeletions() && testMergeBaseOccupancy();
+
+    std::cout << (ok ? "Merge applies both sides and reports conflicts" : "FAILED: three-way merge") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testFingerprints() {
+    std::cout << "=== Fingerprint Test ===" << std::endl;
+    using exml::LayoutArea;
+
+    // 属性顺序与空白不影响指纹
+    const std::string compact =
+        "<home><favorite screen=\"0\" packageName=\"a.b\" className=\"a.b.C\" x=\"1\" y=\"2\" /></home>"
+        "<Rows>5</Rows>";
+    const std::string spaced =
+        "<home>\n    <favorite y=\"2\"  x=\"1\" className=\"a.b.C\"\n packageName=\"a.b\" screen=\"0\"/>\n</home>\n"
+        "<Rows>5</Rows>\n";
+    exml::EXMLParser first;
+    exml::EXMLParser second;
+    bool ok = first.loadFromMemory(compact.data(), compact.size()) &&
+              second.loadFromMemory(spaced.data(), spaced.size()) &&
+              first.getLayoutFingerprint() == second.getLayoutFingerprint() &&
+              first.getPageFingerprint(LayoutArea::HOME, 0) == second.getPageFingerprint(LayoutArea::HOME, 0);
+
+    exml::EXMLParser parser;
+    exml::EXMLParser reference;
+    if (!parser.loadFromFile("samples/template.exml") || !reference.loadFromFile("samples/template.exml")) return false;
+    const exml::Fingerprint layout = parser.getLayoutFingerprint();
+    const exml::Fingerprint home = parser.getAreaFingerprint(LayoutArea::HOME);
+    const exml::Fingerprint page0 = parser.getPageFingerprint(LayoutArea::HOME, 0);
+    const exml::Fingerprint page1 = parser.getPageFingerprint(LayoutArea::HOME, 1);
+    const exml::Fingerprint appOrder = parser.getAreaFingerprint(LayoutArea::APP_ORDER);
+    ok = ok && layout == reference.getLayoutFingerprint() && page0 != page1 &&
+         parser.getPageFingerprint(LayoutArea::HOME, 7) == exml::Fingerprint();
+
+    // 增量维护：只影响被修改的页面，撤销后复原
+    exml::Item item;
+    item.packageName = "com.example.fingerprint";
+    item.className = "com.example.fingerprint.Main";
+    item.screen = 1;
+    parser.addHomeItem(1, item);
+    ok = ok && parser.getPageFingerprint(LayoutArea::HOME, 0) == page0 &&
+         parser.getPageFingerprint(LayoutArea::HOME, 1) != page1 &&
+         parser.getAreaFingerprint(LayoutArea::HOME) != home && parser.getLayoutFingerprint() != layout;
+    reference.addHomeItem(1, item);
+    ok = ok && parser.getAreaFingerprint(LayoutArea::HOME) == reference.getAreaFingerprint(LayoutArea::HOME);
+    parser.removeHomeItem(1, item.packageName, item.className);
+    ok = ok && parser.getAreaFingerprint(LayoutArea::HOME) == home && parser.getLayoutFingerprint() == layout;
+
+    // 移到另一页改变两页的指纹；页内顺序不影响指纹
+    parser.moveHomeItem(0, 0, 1, 0);
+    ok = ok && parser.getPageFingerprint(LayoutArea::HOME, 0) != page0 &&
+         parser.getPageFingerprint(LayoutArea::HOME, 1) != page1;
+    parser.moveHomeItem(1, 0, 0, 0);
+    parser.moveHomeItem(0, 0, 0, 1);
+    ok = ok && parser.getAreaFingerprint(LayoutArea::HOME) == home;
+
+    // 快捷栏与AppOrder的顺序有意义
+    const exml::Fingerprint hotseat = parser.getAreaFingerprint(LayoutArea::HOTSEAT);
+    ok = ok && parser.moveHotseatItem(0, 2) && parser.getAreaFingerprint(LayoutArea::HOTSEAT) != hotseat;
+    ok = ok && parser.moveHotseatItem(2, 0) && parser.getAreaFingerprint(LayoutArea::HOTSEAT) == hotseat;
+    parser.moveAppOrderItem(0, 1);
+    ok = ok && parser.getAreaFingerprint(LayoutArea::APP_ORDER) != appOrder;
+    parser.moveAppOrderItem(1, 0);
+    ok = ok && parser.getAreaFingerprint(LayoutArea::APP_ORDER) == appOrder;
+
+    // 文件夹的指纹包含其中的项目
+    exml::ItemLocation folder{LayoutArea::HOME, 0, 0};
+    exml::ItemLocation referenceFolder{LayoutArea::HOME, 0, 0};
+    for (size_t i = 0; i < parser.getHomeItems(0).size(); ++i) {
+        if (parser.getHomeItems(0)[i].type == exml::ItemType::FOLDER) folder.index = i;
+        if (reference.getHomeItems(0)[i].type == exml::ItemType::FOLDER) referenceFolder.index = i;
+    }
+    exml::Item changed = parser.getItem(folder).toItem();
+    changed.favorites.pop_back();
+    exml::Item copy = parser.getItem(folder).toItem();
+    ok = ok && parser.getItemFingerprint(folder) != exml::Fingerprint() &&
+         parser.getItemFingerprint(folder) == reference.getItemFingerprint(referenceFolder);
+    parser.removeHomeItem(0, "", "");
+    parser.addHomeItem(0, changed);
+    const exml::ItemLocation last{LayoutArea::HOME, 0, parser.getHomeItems(0).size() - 1};
+    ok = ok && parser.getItemFingerprint(last) != reference.getItemFingerprint(referenceFolder);
+    parser.removeHomeItem(0, "", "");
+    parser.addHomeItem(0, copy);
+    ok = ok && parser.getLayoutFingerprint() == layout;
+
+    exml::LayoutConfig config = parser.getLayoutConfig();
+    config.screenIndex = 1;
+    parser.setLayoutConfig(config);
+    ok = ok && parser.getConfigFingerprint() != reference.getConfigFingerprint();
+
+    std::cout << (ok ? "Fingerprints follow content, not formatting" : "FAILED: fingerprints") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testLayoutStore() {
+    std::cout << "=== Layout Store Test ===" << std::endl;
+    using exml::LayoutArea;
+    exml::EXMLParser a;
+    exml::EXMLParser b;
+    if (!a.loadFromFile("samples/template.exml") || !b.loadFromFile("samples/template.exml")) return false;
+    exml::Item item;
+    item.packageName = "com.example.store";
+    item.className = "com.example.store.Main";
+    item.screen = 1;
+    b.addHomeItem(1, item);
+
+    exml::LayoutStore store;
+    store.put("device-a", a);
+    const size_t chunks = store.getChunkCount();
+    const size_t items = store.getStoredItemCount();
+    store.put("device-b", b);
+
+    // 只多出b中改变的一页
+    bool ok = store.getLayoutCount() == 2 && store.getChunkCount() == chunks + 1 &&
+              store.getStoredItemCount() == items + b.getHomeItems(1).size();
+    std::cout << "Stored " << store.getStoredItemCount() << " items for 2 layouts in " << store.getChunkCount()
+              << " chunks" << std::endl;
+
+    exml::EXMLParser restored;
+    ok = ok && store.restore("device-b", restored) && restored.getLayoutFingerprint() == b.getLayoutFingerprint();
+    ok = ok && store.restore("device-a", restored) && restored.getLayoutFingerprint() == a.getLayoutFingerprint();
+
+    const std::vector<std::string> shared = store.findLayouts(a.getPageFingerprint(LayoutArea::HOME, 0));
+    const std::vector<std::string> changed = store.findLayouts(b.getPageFingerprint(LayoutArea::HOME, 1));
+    ok = ok && shared == std::vector<std::string>{"device-a", "device-b"} &&
+         changed == std::vector<std::string>{"device-b"} &&
+         store.findLayouts(a.getConfigFingerprint()).size() == 2 && store.findLayouts(exml::Fingerprint()).empty();
+
+    const std::vector<exml::ChunkRef> refs = store.getChunks("device-b");
+    ok = ok && !refs.empty() && refs[0].area == LayoutArea::HOME && refs[0].page == 0 &&
+         refs[0].chunk == b.getPageFingerprint(LayoutArea::HOME, 0);
+
+    // 删除与替换时释放不再被引用的块
+    ok = ok && store.remove("device-a") && !store.contains("device-a") && !store.restore("device-a", restored) &&
+         store.getChunkCount() == chunks && store.restore("device-b", restored) &&
+         restored.getLayoutFingerprint() == b.getLayoutFingerprint();
+    store.put("device-b", a);
+    ok = ok && store.getLayoutCount() == 1 && store.getChunkCount() == chunks && store.getStoredItemCount() == items &&
+         store.findLayouts(b.getPageFingerprint(LayoutArea::HOME, 1)).empty();
+
+    // 恢复的布局逐字节复原：未识别的顶层元素、空白，以及与共享块不同的页内顺序
+    const std::string original = readFile("samples/template.exml");
+    std::string restoredText;
+    ok = ok && store.restore("device-b", restored);
+    restored.saveToString(restoredText);
+    ok = ok && restoredText == original;
+
+    exml::EXMLParser reordered;
+    std::string reorderedText;
+    ok = ok && reordered.loadFromFile("samples/template.exml") && reordered.moveHomeItem(0, 0, 0, 3);
+    reordered.saveToString(reorderedText);
+    store.put("reordered", reordered);
+    restoredText.clear();
+    ok = ok && reorderedText != original &&
+         store.getChunks("reordered")[0].chunk == a.getPageFingerprint(LayoutArea::HOME, 0) &&
+         store.restore("reordered", restored);
+    restored.saveToString(restoredText);
+    ok = ok && restoredText == reorderedText;
+
+    std::cout << (ok ? "Store shares identical chunks" : "FAILED: layout store") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testSnapshot() {
+    std::cout << "=== Binary Snapshot Test ===" << std::endl;
+    exml::EXMLParser original;
+    if (!original.loadFromFile("samples/template.exml")) return false;
+    std::string expected;
+    original.saveToString(expected);
+
+    std::string snapshot;
+    original.saveSnapshotToString(snapshot);
+    exml::EXMLParser loaded;
+    bool ok = loaded.loadSnapshotFromMemory(snapshot.data(), snapshot.size());
+    std::string resaved;
+    loaded.saveToString(resaved);
+    ok = ok && loaded.getLayoutFingerprint() == original.getLayoutFingerprint() && resaved == expected;
+    std::cout << "Snapshot size: " << snapshot.size() << " bytes (EXML: " << expected.size() << " bytes)"
+              << std::endl;
+
+    // 由快照加载的布局可以继续修改
+    exml::Item item;
+    item.packageName = "com.example.snapshot";
+    item.className = "com.example.snapshot.Main";
+    ok = ok && loaded.addHotseatItem(item) && loaded.findHotseatItems("com.example.snapshot").size() == 1;
+
+    const std::string path = (std::filesystem::temp_directory_path() / "exml_snapshot.bin").string();
+    exml::EXMLParser fromFile;
+    ok = ok && loaded.saveSnapshot(path) && fromFile.loadSnapshot(path) &&
+         fromFile.getLayoutFingerprint() == loaded.getLayoutFingerprint();
+    std::filesystem::remove(path);
+
+    // 魔数、版本不符与截断的数据被拒绝，解析器保持为空
+    std::string broken = snapshot;
+    broken[0] = 'X';
+    ok = ok && !fromFile.loadSnapshotFromMemory(broken.data(), broken.size()) && fromFile.getHotseatItemCount() == 0 && fromFile.getHomePageCount() == 0;
+    broken = snapshot;
+    broken[8] = 2;
+    ok = ok && !fromFile.loadSnapshotFromMemory(broken.data(), broken.size()) &&
+         fromFile.getLastError().find("version") != std::string::npos;
+    for (size_t size : {snapshot.size() - 1, snapshot.size() / 2, size_t(12)}) {
+        ok = ok && !fromFile.loadSnapshotFromMemory(snapshot.data(), size);
+    }
+
+    // 文件夹内的应用再含子项的快照被拒绝（XML加载不会产生这种结构）
+    exml::Item nested;
+    nested.type = exml::ItemType::FOLDER;
+    nested.favorites.resize(1);
+    nested.favorites[0].favorites.resize(1);
+    exml::EXMLParser crafted;
+    std::string craftedSnapshot;
+    crafted.addHotseatItem(nested);
+    crafted.saveSnapshotToString(craftedSnapshot);
+    ok = ok && !craftedSnapshot.empty() && !fromFile.loadSnapshotFromMemory(craftedSnapshot.data(), craftedSnapshot.size());
+
+    std::cout << (ok ? "Snapshot reproduces the layout" : "FAILED: binary snapshot") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testLayoutCache() {
+    std::cout << "=== Layout Cache Test ===" << std::endl;
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::string first = (dir / "exml_cache_a.exml").string();
+    const std::string second = (dir / "exml_cache_b.exml").string();
+    std::filesystem::copy_file("samples/template.exml", first, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::copy_file("samples/template.exml", second, std::filesystem::copy_options::overwrite_existing);
+
+    exml::LayoutCache cache;
+    std::shared_ptr<const exml::EXMLParser> a = cache.load(first);
+    std::shared_ptr<const exml::EXMLParser> again = cache.load(first);
+    bool ok = a && again == a && cache.getStats().hits == 1 && cache.getStats().misses == 1 &&
+              cache.getEntryCount() == 1 && cache.getMemoryUsage() > 0;
+    ok = ok && !a->locateAppOrderItems("com.android.settings").empty();
+    // 估算包含解析器独占的字符串池
+    ok = ok && cache.getMemoryUsage() > a->getStringPool()->memoryUsage();
+
+    // 文件改变后重新解析，之前返回的布局不受影响
+    std::ofstream(first, std::ios::app) << "\n";
+    std::shared_ptr<const exml::EXMLParser> changed = cache.load(first);
+    ok = ok && changed && changed != a && cache.getEntryCount() == 1 &&
+         changed->getLayoutFingerprint() == a->getLayoutFingerprint();
+
+    // 内存上限只够一个布局时淘汰最久未使用的
+    cache.setByteBudget(cache.getMemoryUsage());
+    std::shared_ptr<const exml::EXMLParser> b = cache.load(second);
+    ok = ok && b && cache.getEntryCount() == 1 && cache.getStats().evictions == 1 && cache.load(second) == b &&
+         cache.load(first) != changed;
+    std::cout << "Cached layout: " << cache.getMemoryUsage() << " bytes (estimated)" << std::endl;
+
+    std::string error;
+    ok = ok && !cache.load((dir / "exml_cache_missing.exml").string(), &error) && !error.empty();
+    cache.setByteBudget(0);
+    ok = ok && cache.getEntryCount() == 0 && cache.load(second) && cache.getEntryCount() == 0;
+
+    // 按内容缓存：内容相同的不同路径共享同一结果
+    exml::CacheOptions options;
+    options.validation = exml::CacheValidation::CONTENT_HASH;
+    exml::LayoutCache byContent(options);
+    std::filesystem::copy_file("samples/template.exml", first, std::filesystem::copy_options::overwrite_existing);
+    ok = ok && byContent.load(first) && byContent.load(first) == byContent.load(second) &&
+         byContent.getEntryCount() == 1 && byContent.invalidate(second) && byContent.getEntryCount() == 0;
+    // DOM模式同样解析计算键时读入的内容
+    options.load.mode = exml::LoadMode::DOM;
+    exml::LayoutCache domByContent(options);
+    std::shared_ptr<const exml::EXMLParser> dom = domByContent.load(first);
+    ok = ok && dom && dom->getLayoutFingerprint() == a->getLayoutFingerprint() && domByContent.load(second) == dom;
+
+    std::filesystem::remove(first);
+    std::filesystem::remove(second);
+    std::cout << (ok ? "Cache reuses parsed layouts" : "FAILED: layout cache") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testSectionSelectiveLoad() {
+    std::cout << "=== Section-Selective Load Test ===" << std::endl;
+    using exml::LayoutArea;
+    exml::EXMLParser full;
+    if (!full.loadFromFile("samples/template.exml")) return false;
+    std::string expected;
+    full.saveToString(expected);
+
+    exml::LoadOptions options;
+    options.sections = exml::SECTION_APP_ORDER;
+    exml::EXMLParser lazy;
+    bool ok = lazy.loadFromFile("samples/template.exml", options) && lazy.isSectionLoaded(LayoutArea::APP_ORDER) &&
+              !lazy.isSectionLoaded(LayoutArea::HOME) && !lazy.isSectionLoaded(LayoutArea::HOTSEAT);
+    ok = ok && lazy.getAppOrderItemCount() == full.getAppOrderItemCount() && !lazy.isSectionLoaded(LayoutArea::HOME) &&
+         lazy.getLayoutConfig().rows == full.getLayoutConfig().rows;
+
+    // 首次访问时解析推迟的区域
+    ok = ok && lazy.getHomePageCount() == full.getHomePageCount() && lazy.isSectionLoaded(LayoutArea::HOME) &&
+         !lazy.isSectionLoaded(LayoutArea::HOTSEAT);
+    ok = ok && lazy.locateHotseatItems("com.android.settings").size() ==
+                   full.locateHotseatItems("com.android.settings").size() &&
+         lazy.isSectionLoaded(LayoutArea::HOTSEAT);
+    ok = ok && lazy.getLayoutFingerprint() == full.getLayoutFingerprint();
+
+    // 未访问的区域保存时直接输出原文，不需要解析
+    exml::EXMLParser untouched;
+    std::string saved;
+    ok = ok && untouched.loadFromFile("samples/template.exml", options);
+    untouched.saveToString(saved);
+    ok = ok && saved == expected && !untouched.isSectionLoaded(LayoutArea::HOME_ONLY);
+
+    // 推迟的区域中的诊断在解析时记录，行号相对整个文档
+    const std::string document =
+        "<Rows>4</Rows>\n"
+        "<home>\n"
+        "<!-- <home> -->\n"
+        "<favorite screen=\"0\" x=\"?\" title=\"a > b\" packageName=\"a\" />\n"
+        "</home>\n"
+        "<appOrder>\n"
+        "<favorite packageName=\"b\" />\n"
+        "</appOrder>\n";
+    exml::EXMLParser deferred;
+    ok = ok && deferred.loadFromMemory(document.data(), document.size(), options) && deferred.getDiagnostics().empty();
+    const std::vector<exml::Item> items = deferred.getHomeItems(0);
+    ok = ok && items.size() == 1 && items[0].title == "a > b" && deferred.getDiagnostics().size() == 1 &&
+         deferred.getDiagnostics()[0].line == 4;
+
+    // 未闭合的区域在加载时就能发现
+    const std::string broken = "<home>\n<favorite packageName=\"a\" />\n";
+    ok = ok && !deferred.loadFromMemory(broken.data(), broken.size(), options);
+
+    std::cout << (ok ? "Skipped sections parse on first access" : "FAILED: section-selective load") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testSpliceOnSave() {
+    std::cout << "=== Splice-On-Save Test ===" << std::endl;
+    using exml::LayoutArea;
+    // 单引号、未知属性与区域内的注释在重新序列化时不能保留，只有原样输出才能复原
+    const std::string home = "<home>\n<favorite screen='0' x='1' y='0' packageName='a' custom=\"keep\" />\n</home>";
+    const std::string appOrder = "<appOrder>\n<!-- sorted -->\n<favorite packageName='b' hidden='0' />\n</appOrder>";
+    const std::string document = "<Rows>5</Rows>\n" + home + "\n<hotseat>\n</hotseat>\n" + appOrder + "\n";
+
+    exml::EXMLParser parser;
+    bool ok = parser.loadFromMemory(document.data(), document.size());
+    std::string output;
+    parser.saveToString(output);
+    ok = ok && output == document && !parser.isSectionModified(LayoutArea::HOTSEAT);
+
+    // 失败的删除、移动不修改模型，区域仍按原文输出
+    ok = ok && !parser.removeHomeItem(0, "missing", "missing") && !parser.removeHomeItem(3, "a", "") &&
+         !parser.moveHomeItem(0, 5, 0, 0) && !parser.moveHotseatItem(0, 0) &&
+         !parser.removeAppOrderItem("b", "missing") && !parser.moveAppOrderItem(0, 9) &&
+         !parser.removeHomeOnlyItem(0, "a", "") && !parser.moveHotseatHomeOnlyItem(-1, 0);
+    parser.saveToString(output);
+    ok = ok && output == document && !parser.isSectionModified(LayoutArea::HOME) &&
+         !parser.isSectionModified(LayoutArea::APP_ORDER) && !parser.isSectionModified(LayoutArea::HOTSEAT);
+
+    exml::Item item;
+    item.packageName = "com.example.splice";
+    item.className = "com.example.splice.Main";
+    ok = ok && parser.addHotseatItem(item) && parser.isSectionModified(LayoutArea::HOTSEAT) &&
+         !parser.isSectionModified(LayoutArea::HOME) && !parser.isSectionModified(LayoutArea::APP_ORDER);
+    parser.saveToString(output);
+    ok = ok && output.find(home) != std::string::npos && output.find(appOrder) != std::string::npos &&
+         output.find("com.example.splice") != std::string::npos;
+
+    // 修改过的区域重新序列化，其余区域仍为原文
+    ok = ok && parser.moveHomeItem(0, 0, 0, 0) && parser.isSectionModified(LayoutArea::HOME);
+    parser.saveToString(output);
+    ok = ok && output.find(home) == std::string::npos && output.find(appOrder) != std::string::npos &&
+         output.find("packageName=\"a\"") != std::string::npos;
+
+    // 配置项按字段比较，未修改的配置项也按原文输出
+    exml::LayoutConfig config = parser.getLayoutConfig();
+    config.columns = 6;
+    parser.setLayoutConfig(config);
+    parser.saveToString(output);
+    ok = ok && output.find("<Rows>5</Rows>") == 0 && output.find("<Columns>6</Columns>") != std::string::npos &&
+         output.find(appOrder) != std::string::npos;
+
+    parser.clear();
+    ok = ok && !parser.isSectionModified(LayoutArea::HOTSEAT);
+
+    std::cout << (ok ? "Untouched sections are copied verbatim" : "FAILED: splice-on-save") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testTransaction() {
+    std::cout << "=== Layout Transaction Test ===" << std::endl;
+    using exml::LayoutArea;
+    exml::EXMLParser sequential;
+    exml::EXMLParser batched;
+    if (!sequential.loadFromFile("samples/template.exml") || !batched.loadFromFile("samples/template.exml")) {
+        return false;
+    }
+    exml::Item added;
+    added.packageName = "com.example.batch";
+    added.className = "com.example.batch.Main";
+
+    // 同一组操作：逐个执行与作为事务提交，结果应完全相同
+    bool ok = sequential.addHomeItem(1, added) && sequential.moveHomeItem(0, 0, 1, 0) &&
+              sequential.removeHomeItem(1, added.packageName, added.className) &&
+              sequential.moveHotseatItem(0, 3) && sequential.addAppOrderItem(added) &&
+              sequential.moveAppOrderItem(0, 5) && sequential.addHotseatHomeOnlyItem(added) &&
+              sequential.moveHomeOnlyItem(0, 0, 0, 100) &&
+              sequential.removeAppOrderItem(added.packageName, added.className);
+
+    exml::LayoutTransaction transaction(batched);
+    transaction.addItem(LayoutArea::HOME, 1, added);
+    transaction.moveItem(LayoutArea::HOME, 0, 0, 1, 0);
+    transaction.removeItem(LayoutArea::HOME, 1, added.packageName, added.className);
+    transaction.moveItem(LayoutArea::HOTSEAT, 0, 0, 0, 3);
+    transaction.addItem(LayoutArea::APP_ORDER, 0, added);
+    transaction.moveItem(LayoutArea::APP_ORDER, 0, 0, 0, 5);
+    transaction.addItem(LayoutArea::HOTSEAT_HOME_ONLY, 0, added);
+    transaction.moveItem(LayoutArea::HOME_ONLY, 0, 0, 0, 100);
+    transaction.removeItem(LayoutArea::APP_ORDER, 0, added.packageName, added.className);
+    ok = ok && transaction.size() == 9 && transaction.commit() && transaction.size() == 0 &&
+         transaction.getError().empty();
+
+    std::string expected;
+    std::string actual;
+    sequential.saveToString(expected);
+    batched.saveToString(actual);
+    ok = ok && actual == expected && batched.getLayoutFingerprint() == sequential.getLayoutFingerprint() &&
+         batched.isSectionModified(LayoutArea::HOTSEAT) && batched.findHotseatHomeOnlyItems(added.packageName).size() == 1;
+
+    // 任一操作无效时整个事务不生效
+    const exml::Fingerprint before = batched.getLayoutFingerprint();
+    transaction.addItem(LayoutArea::HOTSEAT, 0, added);
+    transaction.moveItem(LayoutArea::APP_ORDER, 0, 0, 0, 1);
+    transaction.removeItem(LayoutArea::HOME, 0, "com.example.missing", "com.example.missing.Main");
+    ok = ok && !transaction.commit() && transaction.getError().find("Operation 2") == 0 &&
+         batched.getLayoutFingerprint() == before && batched.findHotseatItems(added.packageName).empty();
+    transaction.moveItem(LayoutArea::HOME, 7, 0, 0, 0);
+    ok = ok && !transaction.commit() && batched.getLayoutFingerprint() == before;
+    transaction.addItem(LayoutArea::HOTSEAT, 0, added);
+    transaction.rollback();
+    ok = ok && transaction.size() == 0 && transaction.commit() && batched.getLayoutFingerprint() == before;
+
+    std::cout << (ok ? "Transaction matches sequential edits" : "FAILED: layout transaction") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+// 比较列存储中的一行与项目（字符串经字符串池还原）
+bool sameRow(const exml::ColumnarLayout& columns, uint32_t row, const exml::Item& item) {
+    const auto& pool = *columns.getStringPool();
+    return columns.types()[row] == static_cast<uint8_t>(item.type) && columns.xs()[row] == item.x &&
+           columns.ys()[row] == item.y && columns.spanXs()[row] == item.spanX &&
+           columns.spanYs()[row] == item.spanY && columns.appWidgetIDs()[row] == item.appWidgetID &&
+           columns.options()[row] == item.options && columns.colors()[row] == item.color &&
+           columns.hidden()[row] == (item.hidden ? 1 : 0) &&
+           pool.lookup(columns.packageIds()[row]) == item.packageName &&
+           pool.lookup(columns.classIds()[row]) == item.className && pool.lookup(columns.titleIds()[row]) == item.title &&
+           columns.childCounts()[row] == item.favorites.size();
+}
+
+bool sameColumns(const exml::ColumnarLayout& a, const exml::ColumnarLayout& b) {
+    auto same = [](auto x, auto y) { return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin()); };
+    return same(a.areas(), b.areas()) && same(a.types(), b.types()) && same(a.screens(), b.screens()) &&
+           same(a.xs(), b.xs()) && same(a.ys(), b.ys()) && same(a.spanXs(), b.spanXs()) &&
+           same(a.spanYs(), b.spanYs()) && same(a.appWidgetIDs(), b.appWidgetIDs()) &&
+           same(a.options(), b.options()) && same(a.colors(), b.colors()) && same(a.hidden(), b.hidden()) &&
+           same(a.packageIds(), b.packageIds()) && same(a.classIds(), b.classIds()) &&
+           same(a.titleIds(), b.titleIds()) && same(a.firstChildren(), b.firstChildren()) &&
+           same(a.childCounts(), b.childCounts());
+}
+
+bool testColumnarLayout(const exml::EXMLParser& parser) {
+    std::cout << "=== Columnar Layout Test ===" << std::endl;
+    using exml::LayoutArea;
+    exml::ColumnarLayout columns;
+    bool ok = columns.loadFromFile("samples/template.exml") &&
+              columns.getLayoutConfig().rows == parser.getLayoutConfig().rows;
+
+    // 逐行与解析器的项目对照：区域内按页顺序排列，文件夹行引用其中的应用
+    size_t items = 0;
+    size_t widgets = 0;
+    auto checkArea = [&](LayoutArea area, const std::vector<std::pair<int, std::vector<exml::Item>>>& pages) {
+        const exml::RowRange rows = columns.getAreaRows(area);
+        uint32_t row = rows.begin;
+        for (const auto& page : pages) {
+            for (const auto& item : page.second) {
+                ok = ok && row < rows.end && sameRow(columns, row, item) &&
+                     columns.areas()[row] == static_cast<uint8_t>(area);
+                for (size_t i = 0; ok && i < item.favorites.size(); ++i) {
+                    const uint32_t child = columns.firstChildren()[row] + static_cast<uint32_t>(i);
+                    ok = child >= columns.getFolderChildRows().begin && sameRow(columns, child, item.favorites[i]) &&
+                         columns.areas()[child] == columns.areas()[row] &&
+                         columns.screens()[child] == columns.screens()[row];
+                }
+                widgets += item.type == exml::ItemType::APPWIDGET;
+                ++row;
+            }
+        }
+        items += rows.size();
+        ok = ok && row == rows.end;
+    };
+    std::vector<std::pair<int, std::vector<exml::Item>>> home;
+    std::vector<std::pair<int, std::vector<exml::Item>>> homeOnly;
+    for (int page = 0; page < 16; ++page) {
+        if (!parser.getHomeItems(page).empty()) home.emplace_back(page, parser.getHomeItems(page));
+        if (!parser.getHomeOnlyItems(page).empty()) homeOnly.emplace_back(page, parser.getHomeOnlyItems(page));
+    }
+    checkArea(LayoutArea::HOME, home);
+    checkArea(LayoutArea::HOTSEAT, {{0, parser.getHotseatItems()}});
+    checkArea(LayoutArea::HOME_ONLY, homeOnly);
+    checkArea(LayoutArea::HOTSEAT_HOME_ONLY, {{0, parser.getHotseatHomeOnlyItems()}});
+    checkArea(LayoutArea::APP_ORDER, {{0, parser.getAppOrderItems()}});
+    ok = ok && items == columns.getItemRows().size() && widgets > 0 &&
+         columns.getRowCount() == columns.getItemRows().size() + columns.getFolderChildRows().size();
+
+    // 统计与逐项计数一致
+    const std::vector<size_t> histogram = columns.spanHistogram(columns.getItemRows(), exml::ItemType::APPWIDGET, 4);
+    size_t histogramTotal = 0;
+    for (size_t count : histogram) histogramTotal += count;
+    const exml::Item& widget = [&]() -> const exml::Item& {
+        for (const auto& page : home) {
+            for (const auto& item : page.second) {
+                if (item.type == exml::ItemType::APPWIDGET) return item;
+            }
+        }
+        return home[0].second[0];
+    }();
+    size_t sameSpan = 0;
+    for (const auto& page : home) {
+        for (const auto& item : page.second) {
+            sameSpan += item.type == exml::ItemType::APPWIDGET && item.spanX == widget.spanX &&
+                        item.spanY == widget.spanY;
+        }
+    }
+    const uint32_t dialer = columns.getStringPool()->find("com.samsung.android.dialer");
+    ok = ok && columns.countItems(columns.getItemRows(), exml::ItemType::APPWIDGET) == widgets &&
+         histogramTotal == widgets && histogram.size() == 16 &&
+         columns.countItems(columns.getAreaRows(LayoutArea::HOME), exml::ItemType::APPWIDGET, widget.spanX,
+                            widget.spanY) == sameSpan &&
+         dialer != exml::StringPool::npos &&
+         columns.countPackage(columns.getAreaRows(LayoutArea::HOTSEAT), dialer) ==
+             parser.findHotseatItems("com.samsung.android.dialer").size();
+
+    // 由模型生成的结果与直接加载相同；共享解析器的池时ID与Item一致
+    exml::ColumnarLayout built;
+    built.build(parser);
+    exml::ColumnarLayout shared(parser.getStringPool());
+    shared.build(parser);
+    ok = ok && sameColumns(built, columns) &&
+         shared.packageIds()[shared.getAreaRows(LayoutArea::HOTSEAT).begin] == parser.viewHotseatItems()[0].packageId();
+
+    const std::string malformed = "<home><favorite screen=\"0\"></home>";
+    ok = ok && !columns.loadFromMemory(malformed.data(), malformed.size()) && columns.getRowCount() == 0;
+    columns.clear();
+    ok = ok && columns.getItemRows().size() == 0;
+
+    std::cout << "Columnar rows: " << built.getRowCount() << ", widgets: " << widgets << std::endl;
+    std::cout << (ok ? "Columnar layout matches parser" : "FAILED: columnar layout") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
+bool testAllocationCount() {
+    std::cout << "=== Allocation Count Test ===" << std::endl;
+    // 加载samples/template.exml的堆分配次数上限，只允许减少；修改解析路径后若超出，说明引入了多余的复制
+    constexpr size_t kTemplateLoadBudget = 440;
+
+    bool loaded = true;
+    const size_t loadAllocations = countHeapAllocations([&] {
+        exml::EXMLParser parser;
+        loaded = parser.loadFromFile("samples/template.exml");
+    });
+    if (loadAllocations == 0) {
+        // 平台不支持替换动态库使用的operator new（如Windows DLL）
+        std::cout << "Allocation counting unavailable, skipped" << std::endl << std::endl;
+        return loaded;
+    }
+
+    exml::Item folder;
+    folder.type = exml::ItemType::FOLDER;
+    folder.title = "A folder title longer than the small string buffer";
+    folder.favorites.resize(4);
+    for (auto& child : folder.favorites) {
+        child.packageName = "com.example.application.with.long.name";
+        child.className = child.packageName + ".MainActivity";
+    }
+    exml::Item moved;
+    exml::LayoutConfig config;
+    config.homeGridList = "4x5,4x6,5x5,5x6,6x6 and some more grid entries";
+    exml::LayoutConfig movedConfig;
+    // 移动不复制字符串与文件夹内容
+    const size_t moveAllocations = countHeapAllocations([&] {
+        exml::Item constructed(std::move(folder));
+        moved = std::move(constructed);
+        movedConfig = std::move(config);
+    });
+
+    exml::EXMLParser parser;
+    parser.loadFromFile("samples/template.exml");
+    const size_t pagesBefore = parser.getHomeItems(0).size();
+    const size_t addAllocations = countHeapAllocations([&] { parser.addHomeItem(0, std::move(moved)); });
+    const std::vector<exml::Item> page = parser.getHomeItems(0);
+
+    bool ok = loaded && loadAllocations <= kTemplateLoadBudget && moveAllocations == 0 &&
+              page.size() == pagesBefore + 1 && page.back().favorites.size() == 4 &&
+              page.back().title == "A folder title longer than the small string buffer";
+    // 添加的项目转换为内部记录，只有新名字驻留、容器扩容与索引维护的分配
+    ok = ok && addAllocations < 8;
+
+    std::cout << "Heap allocations per template load: " << loadAllocations << " (budget " << kTemplateLoadBudget
+              << ")" << std::endl;
+    std::cout << (ok ? "Allocation count passed" : "FAILED: allocation count") << std::endl;
+    std::cout << std::endl;
+    return ok;
+}
+
 int main() {
     std::cout << "=== Samsung EXML Parser Test Program ===" << std::endl;
     std::cout << "Focusing on testing exml file parsing functionality" << std::endl;
@@ -181,19 +1893,36 @@ int main() {
     
     // Test search functionality
     testSearchFunctionality(parser);
+
+    bool allPassed = true;
+    allPassed = testStreamingLoad() && allPassed;
+    allPassed = testMappedLayout(parser) && allPassed;
     
-    // Test save functionality
-    std::cout << "=== Save Functionality Test ===" << std::endl;
-    std::cout << "Saving to output.exml..." << std::endl;
-    if (parser.saveToFile("samples/output.exml")) {
-        std::cout << "Successfully saved to samples/output.exml" << std::endl;
-    } else {
-        std::cout << "Save failed!" << std::endl;
-    }
+    allPassed = testSaveRoundTrip(parser) && allPassed;
+    allPassed = testParseMany(parser) && allPassed;
+    allPassed = testPackageIndex() && allPassed;
+    allPassed = testItemViews(parser) && allPassed;
+    allPassed = testStringPool(parser) && allPassed;
+    allPassed = testMemoryResource(parser) && allPassed;
+    allPassed = testDiagnostics() && allPassed;
+    allPassed = testAttributeSchema() && allPassed;
+    allPassed = testOccupancyGrid() && allPassed;
+    allPassed = testAutoPlacement() && allPassed;
+    allPassed = testLayoutDiff() && allPassed;
+    allPassed = testThreeWayMerge() && allPassed;
+    allPassed = testFingerprints() && allPassed;
+    allPassed = testLayoutStore() && allPassed;
+    allPassed = testSnapshot() && allPassed;
+    allPassed = testLayoutCache() && allPassed;
+    allPassed = testSectionSelectiveLoad() && allPassed;
+    allPassed = testSpliceOnSave() && allPassed;
+    allPassed = testTransaction() && allPassed;
+    allPassed = testColumnarLayout(parser) && allPassed;
+    allPassed = testAllocationCount() && allPassed;
     
     std::cout << std::endl;
     std::cout << "=== Test Complete ===" << std::endl;
     std::cout << "All parsing tests completed. Please check the above output to verify parsing results." << std::endl;
     
-    return 0;
+    return allPassed ? 0 : 1;
 } 
\ No newline at end of file